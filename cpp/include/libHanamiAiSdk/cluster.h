@@ -23,13 +23,14 @@
 #ifndef KITSUNEMIMI_HANAMISDK_CLUSTER_H
 #define KITSUNEMIMI_HANAMISDK_CLUSTER_H
 
+#include <memory>
+
 #include <libKitsunemimiCommon/logger.h>
+#include <libHanamiAiSdk/direct_session.h>
 
 namespace HanamiAI
 {
 
-class WebsocketClient;
-
 bool createCluster(std::string &result,
                    const std::string &clusterName,
                    const std::string &clusterTemplate,
@@ -60,9 +61,9 @@ bool switchToTaskMode(std::string &result,
                       const std::string &clusterUuid,
                       Kitsunemimi::ErrorContainer &error);
 
-WebsocketClient* switchToDirectMode(std::string &result,
-                                    const std::string &clusterUuid,
-                                    Kitsunemimi::ErrorContainer &error);
+std::unique_ptr<DirectSession> switchToDirectMode(std::string &result,
+                                                  const std::string &clusterUuid,
+                                                  Kitsunemimi::ErrorContainer &error);
 
 } // namespace HanamiAI
 
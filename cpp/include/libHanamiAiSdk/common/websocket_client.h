@@ -34,6 +34,7 @@
 #include <cstdlib>
 #include <iostream>
 #include <string>
+#include <array>
 
 namespace beast = boost::beast;         // from <boost/beast.hpp>
 namespace http = beast::http;           // from <boost/beast/http.hpp>
@@ -60,12 +61,36 @@ public:
     bool sendMessage(const void* data,
                      const uint64_t dataSize,
                      Kitsunemimi::ErrorContainer &error);
+    bool sendMessage(const void* header,
+                     const uint64_t headerSize,
+                     const void* payload,
+                     const uint64_t payloadSize,
+                     Kitsunemimi::ErrorContainer &error);
 
     uint8_t* readMessage(uint64_t &numberOfByes,
                          Kitsunemimi::ErrorContainer &error);
 
+    const uint8_t* readMessageIntoBuffer(uint64_t &numberOfByes,
+                                         Kitsunemimi::ErrorContainer &error);
+    const uint8_t* waitForMessage(uint64_t &numberOfByes,
+                                  bool &timeout,
+                                  const uint64_t timeoutMs,
+                                  Kitsunemimi::ErrorContainer &error);
+
 private:
+    // the contexts must live as long as the websocket, which is based on them
+    net::io_context m_ioContext;
+    ssl::context m_sslContext {ssl::context::tlsv13_client};
     websocket::stream<beast::ssl_stream<tcp::socket>>* m_websocket = nullptr;
+
+    // buffer, which is reused by all incoming messages, to avoid allocations per message
+    beast::flat_buffer m_recvBuffer;
+
+    // state of the asynchronous read of waitForMessage, which stays active after a timeout
+    bool m_readPending = false;
+    bool m_readFinished = false;
+    beast::error_code m_readError;
+
     bool loadCertificates(boost::asio::ssl::context &ctx);
 };
 
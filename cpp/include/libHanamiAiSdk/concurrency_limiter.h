@@ -0,0 +1,117 @@
+/**
+ * @file        concurrency_limiter.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMISDK_CONCURRENCY_LIMITER_H
+#define KITSUNEMIMI_HANAMISDK_CONCURRENCY_LIMITER_H
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <stdint.h>
+
+#include <libKitsunemimiCommon/logger.h>
+
+namespace HanamiAI
+{
+class DirectSession;
+struct LimitedSession;
+
+enum LimitAlgorithm
+{
+    // increase the limit by one per round-trip, as long as the latency stays low, and reduce it
+    // by a constant factor, when the latency grows or a request fails
+    AIMD_LIMIT = 0,
+    // scale the limit with the ratio between the minimal and the current latency
+    GRADIENT_LIMIT = 1,
+};
+
+struct LimiterStatistics
+{
+    uint64_t limit = 0;
+    uint64_t numberOfRunningRequests = 0;
+    uint64_t numberOfQueuedRequests = 0;
+    uint64_t numberOfRequests = 0;
+    uint64_t numberOfRejectedRequests = 0;
+    uint64_t numberOfErrors = 0;
+    uint64_t numberOfBrokenSessions = 0;
+    double minLatencyUs = 0.0;
+    double lastLatencyUs = 0.0;
+};
+
+/**
+ * @brief Limits the number of requests, which run at the same time over a pool of
+ *        direct-io-sessions to the same host. The limit is adjusted by the measured latencies,
+ *        so the host is neither overloaded nor idle. Requests over the limit wait in a queue and
+ *        are rejected, when the queue is full or they waited too long. Sessions, which are
+ *        broken, are removed from the pool and reduce the maximum limit. Can be used by any
+ *        number of threads at the same time.
+ */
+class ConcurrencyLimiter
+{
+public:
+    ConcurrencyLimiter(const std::vector<DirectSession*> &sessions,
+                       const LimitAlgorithm algorithm = GRADIENT_LIMIT,
+                       const uint64_t initialLimit = 1,
+                       const uint64_t maxQueueSize = 1024,
+                       const uint64_t maxQueueTimeMs = 1000);
+    ~ConcurrencyLimiter();
+
+    ConcurrencyLimiter(const ConcurrencyLimiter&) = delete;
+    ConcurrencyLimiter& operator=(const ConcurrencyLimiter&) = delete;
+
+    bool request(const float* inputValues,
+                 const uint64_t numberOfInputValues,
+                 float* outputValues,
+                 const uint64_t numberOfOutputValues,
+                 Kitsunemimi::ErrorContainer &error);
+
+    uint64_t getLimit();
+    LimiterStatistics getStatistics();
+
+private:
+    std::vector<LimitedSession*> m_sessions;
+    std::vector<LimitedSession*> m_freeSessions;
+    uint64_t m_numberOfHealthySessions = 0;
+    LimitAlgorithm m_algorithm = GRADIENT_LIMIT;
+    uint64_t m_maxQueueSize = 0;
+    uint64_t m_maxQueueTimeMs = 0;
+
+    std::mutex m_lock;
+    std::condition_variable m_cv;
+    double m_limit = 1.0;
+    double m_minLatencyUs = 0.0;
+    double m_lastLatencyUs = 0.0;
+    LimiterStatistics m_stats;
+
+    LimitedSession* acquire(Kitsunemimi::ErrorContainer &error);
+    void release(LimitedSession* session,
+                 const bool success,
+                 const bool broken,
+                 const double latencyUs);
+    void removeBrokenSession();
+    void updateLimit(const bool success,
+                     const double latencyUs);
+};
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_CONCURRENCY_LIMITER_H
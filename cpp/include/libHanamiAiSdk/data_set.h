@@ -23,21 +23,120 @@
 #ifndef KITSUNEMIMI_HANAMISDK_DATA_SET_H
 #define KITSUNEMIMI_HANAMISDK_DATA_SET_H
 
+#include <string>
+#include <istream>
+#include <functional>
+#include <stdint.h>
+
 #include <libKitsunemimiCommon/logger.h>
 
 namespace HanamiAI
 {
 
+enum UploadCompression
+{
+    NO_COMPRESSION = 0,
+    // fast compression with a moderate ratio
+    LZ4_COMPRESSION = 1,
+    // slower compression with a higher ratio
+    ZSTD_COMPRESSION = 2,
+};
+
+struct UploadOptions
+{
+    // number of websockets for the upload or 0 to select the number by the size of the data
+    uint32_t numberOfStreams = 0;
+    // number of bytes of the data of a single segment
+    uint64_t segmentSize = 96 * 1024;
+    // double the segment-size at runtime, as long as the measured throughput increases
+    bool adaptiveSegmentSize = false;
+    // upper limit of the segment-size, while adapting it
+    uint64_t maxSegmentSize = 4 * 1024 * 1024;
+    // path of a local journal, which stores the progress of the upload, so a failed upload
+    // can be continued with resumeUpload. No journal is written, if the path is empty or the
+    // data don't come from files.
+    std::string journalPath = "";
+    // path of a local manifest with the content-hashes of all uploaded data-sets. If set,
+    // data-sets with the same content as an existing data-set are not uploaded again and
+    // the existing data-set is returned instead. Data, which are read from a seekable stream,
+    // are not checked, because they are not held in memory.
+    std::string manifestPath = "";
+    // number of threads to hash the files for the manifest or 0 to use all cpu-cores
+    uint32_t numberOfHashThreads = 0;
+    // compression of the segments, which is only worth for well compressible data like csv.
+    // Segments, which don't become smaller, are send uncompressed.
+    // NOT supported by the current version of shiori, which doesn't know the fields for the
+    // compression and would store the compressed bytes as data. So a compression is rejected,
+    // unless serverSupportsCompression is explicitly set.
+    UploadCompression compression = NO_COMPRESSION;
+    // must only be set, if the target-server is known to decompress the segments
+    bool serverSupportsCompression = false;
+    // number of threads to compress the segments or 0 to use all cpu-cores
+    uint32_t numberOfCompressionThreads = 0;
+    // maximum time in milliseconds to wait for shiori to complete the data-set after all data
+    // were send or 0 to wait without limit
+    uint64_t completionTimeout = 10 * 60 * 1000;
+};
+
+// Callback, which writes the next chunk of the data into the buffer and sets the number of
+// written bytes, which is 0 at the end of the data. Returns false, if the data are broken.
+typedef std::function<bool(uint8_t* buffer,
+                           const uint64_t bufferSize,
+                           uint64_t &numberOfBytes)> UploadChunkProducer;
+
 bool uploadCsvData(std::string &result,
                    const std::string &dataSetName,
                    const std::string &inputFilePath,
-                   Kitsunemimi::ErrorContainer &error);
+                   Kitsunemimi::ErrorContainer &error,
+                   const UploadOptions &options = UploadOptions());
+bool uploadCsvData(std::string &result,
+                   const std::string &dataSetName,
+                   const uint8_t* inputData,
+                   const uint64_t inputDataSize,
+                   Kitsunemimi::ErrorContainer &error,
+                   const UploadOptions &options = UploadOptions());
+bool uploadCsvData(std::string &result,
+                   const std::string &dataSetName,
+                   std::istream &input,
+                   Kitsunemimi::ErrorContainer &error,
+                   const UploadOptions &options = UploadOptions());
+bool uploadCsvData(std::string &result,
+                   const std::string &dataSetName,
+                   const UploadChunkProducer &input,
+                   Kitsunemimi::ErrorContainer &error,
+                   const UploadOptions &options = UploadOptions());
 
 bool uploadMnistData(std::string &result,
                      const std::string &dataSetName,
                      const std::string &inputFilePath,
                      const std::string &labelFilePath,
-                     Kitsunemimi::ErrorContainer &error);
+                     Kitsunemimi::ErrorContainer &error,
+                     const UploadOptions &options = UploadOptions());
+bool uploadMnistData(std::string &result,
+                     const std::string &dataSetName,
+                     const uint8_t* inputData,
+                     const uint64_t inputDataSize,
+                     const uint8_t* labelData,
+                     const uint64_t labelDataSize,
+                     Kitsunemimi::ErrorContainer &error,
+                     const UploadOptions &options = UploadOptions());
+bool uploadMnistData(std::string &result,
+                     const std::string &dataSetName,
+                     std::istream &input,
+                     std::istream &labels,
+                     Kitsunemimi::ErrorContainer &error,
+                     const UploadOptions &options = UploadOptions());
+bool uploadMnistData(std::string &result,
+                     const std::string &dataSetName,
+                     const UploadChunkProducer &input,
+                     const UploadChunkProducer &labels,
+                     Kitsunemimi::ErrorContainer &error,
+                     const UploadOptions &options = UploadOptions());
+
+bool resumeUpload(std::string &result,
+                  const std::string &journalPath,
+                  Kitsunemimi::ErrorContainer &error,
+                  const UploadOptions &options = UploadOptions());
 
 bool checkDataset(std::string &result,
                   const std::string &dataUuid,
@@ -0,0 +1,85 @@
+/**
+ * @file        delta_encoding.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMISDK_DELTA_ENCODING_H
+#define KITSUNEMIMI_HANAMISDK_DELTA_ENCODING_H
+
+#include <vector>
+#include <stdint.h>
+
+namespace HanamiAI
+{
+
+/**
+ * @brief Stateful encoder for streams of input-vectors, where consecutive vectors differ only by
+ *        a shift and a few changed values, like sliding windows over time-series. Each frame is
+ *        either a keyframe with all values or a delta with the shift against the previous vector
+ *        and the changed values. Frame-layout:
+ *            [uint8 type][uint32 shift][uint32 number of values or changes]
+ *            keyframe: [float values ...]
+ *            delta:    [uint32 index, float value ...]
+ */
+class DeltaEncoder
+{
+public:
+    DeltaEncoder(const uint32_t keyframeInterval = 64,
+                 const uint32_t maxShift = 16);
+
+    uint64_t getMaxFrameSize(const uint64_t numberOfValues) const;
+    uint64_t encode(uint8_t* target,
+                    const float* values,
+                    const uint64_t numberOfValues);
+    void reset();
+
+private:
+    std::vector<float> m_previous;
+    uint32_t m_keyframeInterval = 64;
+    uint32_t m_maxShift = 16;
+    uint32_t m_framesSinceKeyframe = 0;
+    bool m_hasPrevious = false;
+
+    uint64_t countChanges(const float* values,
+                          const uint64_t numberOfValues,
+                          const uint32_t shift,
+                          const uint64_t limit) const;
+};
+
+/**
+ * @brief Counterpart of the DeltaEncoder, which restores the full input-vectors
+ */
+class DeltaDecoder
+{
+public:
+    bool decode(float* target,
+                const uint8_t* data,
+                const uint64_t dataSize,
+                const uint64_t numberOfValues);
+    void reset();
+
+private:
+    std::vector<float> m_previous;
+    bool m_hasPrevious = false;
+};
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_DELTA_ENCODING_H
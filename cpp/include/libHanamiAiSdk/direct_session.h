@@ -0,0 +1,209 @@
+/**
+ * @file        direct_session.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMISDK_DIRECT_SESSION_H
+#define KITSUNEMIMI_HANAMISDK_DIRECT_SESSION_H
+
+#include <string>
+#include <vector>
+#include <array>
+#include <stdint.h>
+
+#include <libKitsunemimiCommon/logger.h>
+#include <libHanamiAiSdk/prepared_request.h>
+
+namespace HanamiAI
+{
+class WebsocketClient;
+struct DirectIoMessages;
+class ResultCache;
+
+struct DirectSessionStatistics
+{
+    uint64_t numberOfLearnedSamples = 0;
+    uint64_t numberOfRequests = 0;
+    uint64_t numberOfSentMessages = 0;
+    uint64_t numberOfReceivedMessages = 0;
+    uint64_t numberOfSentBytes = 0;
+    uint64_t numberOfReceivedBytes = 0;
+    uint64_t numberOfErrors = 0;
+    uint64_t numberOfCacheHits = 0;
+};
+
+/**
+ * @brief Connection to a cluster in direct-mode. The session owns the websocket and all buffers
+ *        and protobuf-messages for the data-transfer, which are reused by all calls of the
+ *        session, so the io-loop doesn't allocate memory after the first call. A session must
+ *        only be used by one thread at the same time.
+ */
+class DirectSession
+{
+public:
+    DirectSession(WebsocketClient* wsClient,
+                  const std::string &clusterUuid);
+    ~DirectSession();
+
+    DirectSession(const DirectSession&) = delete;
+    DirectSession& operator=(const DirectSession&) = delete;
+
+    bool learn(std::vector<float> &inputValues,
+               std::vector<float> &shouldValues,
+               Kitsunemimi::ErrorContainer &error);
+    bool learn(const float* inputValues,
+               const uint64_t numberOfInputValues,
+               const float* shouldValues,
+               const uint64_t numberOfShouldValues,
+               Kitsunemimi::ErrorContainer &error);
+
+    float* request(std::vector<float> &inputValues,
+                   uint64_t &numberOfOutputValues,
+                   Kitsunemimi::ErrorContainer &error);
+    float* request(const float* inputValues,
+                   const uint64_t numberOfInputValues,
+                   uint64_t &numberOfOutputValues,
+                   Kitsunemimi::ErrorContainer &error);
+
+    bool learnBatch(const float* inputValues,
+                    const uint64_t numberOfInputValuesPerSample,
+                    const float* shouldValues,
+                    const uint64_t numberOfShouldValuesPerSample,
+                    const uint64_t batchSize,
+                    Kitsunemimi::ErrorContainer &error);
+    bool requestBatch(const float* inputMatrix,
+                      const uint64_t numberOfRows,
+                      const uint64_t numberOfInputColumns,
+                      float* outputMatrix,
+                      const uint64_t numberOfOutputColumns,
+                      Kitsunemimi::ErrorContainer &error);
+
+    /**
+     * @brief learn single value with input- and output-size, which are fixed at compile-time.
+     *        The sizes never change, so only the values are copied into the prepared messages
+     *        of the session.
+     */
+    template<size_t In, size_t Out>
+    bool learn(const std::array<float, In> &inputValues,
+               const std::array<float, Out> &shouldValues,
+               Kitsunemimi::ErrorContainer &error)
+    {
+        static_assert(In > 0 && Out > 0, "input- and output-size must be bigger than 0");
+        static_assert(In <= MAX_NUMBER_OF_PREPARED_VALUES && Out <= MAX_NUMBER_OF_PREPARED_VALUES,
+                      "input- and output-size must fit into a single message");
+        return learn(m_learnInput, inputValues.data(), In,
+                     m_learnShould, shouldValues.data(), Out,
+                     error);
+    }
+
+    /**
+     * @brief request single value with input- and output-size, which are fixed at compile-time.
+     *        The size never changes, so only the values are copied into the prepared message of
+     *        the session and the output is written directly into the array.
+     */
+    template<size_t In, size_t Out>
+    bool request(const std::array<float, In> &inputValues,
+                 std::array<float, Out> &outputValues,
+                 Kitsunemimi::ErrorContainer &error)
+    {
+        static_assert(In > 0 && Out > 0, "input- and output-size must be bigger than 0");
+        static_assert(In <= MAX_NUMBER_OF_PREPARED_VALUES,
+                      "input-size must fit into a single message");
+        return request(m_requestInput, inputValues.data(), In, outputValues.data(), Out, error);
+    }
+
+    bool learn(PreparedRequest &preparedInput,
+               const float* inputValues,
+               const uint64_t numberOfInputValues,
+               PreparedRequest &preparedShould,
+               const float* shouldValues,
+               const uint64_t numberOfShouldValues,
+               Kitsunemimi::ErrorContainer &error);
+    bool request(PreparedRequest &preparedInput,
+                 const float* inputValues,
+                 const uint64_t numberOfInputValues,
+                 float* outputValues,
+                 const uint64_t numberOfOutputValues,
+                 Kitsunemimi::ErrorContainer &error);
+
+    void setValueEncoding(const ValueEncoding encoding);
+    void setSparseEncoding(const bool enabled,
+                           const float maxDensity = 0.4f);
+    void setDeltaEncoding(const bool enabled,
+                          const uint32_t keyframeInterval = 64);
+
+    void enableResultCache(const uint64_t maxBytes);
+    void disableResultCache();
+    void clearResultCache();
+
+    bool isBroken() const;
+    const std::string& getClusterUuid() const;
+    uint64_t getNumberOfInputValues() const;
+    uint64_t getNumberOfOutputValues() const;
+    const DirectSessionStatistics& getStatistics() const;
+
+private:
+    WebsocketClient* m_wsClient = nullptr;
+    DirectIoMessages* m_messages = nullptr;
+    std::string m_clusterUuid = "";
+
+    // prepared messages for the default-segments of the cluster
+    PreparedRequest m_learnInput {LEARN_INPUT_PREPARED, "input"};
+    PreparedRequest m_learnShould {LEARN_SHOULD_PREPARED, "output"};
+    PreparedRequest m_requestInput {REQUEST_INPUT_PREPARED, "input"};
+
+    // sizes of the input- and output-segment, as seen by the last successful calls
+    uint64_t m_numberOfInputValues = 0;
+    uint64_t m_numberOfOutputValues = 0;
+
+    DirectSessionStatistics m_stats;
+
+    // set after a failure, which can leave responses of earlier messages unread on the
+    // websocket, so all following calls are rejected instead of reading a wrong response
+    bool m_broken = false;
+
+    // optional cache for the results of single requests
+    ResultCache* m_resultCache = nullptr;
+    std::vector<float> m_cachedOutput;
+
+    // buffer for output-values, which were send encoded by the server
+    std::vector<float> m_decodedOutput;
+
+    bool checkSession(Kitsunemimi::ErrorContainer &error);
+    bool sendPrepared(PreparedRequest &prepared,
+                      const float* values,
+                      const uint64_t numberOfValues,
+                      Kitsunemimi::ErrorContainer &error);
+    const uint8_t* receiveMessage(uint64_t &numberOfBytes,
+                                  Kitsunemimi::ErrorContainer &error);
+    bool receiveLearnResponse(const uint64_t responseId,
+                              Kitsunemimi::ErrorContainer &error);
+    const float* getResponseValues(const uint8_t* recvData,
+                                   const uint64_t numberOfBytes,
+                                   uint64_t &numberOfValues,
+                                   const uint64_t maxNumberOfValues);
+    bool receiveRequestResponse(float* outputRow,
+                                const uint64_t numberOfOutputColumns,
+                                Kitsunemimi::ErrorContainer &error);
+};
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_DIRECT_SESSION_H
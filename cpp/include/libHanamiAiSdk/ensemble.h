@@ -0,0 +1,113 @@
+/**
+ * @file        ensemble.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMISDK_ENSEMBLE_H
+#define KITSUNEMIMI_HANAMISDK_ENSEMBLE_H
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <stdint.h>
+
+#include <libKitsunemimiCommon/logger.h>
+
+namespace HanamiAI
+{
+class DirectSession;
+struct EnsembleWorker;
+
+enum EnsembleReduction
+{
+    // mean of the outputs of all members
+    MEAN_REDUCTION = 0,
+    // share of the members, which have the highest value at the position of the output
+    VOTE_REDUCTION = 1,
+    // maximum of the outputs of all members
+    MAX_REDUCTION = 2,
+};
+
+void reduceEnsembleOutput(const float* outputMatrix,
+                          const uint64_t numberOfMembers,
+                          const uint64_t numberOfOutputValues,
+                          const EnsembleReduction reduction,
+                          float* result);
+
+/**
+ * @brief Sends the same input to multiple direct-io-sessions at the same time, for example to
+ *        clusters, which were restored from different snapshots. Each session has its own
+ *        worker-thread, so the latency of a call is the latency of the slowest member and
+ *        not the sum over all members.
+ */
+class Ensemble
+{
+public:
+    Ensemble(const std::vector<DirectSession*> &sessions,
+             const uint64_t numberOfOutputValues);
+    ~Ensemble();
+
+    Ensemble(const Ensemble&) = delete;
+    Ensemble& operator=(const Ensemble&) = delete;
+
+    bool request(const float* inputValues,
+                 const uint64_t numberOfInputValues,
+                 float* outputMatrix,
+                 Kitsunemimi::ErrorContainer &error);
+    bool request(const float* inputValues,
+                 const uint64_t numberOfInputValues,
+                 const EnsembleReduction reduction,
+                 float* result,
+                 Kitsunemimi::ErrorContainer &error);
+
+    uint64_t getNumberOfMembers() const;
+    uint64_t getNumberOfOutputValues() const;
+
+private:
+    friend struct EnsembleWorker;
+
+    std::vector<EnsembleWorker*> m_workers;
+    uint64_t m_numberOfOutputValues = 0;
+
+    // only one call at the same time is processed by the workers
+    std::mutex m_requestLock;
+
+    // state of the current call, which is shared with the workers
+    std::mutex m_stateLock;
+    std::condition_variable m_startCv;
+    std::condition_variable m_doneCv;
+    uint64_t m_generation = 0;
+    uint64_t m_numberOfPendingWorkers = 0;
+    bool m_abort = false;
+    const float* m_inputValues = nullptr;
+    uint64_t m_numberOfInputValues = 0;
+    float* m_outputMatrix = nullptr;
+
+    std::vector<float> m_reductionBuffer;
+
+    bool runMembers(const float* inputValues,
+                    const uint64_t numberOfInputValues,
+                    float* outputMatrix,
+                    Kitsunemimi::ErrorContainer &error);
+};
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_ENSEMBLE_H
@@ -0,0 +1,69 @@
+/**
+ * @file        inference_dispatcher.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMISDK_INFERENCE_DISPATCHER_H
+#define KITSUNEMIMI_HANAMISDK_INFERENCE_DISPATCHER_H
+
+#include <vector>
+#include <atomic>
+#include <stdint.h>
+
+#include <libKitsunemimiCommon/logger.h>
+
+namespace HanamiAI
+{
+class DirectSession;
+struct DispatchWorker;
+
+/**
+ * @brief Shares a small number of direct-io-sessions between many threads. Requests of all
+ *        threads are collected in lock-free queues and send as pipelined bursts over the
+ *        sessions, when either the maximum burst-size is reached or the oldest request of the
+ *        burst waited for the maximum delay. Idle workers block until new requests arrive.
+ *        Sessions, which are broken, are skipped and their requests are given to the other
+ *        sessions. When the dispatcher is destroyed, all pending requests fail.
+ */
+class InferenceDispatcher
+{
+public:
+    InferenceDispatcher(const std::vector<DirectSession*> &sessions,
+                        const uint64_t numberOfInputValues,
+                        const uint64_t numberOfOutputValues,
+                        const uint64_t maxBurstSize = 64,
+                        const uint64_t maxDelayUs = 500);
+    ~InferenceDispatcher();
+
+    bool request(const float* inputValues,
+                 float* outputValues,
+                 Kitsunemimi::ErrorContainer &error);
+
+private:
+    std::vector<DispatchWorker*> m_workers;
+    std::atomic<uint64_t> m_nextWorker {0};
+    std::atomic<bool> m_closed {false};
+
+    DispatchWorker* getHealthyWorker();
+};
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_INFERENCE_DISPATCHER_H
@@ -27,36 +27,99 @@
 #include <vector>
 #include <stdint.h>
 #include <chrono>
+#include <array>
 
 #include <libKitsunemimiCommon/logger.h>
+#include <libHanamiAiSdk/direct_session.h>
 
 namespace HanamiAI
 {
-class WebsocketClient;
 
-bool learn(WebsocketClient* wsClient,
+bool learn(DirectSession* session,
            std::vector<float> &inputValues,
            std::vector<float> &shouldValues,
            Kitsunemimi::ErrorContainer &error);
 
-float* request(WebsocketClient* wsClient,
+float* request(DirectSession* session,
                std::vector<float> &inputValues,
                uint64_t &numberOfOutputValues,
                Kitsunemimi::ErrorContainer &error);
 
-bool learn(WebsocketClient* wsClient,
-           float* inputValues,
+bool learn(DirectSession* session,
+           const float* inputValues,
            const uint64_t numberOfInputValues,
-           float* shouldValues,
+           const float* shouldValues,
            const uint64_t numberOfShouldValues,
            Kitsunemimi::ErrorContainer &error);
 
-float* request(WebsocketClient* wsClient,
-               float* inputData,
+float* request(DirectSession* session,
+               const float* inputData,
                const uint64_t numberOfInputValues,
                uint64_t &numberOfOutputValues,
                Kitsunemimi::ErrorContainer &error);
 
+bool learnBatch(DirectSession* session,
+                std::vector<float> &inputValues,
+                std::vector<float> &shouldValues,
+                const uint64_t batchSize,
+                Kitsunemimi::ErrorContainer &error);
+
+bool learnBatch(DirectSession* session,
+                const float* inputValues,
+                const uint64_t numberOfInputValuesPerSample,
+                const float* shouldValues,
+                const uint64_t numberOfShouldValuesPerSample,
+                const uint64_t batchSize,
+                Kitsunemimi::ErrorContainer &error);
+
+bool requestBatch(DirectSession* session,
+                  const float* inputMatrix,
+                  const uint64_t numberOfRows,
+                  const uint64_t numberOfInputColumns,
+                  float* outputMatrix,
+                  const uint64_t numberOfOutputColumns,
+                  Kitsunemimi::ErrorContainer &error);
+
+/**
+ * @brief learn single value with input- and output-size, which are fixed at compile-time
+ *
+ * @param session pointer to direct-session for data-transfer
+ * @param inputValues array with all input-values
+ * @param shouldValues array with all should-values
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+template<size_t In, size_t Out>
+bool
+learn(DirectSession* session,
+      const std::array<float, In> &inputValues,
+      const std::array<float, Out> &shouldValues,
+      Kitsunemimi::ErrorContainer &error)
+{
+    return session->learn<In, Out>(inputValues, shouldValues, error);
+}
+
+/**
+ * @brief request single value with input- and output-size, which are fixed at compile-time
+ *
+ * @param session pointer to direct-session for data-transfer
+ * @param inputValues array with all input-values
+ * @param outputValues reference to array for the output-values
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+template<size_t In, size_t Out>
+bool
+request(DirectSession* session,
+        const std::array<float, In> &inputValues,
+        std::array<float, Out> &outputValues,
+        Kitsunemimi::ErrorContainer &error)
+{
+    return session->request<In, Out>(inputValues, outputValues, error);
+}
+
 } // namespace HanamiAI
 
 #endif // IO_H
@@ -0,0 +1,106 @@
+/**
+ * @file        prepared_request.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMISDK_PREPARED_REQUEST_H
+#define KITSUNEMIMI_HANAMISDK_PREPARED_REQUEST_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <limits.h>
+
+#include <libHanamiAiSdk/value_encoding.h>
+#include <libHanamiAiSdk/delta_encoding.h>
+
+// maximum number of fp32-values, which still fit into a single message, that protobuf can parse,
+// with some space left for the constant fields
+#define MAX_NUMBER_OF_PREPARED_VALUES ((INT_MAX / sizeof(float)) - 1024)
+
+namespace HanamiAI
+{
+
+enum PreparedRequestType
+{
+    REQUEST_INPUT_PREPARED = 0,
+    LEARN_INPUT_PREPARED = 1,
+    LEARN_SHOULD_PREPARED = 2,
+};
+
+/**
+ * @brief Prepared direct-io-message for a specific segment, similar to a prepared statement of
+ *        a database. The constant fields of the message are serialized only once, when the
+ *        object is created. For each call only the number of values and the payload are
+ *        written behind them and if the number of values is the same like in the last call,
+ *        even this is skipped and only the values are copied into the frame.
+ *        Optionally the values can be send with reduced precision in additional fields of the
+ *        message, which are only understood by servers with support for encoded values.
+ *        The same is true for the sparse-encoding, which sends mostly-zero values as
+ *        (index, value)-pairs and for the delta-encoding, which sends only the shift and the
+ *        changed values against the previous message of the same prepared request.
+ */
+class PreparedRequest
+{
+public:
+    PreparedRequest(const PreparedRequestType type,
+                    const std::string &segmentName);
+
+    const uint8_t* fill(const float* values,
+                        const uint64_t numberOfValues,
+                        uint64_t &frameSize);
+
+    void setEncoding(const ValueEncoding encoding);
+    void setSparseEncoding(const bool enabled,
+                           const float maxDensity = 0.4f);
+    void setDeltaEncoding(const bool enabled,
+                          const uint32_t keyframeInterval = 64,
+                          const uint32_t maxShift = 16);
+
+    PreparedRequestType getType() const;
+    const std::string& getSegmentName() const;
+    ValueEncoding getEncoding() const;
+
+private:
+    PreparedRequestType m_type = REQUEST_INPUT_PREPARED;
+    std::string m_segmentName = "";
+
+    std::vector<uint8_t> m_frame;
+    uint64_t m_headerSize = 0;
+    uint64_t m_payloadOffset = 0;
+    uint64_t m_numberOfValues = 0;
+    bool m_hasValueHeader = false;
+    ValueEncoding m_encoding = FP32_ENCODING;
+    bool m_sparseEnabled = false;
+    float m_maxDensity = 0.4f;
+    bool m_deltaEnabled = false;
+    DeltaEncoder m_deltaEncoder;
+    std::vector<uint8_t> m_deltaFrame;
+
+    const uint8_t* fillEncoded(const float* values,
+                               const uint64_t numberOfValues,
+                               const ValueEncoding encoding,
+                               const uint64_t payloadSize,
+                               uint64_t &frameSize);
+};
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_PREPARED_REQUEST_H
@@ -0,0 +1,124 @@
+/**
+ * @file        replica_balancer.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMISDK_REPLICA_BALANCER_H
+#define KITSUNEMIMI_HANAMISDK_REPLICA_BALANCER_H
+
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <stdint.h>
+
+#include <libKitsunemimiCommon/logger.h>
+
+namespace HanamiAI
+{
+class DirectSession;
+struct Replica;
+
+enum BalancingStrategy
+{
+    // replica with the fewest running requests, with the latency as tie-breaker
+    LEAST_OUTSTANDING_BALANCING = 0,
+    // replica with the lowest average latency, with the running requests as tie-breaker
+    LOWEST_LATENCY_BALANCING = 1,
+};
+
+struct ReplicaSnapshot
+{
+    uint64_t numberOfRequests = 0;
+    uint64_t numberOfErrors = 0;
+    uint64_t numberOfRunningRequests = 0;
+    double averageLatencyUs = 0.0;
+    bool ejected = false;
+    // the session of the replica is broken and the replica is never used again
+    bool broken = false;
+};
+
+struct BalancerSnapshot
+{
+    uint64_t numberOfRequests = 0;
+    uint64_t numberOfErrors = 0;
+    // requests per second and average latency since the last snapshot
+    double requestsPerSecond = 0.0;
+    double averageLatencyUs = 0.0;
+    std::vector<ReplicaSnapshot> replicas;
+};
+
+/**
+ * @brief Client-side load-balancer over direct-io-sessions of replicas of the same cluster.
+ *        Each request is routed to the replica with the fewest running requests or the lowest
+ *        average latency. Replicas, which fail multiple times in a row or become much slower
+ *        than the fastest replica, are ejected for a while and get requests only again after
+ *        the ejection-time. Replicas with a broken session are ejected permanently. Can be used
+ *        by any number of threads at the same time.
+ */
+class ReplicaBalancer
+{
+public:
+    ReplicaBalancer(const std::vector<DirectSession*> &sessions,
+                    const BalancingStrategy strategy = LEAST_OUTSTANDING_BALANCING,
+                    const double ejectionFactor = 3.0,
+                    const uint64_t ejectionTimeMs = 5000,
+                    const uint64_t maxConsecutiveErrors = 3);
+    ~ReplicaBalancer();
+
+    ReplicaBalancer(const ReplicaBalancer&) = delete;
+    ReplicaBalancer& operator=(const ReplicaBalancer&) = delete;
+
+    bool request(const float* inputValues,
+                 const uint64_t numberOfInputValues,
+                 float* outputValues,
+                 const uint64_t numberOfOutputValues,
+                 Kitsunemimi::ErrorContainer &error);
+
+    BalancerSnapshot getSnapshot();
+
+private:
+    std::vector<Replica*> m_replicas;
+    BalancingStrategy m_strategy = LEAST_OUTSTANDING_BALANCING;
+    double m_ejectionFactor = 3.0;
+    std::chrono::milliseconds m_ejectionTime;
+    uint64_t m_maxConsecutiveErrors = 3;
+
+    // lock for the selection of replicas and all counters
+    std::mutex m_stateLock;
+    uint64_t m_numberOfRequests = 0;
+    uint64_t m_numberOfErrors = 0;
+    uint64_t m_sumLatencyUs = 0;
+
+    // state of the last snapshot to calculate the rates since then
+    std::chrono::steady_clock::time_point m_lastSnapshotTime;
+    uint64_t m_lastSnapshotRequests = 0;
+    uint64_t m_lastSnapshotLatencyUs = 0;
+
+    Replica* selectReplica();
+    void finishRequest(Replica* replica,
+                       const bool success,
+                       const bool broken,
+                       const uint64_t latencyUs);
+    double getFastestLatency(const Replica* excluded) const;
+};
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_REPLICA_BALANCER_H
@@ -0,0 +1,80 @@
+/**
+ * @file        value_encoding.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMISDK_VALUE_ENCODING_H
+#define KITSUNEMIMI_HANAMISDK_VALUE_ENCODING_H
+
+#include <stdint.h>
+
+namespace HanamiAI
+{
+
+enum ValueEncoding
+{
+    FP32_ENCODING = 0,
+    FP16_ENCODING = 1,
+    BF16_ENCODING = 2,
+    INT8_ENCODING = 3,
+    // only used on the wire for messages with (index, value)-pairs, which are selected
+    // automatically per message, when the sparse-encoding is enabled
+    SPARSE_ENCODING = 4,
+    // only used on the wire for frames of the stateful DeltaEncoder, which can not be encoded
+    // or decoded by the stateless functions below
+    DELTA_ENCODING = 5,
+};
+
+uint64_t getEncodedSize(const ValueEncoding encoding,
+                        const uint64_t numberOfValues);
+
+uint64_t encodeValues(uint8_t* target,
+                      const float* values,
+                      const uint64_t numberOfValues,
+                      const ValueEncoding encoding);
+
+bool decodeValues(float* target,
+                  const uint8_t* data,
+                  const uint64_t dataSize,
+                  const uint64_t numberOfValues,
+                  const ValueEncoding encoding);
+
+uint64_t countNonZeroValues(const float* values,
+                            const uint64_t numberOfValues);
+
+bool shouldUseSparseEncoding(const float* values,
+                             const uint64_t numberOfValues,
+                             uint64_t &numberOfNonZeroValues,
+                             const float maxDensity = 0.4f);
+
+uint64_t getSparseEncodedSize(const uint64_t numberOfNonZeroValues);
+
+uint64_t encodeSparseValues(uint8_t* target,
+                            const float* values,
+                            const uint64_t numberOfValues);
+
+bool decodeSparseValues(float* target,
+                        const uint8_t* data,
+                        const uint64_t dataSize,
+                        const uint64_t numberOfValues);
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_VALUE_ENCODING_H
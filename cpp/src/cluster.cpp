@@ -23,6 +23,7 @@
 #include <libHanamiAiSdk/cluster.h>
 #include <common/http_client.h>
 #include <libHanamiAiSdk/common/websocket_client.h>
+#include <common/result_cache.h>
 #include <libKitsunemimiCrypto/common.h>
 
 namespace HanamiAI
@@ -156,6 +157,8 @@ deleteCluster(std::string &result,
         return false;
     }
 
+    invalidateClusterResults(clusterUuid);
+
     return true;
 }
 
@@ -230,6 +233,9 @@ restoreCluster(std::string &result,
         return false;
     }
 
+    // the cluster has now the state of the snapshot, so cached results are outdated
+    invalidateClusterResults(clusterUuid);
+
     return true;
 }
 
@@ -274,9 +280,9 @@ switchToTaskMode(std::string &result,
  * @param clusterUuid uuid of the cluster to swtich
  * @param error reference for error-output
  *
- * @return true, if successful, else false
+ * @return nullptr, if failed, else session, which owns the websocket to the cluster
  */
-WebsocketClient*
+std::unique_ptr<DirectSession>
 switchToDirectMode(std::string &result,
                    const std::string &clusterUuid,
                    Kitsunemimi::ErrorContainer &error)
@@ -318,7 +324,7 @@ switchToDirectMode(std::string &result,
         return nullptr;
     }
 
-    return wsClient;
+    return std::unique_ptr<DirectSession>(new DirectSession(wsClient, clusterUuid));
 }
 
 } // namespace HanamiAI
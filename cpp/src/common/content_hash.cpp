@@ -0,0 +1,241 @@
+/**
+ * @file        content_hash.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <common/content_hash.h>
+#include <common/hash.h>
+
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+
+// size of the blocks of a file, which are hashed independently by the threads
+#define CONTENT_HASH_CHUNK_SIZE (4 * 1024 * 1024)
+
+// maximum number of threads for hashing a file
+#define MAX_CONTENT_HASH_THREADS 16
+
+namespace HanamiAI
+{
+
+/**
+ * @brief convert a 128-bit hash into a hex-string
+ */
+std::string
+toHexString(const uint64_t high,
+            const uint64_t low)
+{
+    char buffer[33];
+    snprintf(buffer,
+             sizeof(buffer),
+             "%016llx%016llx",
+             static_cast<unsigned long long>(high),
+             static_cast<unsigned long long>(low));
+    return std::string(buffer);
+}
+
+/**
+ * @brief calculate a 128-bit hash over the content of a file. The data are split into chunks,
+ *        which are hashed by multiple threads at the same time, and the hash of the file is the
+ *        hash over the hashes of all chunks and the size of the file.
+ *
+ * @param data pointer to the content of the file, like a mapped file or a buffer
+ * @param size number of bytes of the file
+ * @param numberOfThreads number of threads or 0 to use all cpu-cores
+ *
+ * @return resulting hash as hex-string
+ */
+std::string
+hashContent(const uint8_t* data,
+            const uint64_t size,
+            const uint32_t numberOfThreads)
+{
+    const uint64_t numberOfChunks = (size + CONTENT_HASH_CHUNK_SIZE - 1) / CONTENT_HASH_CHUNK_SIZE;
+
+    // two independent 64-bit hashes for each chunk build a 128-bit hash
+    std::vector<uint64_t> chunkHashes(numberOfChunks * 2 + 1, 0);
+    chunkHashes[numberOfChunks * 2] = size;
+
+    uint64_t threads = numberOfThreads;
+    if(threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    threads = std::max(std::min(std::min(threads, numberOfChunks),
+                                static_cast<uint64_t>(MAX_CONTENT_HASH_THREADS)),
+                       static_cast<uint64_t>(1));
+
+    const auto hashChunks = [&](const uint64_t threadId)
+    {
+        for(uint64_t i = threadId; i < numberOfChunks; i += threads)
+        {
+            const uint64_t pos = i * CONTENT_HASH_CHUNK_SIZE;
+            const uint64_t chunkSize = std::min(static_cast<uint64_t>(CONTENT_HASH_CHUNK_SIZE),
+                                                size - pos);
+            chunkHashes[i * 2] = hashBytes(&data[pos], chunkSize, 0);
+            chunkHashes[i * 2 + 1] = hashBytes(&data[pos], chunkSize, 1);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for(uint64_t t = 1; t < threads; t++) {
+        workers.emplace_back(hashChunks, t);
+    }
+    hashChunks(0);
+    for(std::thread &worker : workers) {
+        worker.join();
+    }
+
+    // the hash over the chunk-hashes depends on their position, so reordered chunks result
+    // in another hash of the file
+    const uint64_t numberOfBytes = chunkHashes.size() * sizeof(uint64_t);
+    return toHexString(hashBytes(&chunkHashes[0], numberOfBytes, 0),
+                       hashBytes(&chunkHashes[0], numberOfBytes, 1));
+}
+
+/**
+ * @brief combine the hashes of multiple files into one hash
+ *
+ * @param prefix additional string, which is part of the hash, like the type of the data-set
+ * @param contentHashes hashes of the files in a fixed order
+ *
+ * @return combined hash as hex-string
+ */
+std::string
+combineContentHashes(const std::string &prefix,
+                     const std::vector<std::string> &contentHashes)
+{
+    std::string combined = prefix;
+    for(const std::string &contentHash : contentHashes) {
+        combined += ":" + contentHash;
+    }
+
+    return toHexString(hashBytes(combined.data(), combined.size(), 0),
+                       hashBytes(combined.data(), combined.size(), 1));
+}
+
+/**
+ * @brief constructor
+ *
+ * @param manifestPath path of the local manifest-file
+ */
+UploadManifest::UploadManifest(const std::string &manifestPath)
+{
+    m_manifestPath = manifestPath;
+}
+
+/**
+ * @brief search for a data-set with a specific content-hash
+ *
+ * @param contentHash content-hash to search for
+ * @param datasetUuid reference for the uuid of the data-set
+ *
+ * @return true, if found, else false
+ */
+bool
+UploadManifest::find(const std::string &contentHash,
+                     std::string &datasetUuid)
+{
+    std::ifstream in(m_manifestPath);
+    std::string line;
+
+    while(std::getline(in, line))
+    {
+        std::istringstream lineStream(line);
+        std::string hash;
+        std::string uuid;
+        lineStream >> hash >> uuid;
+
+        if(lineStream.fail() == false && hash == contentHash)
+        {
+            datasetUuid = uuid;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief add a new data-set to the manifest
+ *
+ * @param contentHash content-hash of the data-set
+ * @param datasetUuid uuid of the data-set
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+UploadManifest::add(const std::string &contentHash,
+                    const std::string &datasetUuid,
+                    Kitsunemimi::ErrorContainer &error)
+{
+    std::ofstream out(m_manifestPath, std::ofstream::app);
+    out << contentHash << " " << datasetUuid << "\n";
+    out.close();
+
+    if(out.fail())
+    {
+        error.addMeesage("Failed to write upload-manifest '" + m_manifestPath + "'");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief remove a data-set from the manifest, for example because it was deleted in shiori
+ *
+ * @param contentHash content-hash of the data-set
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+UploadManifest::remove(const std::string &contentHash,
+                       Kitsunemimi::ErrorContainer &error)
+{
+    std::ifstream in(m_manifestPath);
+    std::ostringstream content;
+    std::string line;
+
+    while(std::getline(in, line))
+    {
+        if(line.compare(0, contentHash.size() + 1, contentHash + " ") != 0) {
+            content << line << "\n";
+        }
+    }
+    in.close();
+
+    std::ofstream out(m_manifestPath, std::ofstream::trunc);
+    out << content.str();
+    out.close();
+
+    if(out.fail())
+    {
+        error.addMeesage("Failed to write upload-manifest '" + m_manifestPath + "'");
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace HanamiAI
@@ -0,0 +1,65 @@
+/**
+ * @file        content_hash.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMISDK_CONTENT_HASH_H
+#define KITSUNEMIMI_HANAMISDK_CONTENT_HASH_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include <libKitsunemimiCommon/logger.h>
+
+namespace HanamiAI
+{
+
+std::string hashContent(const uint8_t* data,
+                        const uint64_t size,
+                        const uint32_t numberOfThreads);
+
+std::string combineContentHashes(const std::string &prefix,
+                                 const std::vector<std::string> &contentHashes);
+
+/**
+ * @brief Local manifest, which maps the content-hashes of uploaded data-sets to the uuids of
+ *        these data-sets, to detect uploads of data, which already exist in shiori.
+ */
+class UploadManifest
+{
+public:
+    UploadManifest(const std::string &manifestPath);
+
+    bool find(const std::string &contentHash,
+              std::string &datasetUuid);
+    bool add(const std::string &contentHash,
+             const std::string &datasetUuid,
+             Kitsunemimi::ErrorContainer &error);
+    bool remove(const std::string &contentHash,
+                Kitsunemimi::ErrorContainer &error);
+
+private:
+    std::string m_manifestPath = "";
+};
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_CONTENT_HASH_H
@@ -0,0 +1,70 @@
+/**
+ * @file        cpu_features.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMISDK_CPU_FEATURES_H
+#define KITSUNEMIMI_HANAMISDK_CPU_FEATURES_H
+
+// The library is build without any -m flags for specific instruction-sets, so functions with
+// SIMD-code are compiled separately with the target-attribute and only called, when the
+// cpu, where the library is running, supports the required instructions. Otherwise the
+// scalar fallbacks are used.
+#if defined(__x86_64__) || defined(__i386__)
+#define HANAMI_X86_SIMD
+#include <immintrin.h>
+#define HANAMI_TARGET_AVX2 __attribute__((target("avx2")))
+#define HANAMI_TARGET_AVX2_F16C __attribute__((target("avx2,f16c")))
+#endif
+
+namespace HanamiAI
+{
+
+/**
+ * @brief check if the cpu supports AVX2
+ */
+inline bool
+hasAvx2()
+{
+#ifdef HANAMI_X86_SIMD
+    static const bool result = __builtin_cpu_supports("avx2");
+    return result;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief check if the cpu supports AVX2 and the F16C-instructions for half-precision floats
+ */
+inline bool
+hasAvx2F16c()
+{
+#ifdef HANAMI_X86_SIMD
+    static const bool result = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+    return result;
+#else
+    return false;
+#endif
+}
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_CPU_FEATURES_H
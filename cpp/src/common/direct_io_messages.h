@@ -0,0 +1,45 @@
+/**
+ * @file        direct_io_messages.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMISDK_DIRECT_IO_MESSAGES_H
+#define KITSUNEMIMI_HANAMISDK_DIRECT_IO_MESSAGES_H
+
+#include <../../libKitsunemimiHanamiMessages/protobuffers/kyouko_messages.proto3.pb.h>
+
+namespace HanamiAI
+{
+
+/**
+ * @brief protobuf-messages of a direct-io-session, which are reused for all calls of the
+ *        session. Outgoing messages are written by prepared requests, so only the message for
+ *        parsing the responses is necessary. Its repeated field keeps its capacity when the next
+ *        response is parsed, so after the first call with the biggest layer, the io-loop
+ *        doesn't allocate any memory for the messages anymore.
+ */
+struct DirectIoMessages
+{
+    ClusterIO_Message response;
+};
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_DIRECT_IO_MESSAGES_H
@@ -0,0 +1,150 @@
+/**
+ * @file        encoded_values.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <common/encoded_values.h>
+#include <libHanamiAiSdk/value_encoding.h>
+
+#include <limits.h>
+
+#include <../../libKitsunemimiHanamiMessages/protobuffers/kyouko_messages.proto3.pb.h>
+
+using google::protobuf::io::CodedInputStream;
+using google::protobuf::internal::WireFormatLite;
+
+namespace HanamiAI
+{
+
+/**
+ * @brief search the fields with the encoded values in a serialized ClusterIO_Message. All other
+ *        fields are skipped, so this works for the frames of prepared requests and responses.
+ *
+ * @param result reference for the encoded values. The data-pointer points into the frame.
+ * @param frame pointer to the serialized message
+ * @param frameSize number of bytes of the message
+ *
+ * @return false, if the message is broken, else true
+ */
+bool
+parseEncodedValues(EncodedValues &result,
+                   const uint8_t* frame,
+                   const uint64_t frameSize)
+{
+    result = EncodedValues();
+    if(frameSize > INT_MAX) {
+        return false;
+    }
+
+    CodedInputStream input(frame, static_cast<int>(frameSize));
+    input.SetTotalBytesLimit(INT_MAX);
+
+    uint32_t tag = input.ReadTag();
+    while(tag != 0)
+    {
+        const int fieldNumber = WireFormatLite::GetTagFieldNumber(tag);
+        const WireFormatLite::WireType wireType = WireFormatLite::GetTagWireType(tag);
+
+        if(fieldNumber == ClusterIO_Message::kNumberOfValuesFieldNumber
+                && wireType == WireFormatLite::WIRETYPE_VARINT)
+        {
+            if(input.ReadVarint64(&result.numberOfValues) == false) {
+                return false;
+            }
+        }
+        else if(fieldNumber == ENCODING_FIELD_NUMBER
+                && wireType == WireFormatLite::WIRETYPE_VARINT)
+        {
+            if(input.ReadVarint32(&result.encoding) == false) {
+                return false;
+            }
+            result.hasEncoding = true;
+        }
+        else if(fieldNumber == ENCODED_VALUES_FIELD_NUMBER
+                && wireType == WireFormatLite::WIRETYPE_LENGTH_DELIMITED)
+        {
+            uint32_t length = 0;
+            if(input.ReadVarint32(&length) == false) {
+                return false;
+            }
+
+            const uint64_t position = static_cast<uint64_t>(input.CurrentPosition());
+            if(input.Skip(static_cast<int>(length)) == false) {
+                return false;
+            }
+            result.data = &frame[position];
+            result.dataSize = length;
+        }
+        else if(WireFormatLite::SkipField(&input, tag) == false)
+        {
+            return false;
+        }
+
+        tag = input.ReadTag();
+    }
+
+    return input.ConsumedEntireMessage();
+}
+
+/**
+ * @brief decode the values, which were found by parseEncodedValues
+ *
+ * @param target pointer to the buffer for the decoded values, which must be big enough for
+ *               the number of values of the message
+ * @param encoded encoded values
+ * @param deltaDecoder decoder of the stream, which is necessary for the DELTA_ENCODING
+ *
+ * @return false, if the encoding is unknown or the data are broken, else true
+ */
+bool
+decodeEncodedValues(float* target,
+                    const EncodedValues &encoded,
+                    DeltaDecoder* deltaDecoder)
+{
+    if(encoded.hasEncoding == false) {
+        return false;
+    }
+
+    switch(encoded.encoding)
+    {
+        case FP32_ENCODING:
+        case FP16_ENCODING:
+        case BF16_ENCODING:
+        case INT8_ENCODING:
+        case SPARSE_ENCODING:
+            return decodeValues(target,
+                                encoded.data,
+                                encoded.dataSize,
+                                encoded.numberOfValues,
+                                static_cast<ValueEncoding>(encoded.encoding));
+        case DELTA_ENCODING:
+            if(deltaDecoder == nullptr) {
+                return false;
+            }
+            return deltaDecoder->decode(target,
+                                        encoded.data,
+                                        encoded.dataSize,
+                                        encoded.numberOfValues);
+    }
+
+    return false;
+}
+
+} // namespace HanamiAI
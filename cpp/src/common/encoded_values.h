@@ -0,0 +1,60 @@
+/**
+ * @file        encoded_values.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMISDK_ENCODED_VALUES_H
+#define KITSUNEMIMI_HANAMISDK_ENCODED_VALUES_H
+
+#include <stdint.h>
+
+#include <libHanamiAiSdk/delta_encoding.h>
+
+// field-numbers of the additional fields of the ClusterIO_Message for encoded values, which are
+// not part of the proto-file. The current version of kyouko doesn't know them.
+#define ENCODING_FIELD_NUMBER 16
+#define ENCODED_VALUES_FIELD_NUMBER 17
+
+namespace HanamiAI
+{
+
+/**
+ * @brief encoded values within a serialized ClusterIO_Message
+ */
+struct EncodedValues
+{
+    bool hasEncoding = false;
+    uint32_t encoding = 0;
+    uint64_t numberOfValues = 0;
+    const uint8_t* data = nullptr;
+    uint64_t dataSize = 0;
+};
+
+bool parseEncodedValues(EncodedValues &result,
+                        const uint8_t* frame,
+                        const uint64_t frameSize);
+
+bool decodeEncodedValues(float* target,
+                         const EncodedValues &encoded,
+                         DeltaDecoder* deltaDecoder = nullptr);
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_ENCODED_VALUES_H
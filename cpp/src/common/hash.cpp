@@ -0,0 +1,237 @@
+/**
+ * @file        hash.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+#include <common/hash.h>
+#include <common/cpu_features.h>
+
+#include <string.h>
+
+// 16 stripes of 32 bytes are accumulated, before the accumulator is scrambled
+#define HASH_STRIPE_SIZE 32
+#define HASH_STRIPES_PER_BLOCK 16
+#define HASH_BLOCK_SIZE (HASH_STRIPE_SIZE * HASH_STRIPES_PER_BLOCK)
+
+// the stripes of a block use the secret with an offset of one word per stripe and the
+// scrambling uses the last 4 words
+#define HASH_SECRET_SIZE 24
+#define HASH_SCRAMBLE_OFFSET 20
+
+namespace HanamiAI
+{
+
+// primes of the hash, taken over from xxh3
+const uint64_t HASH_PRIME_1 = 0x9E3779B185EBCA87ULL;
+const uint64_t HASH_PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+const uint64_t HASH_PRIME_3 = 0x165667B19E3779F9ULL;
+const uint64_t HASH_PRIME32_1 = 0x9E3779B1ULL;
+
+// secret of the hash, which was generated with splitmix64
+const uint64_t HASH_SECRET[HASH_SECRET_SIZE] = {
+    0x8c9ff21eb4943e94ULL, 0x529bcfd80991254cULL, 0x12b8eb6d931b5e6eULL,
+    0xcec50c5d0c1fcc21ULL, 0x31f5796e26ef1ca1ULL, 0x6fad0e5ad91dff82ULL,
+    0x061c22c6f5405433ULL, 0xacebed3be37886a1ULL, 0x0d81e8485a2713a6ULL,
+    0xa3e600f8f1fd238cULL, 0xef1382c779e55f8eULL, 0xfe2c41ff60885d40ULL,
+    0x94cbb826dac34bb2ULL, 0xb502428724a731f6ULL, 0xd0bec29520b72715ULL,
+    0x81335f7cacfebd80ULL, 0xe34be0aababd1d08ULL, 0x25c86b4d7ef8431aULL,
+    0x889c2b2a461ffb7eULL, 0x6a810fe6190b977eULL, 0xa24c7ba4f2058340ULL,
+    0xba5c108702350f86ULL, 0x73b2efd68e1c6856ULL, 0xc539d9c263ee450aULL};
+
+/**
+ * @brief final mixing of a 64-bit value
+ */
+inline uint64_t
+avalanche(uint64_t h)
+{
+    h ^= h >> 37;
+    h *= HASH_PRIME_3;
+    h ^= h >> 32;
+    return h;
+}
+
+/**
+ * @brief accumulate a single stripe of 32 bytes into the 4 lanes of the accumulator. Each
+ *        stripe of a block is mixed with another part of the secret, so the result depends on
+ *        the position of the stripe, and each value is also added to the neighbor-lane.
+ *
+ * @param acc accumulator with 4 lanes
+ * @param data pointer to the stripe
+ * @param key part of the secret for the position of the stripe within its block
+ */
+inline void
+accumulateStripe(uint64_t* acc,
+                 const uint8_t* data,
+                 const uint64_t* key)
+{
+    for(uint32_t i = 0; i < 4; i++)
+    {
+        uint64_t value = 0;
+        memcpy(&value, &data[i * 8], 8);
+        const uint64_t mixed = value ^ key[i];
+        acc[i ^ 1] += value;
+        acc[i] += (mixed & 0xffffffffULL) * (mixed >> 32);
+    }
+}
+
+/**
+ * @brief scramble the accumulator after each complete block, so the accumulation is not
+ *        linear over the whole input and the result depends on the order of the blocks
+ *
+ * @param acc accumulator with 4 lanes
+ * @param secret seeded secret
+ */
+inline void
+scrambleAccumulator(uint64_t* acc,
+                    const uint64_t* secret)
+{
+    for(uint32_t i = 0; i < 4; i++)
+    {
+        acc[i] ^= acc[i] >> 47;
+        acc[i] ^= secret[HASH_SCRAMBLE_OFFSET + i];
+        acc[i] *= HASH_PRIME32_1;
+    }
+}
+
+#ifdef HANAMI_X86_SIMD
+
+/**
+ * @brief AVX2-version of the accumulation of all complete blocks
+ *
+ * @return number of processed bytes
+ */
+HANAMI_TARGET_AVX2 uint64_t
+accumulateAvx2(uint64_t* acc,
+               const uint8_t* data,
+               const uint64_t numberOfBytes,
+               const uint64_t* secret)
+{
+    const __m256i scrambleKey = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(&secret[HASH_SCRAMBLE_OFFSET]));
+    const __m256i prime = _mm256_set1_epi64x(HASH_PRIME32_1);
+    __m256i accumulator = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc));
+
+    uint64_t pos = 0;
+    for(; pos + HASH_BLOCK_SIZE <= numberOfBytes; pos += HASH_BLOCK_SIZE)
+    {
+        for(uint32_t stripe = 0; stripe < HASH_STRIPES_PER_BLOCK; stripe++)
+        {
+            const uint8_t* stripeData = &data[pos + stripe * HASH_STRIPE_SIZE];
+            const __m256i value = _mm256_loadu_si256(
+                        reinterpret_cast<const __m256i*>(stripeData));
+            const __m256i key = _mm256_loadu_si256(
+                        reinterpret_cast<const __m256i*>(&secret[stripe]));
+            const __m256i mixed = _mm256_xor_si256(value, key);
+            const __m256i product = _mm256_mul_epu32(mixed, _mm256_srli_epi64(mixed, 32));
+
+            // swap the 64-bit values within each 128-bit lane to add them to the neighbor
+            const __m256i swapped = _mm256_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+            accumulator = _mm256_add_epi64(accumulator, swapped);
+            accumulator = _mm256_add_epi64(accumulator, product);
+        }
+
+        // scramble with a 64-bit multiplication by a 32-bit prime, which is split into two
+        // 32-bit multiplications, because AVX2 has no 64-bit multiplication
+        accumulator = _mm256_xor_si256(accumulator, _mm256_srli_epi64(accumulator, 47));
+        accumulator = _mm256_xor_si256(accumulator, scrambleKey);
+        const __m256i low = _mm256_mul_epu32(accumulator, prime);
+        const __m256i high = _mm256_mul_epu32(_mm256_srli_epi64(accumulator, 32), prime);
+        accumulator = _mm256_add_epi64(low, _mm256_slli_epi64(high, 32));
+    }
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc), accumulator);
+    return pos;
+}
+
+#endif
+
+/**
+ * @brief fast 64-bit hash over a block of bytes in the style of xxh3. The SIMD- and
+ *        scalar-version produce the same hash. The seed changes the secret itself, so hashes
+ *        of the same data with different seeds are independent from each other.
+ *
+ * @param data pointer to the data
+ * @param numberOfBytes number of bytes
+ * @param seed seed to get independent hashes of the same data
+ *
+ * @return hash of the data
+ */
+uint64_t
+hashBytes(const void* data,
+          const uint64_t numberOfBytes,
+          const uint64_t seed)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+    // derive the secret from the seed, like xxh3 does it
+    const uint64_t seedKey = avalanche(seed * HASH_PRIME_1);
+    uint64_t secret[HASH_SECRET_SIZE];
+    for(uint32_t i = 0; i < HASH_SECRET_SIZE; i++)
+    {
+        if(i % 2 == 0) {
+            secret[i] = HASH_SECRET[i] + seedKey;
+        } else {
+            secret[i] = HASH_SECRET[i] - seedKey;
+        }
+    }
+
+    uint64_t acc[4] = {HASH_PRIME_1, HASH_PRIME_2, HASH_PRIME_3, HASH_PRIME_1 ^ HASH_PRIME_2};
+
+    uint64_t pos = 0;
+#ifdef HANAMI_X86_SIMD
+    if(hasAvx2()) {
+        pos = accumulateAvx2(acc, bytes, numberOfBytes, secret);
+    }
+#endif
+    for(; pos + HASH_BLOCK_SIZE <= numberOfBytes; pos += HASH_BLOCK_SIZE)
+    {
+        for(uint32_t stripe = 0; stripe < HASH_STRIPES_PER_BLOCK; stripe++) {
+            accumulateStripe(acc, &bytes[pos + stripe * HASH_STRIPE_SIZE], &secret[stripe]);
+        }
+        scrambleAccumulator(acc, secret);
+    }
+
+    // remaining stripes of the last incomplete block
+    uint32_t stripe = 0;
+    for(; pos + HASH_STRIPE_SIZE <= numberOfBytes; pos += HASH_STRIPE_SIZE)
+    {
+        accumulateStripe(acc, &bytes[pos], &secret[stripe]);
+        stripe++;
+    }
+
+    // last incomplete stripe is padded with zeros, which is unique in combination with the length
+    if(pos < numberOfBytes)
+    {
+        uint8_t lastStripe[HASH_STRIPE_SIZE];
+        memset(lastStripe, 0, HASH_STRIPE_SIZE);
+        memcpy(lastStripe, &bytes[pos], numberOfBytes - pos);
+        accumulateStripe(acc, lastStripe, &secret[stripe]);
+    }
+
+    uint64_t result = (numberOfBytes * HASH_PRIME_1) ^ seedKey;
+    for(uint32_t i = 0; i < 4; i++)
+    {
+        result ^= avalanche(acc[i] + i * HASH_PRIME_2);
+        result *= HASH_PRIME_1;
+    }
+
+    return avalanche(result);
+}
+
+} // namespace HanamiAI
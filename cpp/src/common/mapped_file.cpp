@@ -0,0 +1,165 @@
+/**
+ * @file        mapped_file.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <common/mapped_file.h>
+
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace HanamiAI
+{
+
+/**
+ * @brief constructor
+ */
+MappedFile::MappedFile() {}
+
+/**
+ * @brief destructor
+ */
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+/**
+ * @brief map a file into the memory
+ *
+ * @param filePath path to the file
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+MappedFile::open(const std::string &filePath,
+                 Kitsunemimi::ErrorContainer &error)
+{
+    close();
+
+    const int fd = ::open(filePath.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        error.addMeesage("Failed to open file '"
+                         + filePath
+                         + "': "
+                         + std::string(strerror(errno)));
+        return false;
+    }
+
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) < 0)
+    {
+        error.addMeesage("Failed to get size of file '" + filePath + "'");
+        ::close(fd);
+        return false;
+    }
+
+    // an empty file can not be mapped, but is still a valid file with size 0
+    m_size = static_cast<uint64_t>(fileStat.st_size);
+    if(m_size == 0)
+    {
+        ::close(fd);
+        return true;
+    }
+
+    void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // the mapping stays valid after closing the file-descriptor
+    ::close(fd);
+
+    if(data == MAP_FAILED)
+    {
+        error.addMeesage("Failed to map file '"
+                         + filePath
+                         + "' into memory: "
+                         + std::string(strerror(errno)));
+        m_size = 0;
+        return false;
+    }
+
+    m_data = static_cast<uint8_t*>(data);
+    madvise(m_data, m_size, MADV_SEQUENTIAL);
+
+    return true;
+}
+
+/**
+ * @brief unmap the file
+ */
+void
+MappedFile::close()
+{
+    if(m_data != nullptr) {
+        munmap(m_data, m_size);
+    }
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+/**
+ * @brief tell the kernel, that a part of the file will be needed soon, so it is read in the
+ *        background, before it is accessed
+ *
+ * @param position start of the part within the file
+ * @param size size of the part
+ */
+void
+MappedFile::prefetch(const uint64_t position,
+                     const uint64_t size)
+{
+    if(m_data == nullptr || position >= m_size) {
+        return;
+    }
+
+    // madvise requires an address, which is aligned to the page-size
+    static const uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    const uint64_t start = position - (position % pageSize);
+    const uint64_t end = std::min(position + size, m_size);
+
+    madvise(m_data + start, end - start, MADV_WILLNEED);
+}
+
+/**
+ * @brief get pointer to the mapped data or nullptr, if no file is mapped or the file is empty
+ */
+const uint8_t*
+MappedFile::getData() const
+{
+    return m_data;
+}
+
+/**
+ * @brief get size of the mapped file
+ */
+uint64_t
+MappedFile::getSize() const
+{
+    return m_size;
+}
+
+} // namespace HanamiAI
@@ -0,0 +1,64 @@
+/**
+ * @file        mapped_file.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMISDK_MAPPED_FILE_H
+#define KITSUNEMIMI_HANAMISDK_MAPPED_FILE_H
+
+#include <string>
+#include <stdint.h>
+
+#include <libKitsunemimiCommon/logger.h>
+
+namespace HanamiAI
+{
+
+/**
+ * @brief Read-only memory-mapping of a complete file. The file is mapped for sequential
+ *        access, so the kernel reads ahead and drops pages, which were already read, early.
+ */
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string &filePath,
+              Kitsunemimi::ErrorContainer &error);
+    void close();
+
+    void prefetch(const uint64_t position,
+                  const uint64_t size);
+
+    const uint8_t* getData() const;
+    uint64_t getSize() const;
+
+private:
+    uint8_t* m_data = nullptr;
+    uint64_t m_size = 0;
+};
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_MAPPED_FILE_H
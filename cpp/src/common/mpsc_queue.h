@@ -0,0 +1,128 @@
+/**
+ * @file        mpsc_queue.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMISDK_MPSC_QUEUE_H
+#define KITSUNEMIMI_HANAMISDK_MPSC_QUEUE_H
+
+#include <atomic>
+
+namespace HanamiAI
+{
+
+/**
+ * @brief base of all objects, which can be linked into a MpscQueue
+ */
+struct MpscNode
+{
+    std::atomic<MpscNode*> next {nullptr};
+};
+
+/**
+ * @brief intrusive lock-free queue for multiple producers and a single consumer
+ *        (based on the queue of Dmitry Vyukov). Pushing is wait-free and never allocates,
+ *        because the nodes are provided by the producers.
+ */
+class MpscQueue
+{
+public:
+    MpscQueue()
+    {
+        m_head.store(&m_stub, std::memory_order_relaxed);
+        m_tail = &m_stub;
+    }
+
+    /**
+     * @brief add a node to the queue (can be called by any thread)
+     *
+     * @param node node to add
+     */
+    void push(MpscNode* node)
+    {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        MpscNode* prev = m_head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * @brief get the oldest node of the queue (must only be called by the consumer-thread)
+     *
+     * @return nullptr, if queue is empty or a producer is in the middle of a push, else the
+     *         oldest node
+     */
+    MpscNode* pop()
+    {
+        MpscNode* tail = m_tail;
+        MpscNode* next = tail->next.load(std::memory_order_acquire);
+
+        // skip the stub-node
+        if(tail == &m_stub)
+        {
+            if(next == nullptr) {
+                return nullptr;
+            }
+            m_tail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if(next != nullptr)
+        {
+            m_tail = next;
+            return tail;
+        }
+
+        // a producer has already swapped the head, but not linked its node yet
+        if(tail != m_head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+
+        // tail is the last node, so add the stub again to be able to release the tail
+        push(&m_stub);
+        next = tail->next.load(std::memory_order_acquire);
+        if(next != nullptr)
+        {
+            m_tail = next;
+            return tail;
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * @brief check if the queue is empty (must only be called by the consumer-thread)
+     *
+     * @return true, if no node is in the queue and no producer is in the middle of a push
+     */
+    bool isEmpty() const
+    {
+        return m_tail == &m_stub && m_head.load(std::memory_order_acquire) == &m_stub;
+    }
+
+private:
+    std::atomic<MpscNode*> m_head;
+    MpscNode* m_tail;
+    MpscNode m_stub;
+};
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_MPSC_QUEUE_H
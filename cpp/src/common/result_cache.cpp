@@ -0,0 +1,273 @@
+/**
+ * @file        result_cache.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <common/result_cache.h>
+#include <common/hash.h>
+
+#include <string.h>
+#include <mutex>
+#include <map>
+#include <memory>
+
+// fixed overhead of a cache-entry for list- and map-nodes, which is added to the size of the
+// values, so many small entries can not exceed the limit of the cache
+#define CACHE_ENTRY_OVERHEAD 96
+
+namespace HanamiAI
+{
+
+/**
+ * @brief hash of the input-values of a request
+ *
+ * @param values pointer to the values
+ * @param numberOfValues number of values
+ *
+ * @return hash of the values
+ */
+uint64_t
+hashValues(const float* values,
+           const uint64_t numberOfValues)
+{
+    return hashBytes(values, numberOfValues * sizeof(float));
+}
+
+//==================================================================================================
+// cluster-generations
+//==================================================================================================
+
+std::mutex g_generationLock;
+std::map<std::string, std::unique_ptr<std::atomic<uint64_t>>> g_clusterGenerations;
+
+/**
+ * @brief get the counter, which is increased each time, when the cluster was changed
+ *
+ * @param clusterUuid uuid of the cluster
+ *
+ * @return pointer to the counter of the cluster, which stays valid until the end of the program
+ */
+std::atomic<uint64_t>*
+getClusterGeneration(const std::string &clusterUuid)
+{
+    std::lock_guard<std::mutex> guard(g_generationLock);
+
+    std::unique_ptr<std::atomic<uint64_t>> &generation = g_clusterGenerations[clusterUuid];
+    if(generation == nullptr) {
+        generation.reset(new std::atomic<uint64_t>(0));
+    }
+
+    return generation.get();
+}
+
+/**
+ * @brief invalidate all cached results of a cluster
+ *
+ * @param clusterUuid uuid of the cluster, which was changed
+ */
+void
+invalidateClusterResults(const std::string &clusterUuid)
+{
+    getClusterGeneration(clusterUuid)->fetch_add(1, std::memory_order_release);
+}
+
+//==================================================================================================
+// cache
+//==================================================================================================
+
+/**
+ * @brief constructor
+ *
+ * @param maxBytes maximum number of bytes of all cached values
+ * @param clusterUuid uuid of the cluster, which produces the results
+ */
+ResultCache::ResultCache(const uint64_t maxBytes,
+                         const std::string &clusterUuid)
+{
+    m_maxBytes = maxBytes;
+    m_clusterGeneration = getClusterGeneration(clusterUuid);
+    m_generation = m_clusterGeneration->load(std::memory_order_acquire);
+}
+
+/**
+ * @brief drop all entries, if the cluster was changed since they were added
+ */
+void
+ResultCache::checkGeneration()
+{
+    const uint64_t generation = m_clusterGeneration->load(std::memory_order_acquire);
+    if(generation != m_generation)
+    {
+        clear();
+        m_generation = generation;
+    }
+}
+
+/**
+ * @brief get the current generation of the cluster. It has to be read before a request is
+ *        sent and given to the add-function together with the result of the request.
+ *
+ * @return current generation of the cluster
+ */
+uint64_t
+ResultCache::getGeneration() const
+{
+    return m_clusterGeneration->load(std::memory_order_acquire);
+}
+
+/**
+ * @brief remove all entries
+ */
+void
+ResultCache::clear()
+{
+    m_entries.clear();
+    m_index.clear();
+    m_usedBytes = 0;
+}
+
+/**
+ * @brief remove a single entry
+ */
+void
+ResultCache::removeEntry(std::list<CacheEntry>::iterator it)
+{
+    m_usedBytes -= (it->input.size() + it->output.size()) * sizeof(float)
+                   + CACHE_ENTRY_OVERHEAD;
+    m_index.erase(it->hash);
+    m_entries.erase(it);
+}
+
+/**
+ * @brief get cached output-values for an input
+ *
+ * @param inputValues pointer to the input-values
+ * @param numberOfInputValues number of input-values
+ * @param hash hash of the input-values
+ * @param outputValues reference for the output-values
+ *
+ * @return true, if found, else false
+ */
+bool
+ResultCache::get(const float* inputValues,
+                 const uint64_t numberOfInputValues,
+                 const uint64_t hash,
+                 std::vector<float> &outputValues)
+{
+    checkGeneration();
+
+    const auto indexIt = m_index.find(hash);
+    if(indexIt == m_index.end())
+    {
+        m_numberOfMisses++;
+        return false;
+    }
+
+    // compare the input itself, to be safe against hash-collisions
+    const std::list<CacheEntry>::iterator it = indexIt->second;
+    // an empty input is not compared, because its pointers can be null
+    if(it->input.size() != numberOfInputValues
+            || (numberOfInputValues > 0
+                && memcmp(it->input.data(), inputValues, numberOfInputValues * sizeof(float)) != 0))
+    {
+        m_numberOfMisses++;
+        return false;
+    }
+
+    // move entry to the front of the LRU-list
+    m_entries.splice(m_entries.begin(), m_entries, it);
+    outputValues = it->output;
+    m_numberOfHits++;
+
+    return true;
+}
+
+/**
+ * @brief add a new result to the cache and evict the least recently used entries, as long as
+ *        the cache is over its limit
+ *
+ * @param inputValues pointer to the input-values
+ * @param numberOfInputValues number of input-values
+ * @param hash hash of the input-values
+ * @param outputValues pointer to the output-values
+ * @param numberOfOutputValues number of output-values
+ * @param generation generation of the cluster, which was read before the request was sent
+ */
+void
+ResultCache::add(const float* inputValues,
+                 const uint64_t numberOfInputValues,
+                 const uint64_t hash,
+                 const float* outputValues,
+                 const uint64_t numberOfOutputValues,
+                 const uint64_t generation)
+{
+    checkGeneration();
+
+    // the cluster was changed while the request was processed, so the result can be
+    // already outdated and is not cached
+    if(generation != m_generation) {
+        return;
+    }
+
+    const uint64_t entrySize = (numberOfInputValues + numberOfOutputValues) * sizeof(float)
+                               + CACHE_ENTRY_OVERHEAD;
+    if(entrySize > m_maxBytes) {
+        return;
+    }
+
+    // replace old entry with the same hash
+    const auto indexIt = m_index.find(hash);
+    if(indexIt != m_index.end()) {
+        removeEntry(indexIt->second);
+    }
+
+    while(m_usedBytes + entrySize > m_maxBytes) {
+        removeEntry(std::prev(m_entries.end()));
+    }
+
+    CacheEntry entry;
+    entry.hash = hash;
+    entry.input.assign(inputValues, inputValues + numberOfInputValues);
+    entry.output.assign(outputValues, outputValues + numberOfOutputValues);
+
+    m_entries.push_front(std::move(entry));
+    m_index[hash] = m_entries.begin();
+    m_usedBytes += entrySize;
+}
+
+/**
+ * @brief get number of requests, which were answered by the cache
+ */
+uint64_t
+ResultCache::getNumberOfHits() const
+{
+    return m_numberOfHits;
+}
+
+/**
+ * @brief get number of requests, which were not found in the cache
+ */
+uint64_t
+ResultCache::getNumberOfMisses() const
+{
+    return m_numberOfMisses;
+}
+
+} // namespace HanamiAI
@@ -0,0 +1,95 @@
+/**
+ * @file        result_cache.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMISDK_RESULT_CACHE_H
+#define KITSUNEMIMI_HANAMISDK_RESULT_CACHE_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <atomic>
+#include <unordered_map>
+#include <stdint.h>
+
+namespace HanamiAI
+{
+
+uint64_t hashValues(const float* values,
+                    const uint64_t numberOfValues);
+
+std::atomic<uint64_t>* getClusterGeneration(const std::string &clusterUuid);
+void invalidateClusterResults(const std::string &clusterUuid);
+
+/**
+ * @brief LRU-cache for the results of requests, which is limited by the number of bytes of the
+ *        cached values. All entries become invalid, when the generation of the cluster changes,
+ *        because the cluster was trained or restored.
+ */
+class ResultCache
+{
+public:
+    ResultCache(const uint64_t maxBytes,
+                const std::string &clusterUuid);
+
+    bool get(const float* inputValues,
+             const uint64_t numberOfInputValues,
+             const uint64_t hash,
+             std::vector<float> &outputValues);
+    void add(const float* inputValues,
+             const uint64_t numberOfInputValues,
+             const uint64_t hash,
+             const float* outputValues,
+             const uint64_t numberOfOutputValues,
+             const uint64_t generation);
+    void clear();
+
+    uint64_t getGeneration() const;
+
+    uint64_t getNumberOfHits() const;
+    uint64_t getNumberOfMisses() const;
+
+private:
+    struct CacheEntry
+    {
+        uint64_t hash = 0;
+        std::vector<float> input;
+        std::vector<float> output;
+    };
+
+    std::list<CacheEntry> m_entries;
+    std::unordered_map<uint64_t, std::list<CacheEntry>::iterator> m_index;
+
+    uint64_t m_maxBytes = 0;
+    uint64_t m_usedBytes = 0;
+    uint64_t m_numberOfHits = 0;
+    uint64_t m_numberOfMisses = 0;
+
+    std::atomic<uint64_t>* m_clusterGeneration = nullptr;
+    uint64_t m_generation = 0;
+
+    void checkGeneration();
+    void removeEntry(std::list<CacheEntry>::iterator it);
+};
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_RESULT_CACHE_H
@@ -0,0 +1,179 @@
+/**
+ * @file        segment_compression.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <common/segment_compression.h>
+
+#include <string.h>
+#include <lz4.h>
+#include <zstd.h>
+
+// level 1 of zstd is nearly as fast as lz4 for text, but still reaches a much higher ratio
+#define ZSTD_UPLOAD_LEVEL 1
+
+namespace HanamiAI
+{
+
+/**
+ * @brief compress the data of a segment
+ *
+ * @param target buffer for the compressed data, which is resized if necessary
+ * @param data pointer to the data to compress
+ * @param dataSize number of bytes to compress
+ * @param compression compression-algorithm
+ *
+ * @return number of compressed bytes in the target-buffer or 0, if the compression failed or
+ *         the data didn't become smaller, so they should be send uncompressed
+ */
+uint64_t
+compressSegment(std::vector<uint8_t> &target,
+                const uint8_t* data,
+                const uint64_t dataSize,
+                const UploadCompression compression)
+{
+    if(dataSize == 0) {
+        return 0;
+    }
+
+    if(compression == LZ4_COMPRESSION)
+    {
+        if(dataSize > LZ4_MAX_INPUT_SIZE) {
+            return 0;
+        }
+
+        const int inputSize = static_cast<int>(dataSize);
+        const int bound = LZ4_compressBound(inputSize);
+        if(target.size() < static_cast<uint64_t>(bound)) {
+            target.resize(static_cast<uint64_t>(bound));
+        }
+
+        const int compressedSize = LZ4_compress_default(reinterpret_cast<const char*>(data),
+                                                        reinterpret_cast<char*>(&target[0]),
+                                                        inputSize,
+                                                        bound);
+        if(compressedSize <= 0 || static_cast<uint64_t>(compressedSize) >= dataSize) {
+            return 0;
+        }
+
+        return static_cast<uint64_t>(compressedSize);
+    }
+
+    if(compression == ZSTD_COMPRESSION)
+    {
+        const size_t bound = ZSTD_compressBound(dataSize);
+        if(target.size() < bound) {
+            target.resize(bound);
+        }
+
+        const size_t compressedSize = ZSTD_compress(&target[0],
+                                                    bound,
+                                                    data,
+                                                    dataSize,
+                                                    ZSTD_UPLOAD_LEVEL);
+        if(ZSTD_isError(compressedSize) || compressedSize >= dataSize) {
+            return 0;
+        }
+
+        return compressedSize;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief decompress the data of a segment, which was compressed by compressSegment
+ *
+ * @param target buffer for the decompressed data, which is resized to the raw size
+ * @param data pointer to the compressed data
+ * @param dataSize number of compressed bytes
+ * @param rawSize number of bytes of the uncompressed data
+ * @param compression compression-algorithm, which was used for the segment
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+decompressSegment(std::vector<uint8_t> &target,
+                  const uint8_t* data,
+                  const uint64_t dataSize,
+                  const uint64_t rawSize,
+                  const UploadCompression compression,
+                  Kitsunemimi::ErrorContainer &error)
+{
+    target.resize(rawSize);
+
+    if(compression == NO_COMPRESSION)
+    {
+        if(dataSize != rawSize)
+        {
+            error.addMeesage("Size of uncompressed segment doesn't match its raw size");
+            return false;
+        }
+        if(dataSize > 0) {
+            memcpy(&target[0], data, dataSize);
+        }
+        return true;
+    }
+
+    if(rawSize == 0)
+    {
+        error.addMeesage("Compressed segment has no raw size");
+        return false;
+    }
+
+    if(compression == LZ4_COMPRESSION)
+    {
+        if(dataSize > LZ4_MAX_INPUT_SIZE || rawSize > LZ4_MAX_INPUT_SIZE)
+        {
+            error.addMeesage("Lz4-compressed segment is too big");
+            return false;
+        }
+
+        const int size = LZ4_decompress_safe(reinterpret_cast<const char*>(data),
+                                             reinterpret_cast<char*>(&target[0]),
+                                             static_cast<int>(dataSize),
+                                             static_cast<int>(rawSize));
+        if(size < 0 || static_cast<uint64_t>(size) != rawSize)
+        {
+            error.addMeesage("Failed to decompress lz4-compressed segment");
+            return false;
+        }
+
+        return true;
+    }
+
+    if(compression == ZSTD_COMPRESSION)
+    {
+        const size_t size = ZSTD_decompress(&target[0], rawSize, data, dataSize);
+        if(ZSTD_isError(size) || size != rawSize)
+        {
+            error.addMeesage("Failed to decompress zstd-compressed segment");
+            return false;
+        }
+
+        return true;
+    }
+
+    error.addMeesage("Unknown compression of segment: " + std::to_string(compression));
+    return false;
+}
+
+} // namespace HanamiAI
@@ -0,0 +1,55 @@
+/**
+ * @file        segment_compression.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMISDK_SEGMENT_COMPRESSION_H
+#define KITSUNEMIMI_HANAMISDK_SEGMENT_COMPRESSION_H
+
+#include <vector>
+#include <stdint.h>
+
+#include <libHanamiAiSdk/data_set.h>
+#include <libKitsunemimiCommon/logger.h>
+
+// The FileUpload_Message has no field for the compression, so the compression and the size of
+// the uncompressed data are appended to the message as additional varint-fields. Receivers,
+// which don't know these fields, ignore them.
+#define UPLOAD_COMPRESSION_FIELD_NUMBER 16
+#define UPLOAD_RAW_SIZE_FIELD_NUMBER 17
+
+namespace HanamiAI
+{
+
+uint64_t compressSegment(std::vector<uint8_t> &target,
+                         const uint8_t* data,
+                         const uint64_t dataSize,
+                         const UploadCompression compression);
+
+bool decompressSegment(std::vector<uint8_t> &target,
+                       const uint8_t* data,
+                       const uint64_t dataSize,
+                       const uint64_t rawSize,
+                       const UploadCompression compression,
+                       Kitsunemimi::ErrorContainer &error);
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_SEGMENT_COMPRESSION_H
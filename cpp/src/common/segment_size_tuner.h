@@ -0,0 +1,151 @@
+/**
+ * @file        segment_size_tuner.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMISDK_SEGMENT_SIZE_TUNER_H
+#define KITSUNEMIMI_HANAMISDK_SEGMENT_SIZE_TUNER_H
+
+#include <chrono>
+#include <algorithm>
+#include <stdint.h>
+
+// minimal relative increase of the throughput, which is necessary to double the segment-size
+// again, so the size doesn't grow because of measurement-noise
+#define SEGMENT_TUNER_MIN_GAIN 1.05
+
+// minimal number of bytes, which have to be send with a segment-size, before its throughput
+// is compared to the previous size
+#define SEGMENT_TUNER_MIN_WINDOW (4 * 1024 * 1024)
+
+// number of segments, which have to be send with a segment-size, before its throughput
+// is compared to the previous size
+#define SEGMENT_TUNER_WINDOW_SEGMENTS 16
+
+namespace HanamiAI
+{
+
+/**
+ * @brief Selects the size of the upload-segments. If adaption is enabled, the size is doubled,
+ *        as long as the measured throughput increases, and falls back to the best size, when
+ *        the throughput doesn't increase anymore.
+ */
+class SegmentSizeTuner
+{
+public:
+    /**
+     * @brief constructor
+     *
+     * @param initialSize segment-size at the beginning
+     * @param maxSize maximum segment-size
+     * @param adaptive true to adapt the segment-size by the throughput
+     */
+    SegmentSizeTuner(const uint64_t initialSize,
+                     const uint64_t maxSize,
+                     const bool adaptive)
+    {
+        m_segmentSize = initialSize;
+        m_bestSize = initialSize;
+        m_maxSize = std::max(maxSize, initialSize);
+        m_finished = adaptive == false || m_segmentSize >= m_maxSize;
+    }
+
+    /**
+     * @brief get the size for the next segment
+     */
+    uint64_t getSegmentSize() const
+    {
+        return m_segmentSize;
+    }
+
+    /**
+     * @brief update the segment-size with the progress of the upload
+     *
+     * @param sentBytes number of bytes, which were completely send until now
+     */
+    void update(const uint64_t sentBytes)
+    {
+        update(sentBytes, std::chrono::steady_clock::now());
+    }
+
+    /**
+     * @brief update the segment-size with the progress of the upload at a specific time
+     *
+     * @param sentBytes number of bytes, which were completely send until now
+     * @param now current time
+     */
+    void update(const uint64_t sentBytes,
+                const std::chrono::steady_clock::time_point now)
+    {
+        if(m_finished) {
+            return;
+        }
+
+        if(m_windowStarted == false)
+        {
+            m_windowStarted = true;
+            m_windowStart = now;
+            m_windowStartBytes = sentBytes;
+            return;
+        }
+
+        const uint64_t windowBytes = sentBytes - m_windowStartBytes;
+        const uint64_t windowSize = std::max(static_cast<uint64_t>(SEGMENT_TUNER_MIN_WINDOW),
+                                             m_segmentSize * SEGMENT_TUNER_WINDOW_SEGMENTS);
+        if(windowBytes < windowSize) {
+            return;
+        }
+
+        const double seconds = std::chrono::duration<double>(now - m_windowStart).count();
+        const double throughput = static_cast<double>(windowBytes) / std::max(seconds, 1e-9);
+
+        if(throughput > m_bestThroughput * SEGMENT_TUNER_MIN_GAIN)
+        {
+            m_bestThroughput = throughput;
+            m_bestSize = m_segmentSize;
+
+            m_segmentSize = std::min(m_segmentSize * 2, m_maxSize);
+            m_finished = m_segmentSize == m_bestSize;
+        }
+        else
+        {
+            m_segmentSize = m_bestSize;
+            m_finished = true;
+        }
+
+        m_windowStart = now;
+        m_windowStartBytes = sentBytes;
+    }
+
+private:
+    uint64_t m_segmentSize = 0;
+    uint64_t m_maxSize = 0;
+    uint64_t m_bestSize = 0;
+    double m_bestThroughput = 0.0;
+    bool m_finished = false;
+
+    bool m_windowStarted = false;
+    std::chrono::steady_clock::time_point m_windowStart;
+    uint64_t m_windowStartBytes = 0;
+};
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_SEGMENT_SIZE_TUNER_H
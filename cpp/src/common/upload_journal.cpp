@@ -0,0 +1,495 @@
+/**
+ * @file        upload_journal.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <common/upload_journal.h>
+#include <common/upload_source.h>
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+// first line of each journal-file, to detect other files and future changes of the format
+#define JOURNAL_HEADER "hanami-upload-journal 2"
+
+// minimal time between two writes of the journal while updating the ranges
+#define JOURNAL_SAVE_INTERVAL std::chrono::seconds(1)
+
+namespace HanamiAI
+{
+
+/**
+ * @brief constructor
+ *
+ * @param journalPath path of the local journal-file
+ */
+UploadJournal::UploadJournal(const std::string &journalPath)
+{
+    m_journalPath = journalPath;
+    m_lastSave = std::chrono::steady_clock::now();
+}
+
+/**
+ * @brief get path of the journal-file
+ */
+const std::string&
+UploadJournal::getPath() const
+{
+    return m_journalPath;
+}
+
+/**
+ * @brief set the data-set of the upload
+ *
+ * @param datasetUuid uuid of the data-set
+ * @param datasetType type of the data-set ("csv" or "mnist")
+ * @param datasetName name of the data-set, which is necessary to restart the upload
+ */
+void
+UploadJournal::setDataset(const std::string &datasetUuid,
+                          const std::string &datasetType,
+                          const std::string &datasetName)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_datasetUuid = datasetUuid;
+    m_datasetType = datasetType;
+    m_datasetName = datasetName;
+}
+
+/**
+ * @brief add a file to the upload
+ *
+ * @param file file with its uuid in shiori and its state, which was read by readFileState
+ */
+void
+UploadJournal::addFile(const JournalFile &file)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    m_files.push_back(file);
+    m_files.back().sentRanges.clear();
+}
+
+/**
+ * @brief get the uuid of the data-set of the upload
+ */
+std::string
+UploadJournal::getDatasetUuid()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_datasetUuid;
+}
+
+/**
+ * @brief get the type of the data-set of the upload
+ */
+std::string
+UploadJournal::getDatasetType()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_datasetType;
+}
+
+/**
+ * @brief get the name of the data-set of the upload
+ */
+std::string
+UploadJournal::getDatasetName()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_datasetName;
+}
+
+/**
+ * @brief get all files of the upload
+ */
+std::vector<JournalFile>
+UploadJournal::getFiles()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_files;
+}
+
+/**
+ * @brief get file by its uuid (must be called while holding the lock)
+ *
+ * @return nullptr, if not found, else pointer to the file
+ */
+JournalFile*
+UploadJournal::getFile(const std::string &fileUuid)
+{
+    for(JournalFile &file : m_files)
+    {
+        if(file.fileUuid == fileUuid) {
+            return &file;
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief mark a range of a file as send and write the journal, if the last write is older
+ *        than the save-interval
+ *
+ * @param fileUuid uuid of the file
+ * @param start first byte of the range
+ * @param end first byte after the range
+ */
+void
+UploadJournal::addSentRange(const std::string &fileUuid,
+                            const uint64_t start,
+                            const uint64_t end)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    JournalFile* file = getFile(fileUuid);
+    if(file == nullptr || end <= start) {
+        return;
+    }
+
+    // insert the new range and merge it with all ranges, which overlap or touch it
+    std::vector<ByteRange> &ranges = file->sentRanges;
+    ByteRange newRange;
+    newRange.start = start;
+    newRange.end = end;
+    const auto pos = std::lower_bound(ranges.begin(),
+                                      ranges.end(),
+                                      newRange,
+                                      [](const ByteRange &a, const ByteRange &b) {
+                                          return a.start < b.start;
+                                      });
+    ranges.insert(pos, newRange);
+
+    std::vector<ByteRange> merged;
+    for(const ByteRange &range : ranges)
+    {
+        if(merged.size() > 0 && range.start <= merged.back().end) {
+            merged.back().end = std::max(merged.back().end, range.end);
+        } else {
+            merged.push_back(range);
+        }
+    }
+    ranges.swap(merged);
+
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if(now - m_lastSave >= JOURNAL_SAVE_INTERVAL)
+    {
+        Kitsunemimi::ErrorContainer error;
+        if(writeToDisk(error) == false) {
+            LOG_ERROR(error);
+        }
+    }
+}
+
+/**
+ * @brief get all ranges of a file, which were not send until now
+ *
+ * @param fileUuid uuid of the file
+ *
+ * @return missing ranges in ascending order
+ */
+std::vector<ByteRange>
+UploadJournal::getMissingRanges(const std::string &fileUuid)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    std::vector<ByteRange> missing;
+    JournalFile* file = getFile(fileUuid);
+    if(file == nullptr) {
+        return missing;
+    }
+
+    uint64_t pos = 0;
+    for(const ByteRange &range : file->sentRanges)
+    {
+        if(range.start > pos)
+        {
+            ByteRange gap;
+            gap.start = pos;
+            gap.end = range.start;
+            missing.push_back(gap);
+        }
+        pos = std::max(pos, range.end);
+    }
+
+    if(pos < file->fileSize)
+    {
+        ByteRange gap;
+        gap.start = pos;
+        gap.end = file->fileSize;
+        missing.push_back(gap);
+    }
+
+    return missing;
+}
+
+/**
+ * @brief write the journal to disk (must be called while holding the lock). The journal is
+ *        written into a temporary file first, which replaces the old journal afterwards, so
+ *        a crash while writing doesn't destroy the old journal.
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+UploadJournal::writeToDisk(Kitsunemimi::ErrorContainer &error)
+{
+    m_lastSave = std::chrono::steady_clock::now();
+
+    std::ostringstream content;
+    content << JOURNAL_HEADER << "\n";
+    content << "dataset " << m_datasetUuid << " " << m_datasetType << " " << m_datasetName << "\n";
+    for(const JournalFile &file : m_files)
+    {
+        content << "file "
+                << file.fileUuid << " "
+                << file.fileSize << " "
+                << file.modificationTime << " "
+                << file.contentHash << " "
+                << file.filePath << "\n";
+    }
+    for(const JournalFile &file : m_files)
+    {
+        for(const ByteRange &range : file.sentRanges) {
+            content << "range " << file.fileUuid << " " << range.start << " " << range.end << "\n";
+        }
+    }
+
+    const std::string tempPath = m_journalPath + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ofstream::trunc);
+        out << content.str();
+        out.close();
+        if(out.fail())
+        {
+            error.addMeesage("Failed to write upload-journal '" + tempPath + "'");
+            return false;
+        }
+    }
+
+    if(rename(tempPath.c_str(), m_journalPath.c_str()) != 0)
+    {
+        error.addMeesage("Failed to replace upload-journal '"
+                         + m_journalPath
+                         + "': "
+                         + std::string(strerror(errno)));
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief write the journal to disk
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+UploadJournal::save(Kitsunemimi::ErrorContainer &error)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return writeToDisk(error);
+}
+
+/**
+ * @brief delete the journal-file, after the upload was completed
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+UploadJournal::remove(Kitsunemimi::ErrorContainer &error)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if(::remove(m_journalPath.c_str()) != 0 && errno != ENOENT)
+    {
+        error.addMeesage("Failed to delete upload-journal '"
+                         + m_journalPath
+                         + "': "
+                         + std::string(strerror(errno)));
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief read the journal from disk
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+UploadJournal::load(Kitsunemimi::ErrorContainer &error)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    std::ifstream in(m_journalPath);
+    if(in.is_open() == false)
+    {
+        error.addMeesage("Failed to open upload-journal '" + m_journalPath + "'");
+        return false;
+    }
+
+    std::string line;
+    if(std::getline(in, line).fail() || line != JOURNAL_HEADER)
+    {
+        error.addMeesage("File '" + m_journalPath + "' is not a valid upload-journal");
+        return false;
+    }
+
+    m_files.clear();
+    std::vector<std::pair<std::string, ByteRange>> ranges;
+
+    while(std::getline(in, line))
+    {
+        std::istringstream lineStream(line);
+        std::string type;
+        lineStream >> type;
+
+        if(type == "dataset")
+        {
+            lineStream >> m_datasetUuid >> m_datasetType;
+            if(lineStream.fail() == false)
+            {
+                // the name is the rest of the line, because it can contain spaces or be empty
+                m_datasetName = "";
+                lineStream.get();
+                std::getline(lineStream, m_datasetName);
+                lineStream.clear();
+            }
+        }
+        else if(type == "file")
+        {
+            // the path is the rest of the line, because it can contain spaces
+            JournalFile file;
+            lineStream >> file.fileUuid
+                       >> file.fileSize
+                       >> file.modificationTime
+                       >> file.contentHash;
+            lineStream.get();
+            std::getline(lineStream, file.filePath);
+            m_files.push_back(file);
+        }
+        else if(type == "range")
+        {
+            std::pair<std::string, ByteRange> range;
+            lineStream >> range.first >> range.second.start >> range.second.end;
+            ranges.push_back(range);
+        }
+
+        if(lineStream.fail())
+        {
+            error.addMeesage("Broken line in upload-journal '" + m_journalPath + "': " + line);
+            return false;
+        }
+    }
+
+    // ranges are written sorted and merged, so they can be added directly
+    for(const std::pair<std::string, ByteRange> &range : ranges)
+    {
+        JournalFile* file = getFile(range.first);
+        if(file == nullptr)
+        {
+            error.addMeesage("Upload-journal '"
+                             + m_journalPath
+                             + "' contains range of unknown file '"
+                             + range.first
+                             + "'");
+            return false;
+        }
+        file->sentRanges.push_back(range.second);
+    }
+
+    if(m_datasetUuid.size() == 0)
+    {
+        error.addMeesage("Upload-journal '" + m_journalPath + "' has no data-set");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief read the state of a local file, which is stored in the journal to detect changes of
+ *        the file before the upload is resumed
+ *
+ * @param file reference for the absolute path, size, modification-time and content-hash. The
+ *             uuid and the ranges are not changed.
+ * @param source source of the file, which is used to read the content for the hash
+ * @param numberOfHashThreads number of threads for hashing or 0 to select it automatically
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+readFileState(JournalFile &file,
+              UploadSource &source,
+              const uint32_t numberOfHashThreads,
+              Kitsunemimi::ErrorContainer &error)
+{
+    char* absolutePath = realpath(source.getFilePath().c_str(), nullptr);
+    if(absolutePath == nullptr)
+    {
+        error.addMeesage("Failed to get absolute path of file '"
+                         + source.getFilePath()
+                         + "': "
+                         + std::string(strerror(errno)));
+        return false;
+    }
+    file.filePath = std::string(absolutePath);
+    free(absolutePath);
+
+    struct stat fileStat;
+    if(stat(file.filePath.c_str(), &fileStat) != 0)
+    {
+        error.addMeesage("Failed to get state of file '"
+                         + file.filePath
+                         + "': "
+                         + std::string(strerror(errno)));
+        return false;
+    }
+    file.modificationTime = static_cast<int64_t>(fileStat.st_mtim.tv_sec) * 1000000000LL
+                            + static_cast<int64_t>(fileStat.st_mtim.tv_nsec);
+    file.fileSize = source.getSize();
+
+    if(source.getContentHash(file.contentHash, numberOfHashThreads, error) == false)
+    {
+        error.addMeesage("Failed to read file '" + file.filePath + "' for hashing");
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace HanamiAI
@@ -0,0 +1,112 @@
+/**
+ * @file        upload_journal.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMISDK_UPLOAD_JOURNAL_H
+#define KITSUNEMIMI_HANAMISDK_UPLOAD_JOURNAL_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <stdint.h>
+
+#include <libKitsunemimiCommon/logger.h>
+
+namespace HanamiAI
+{
+class UploadSource;
+
+// range of bytes within a file, with the end as first byte after the range
+struct ByteRange
+{
+    uint64_t start = 0;
+    uint64_t end = 0;
+};
+
+struct JournalFile
+{
+    std::string fileUuid = "";
+    // absolute path, so the upload can be resumed from another working-directory
+    std::string filePath = "";
+    uint64_t fileSize = 0;
+    // modification-time in nanoseconds and content-hash of the file at the start of the
+    // upload, to detect changes of the file before it is resumed
+    int64_t modificationTime = 0;
+    std::string contentHash = "";
+    // sorted and merged ranges, which were already send
+    std::vector<ByteRange> sentRanges;
+};
+
+/**
+ * @brief Local file with the state of an upload, to be able to resume the upload after a lost
+ *        connection. It stores the uuids of the data-set and its files together with the
+ *        ranges of each file, which were already send, and the state of each file at the start
+ *        of the upload, to detect changed files before resuming. Can be updated by multiple
+ *        threads at the same time and is written to disk at most once per second while
+ *        updating.
+ */
+class UploadJournal
+{
+public:
+    UploadJournal(const std::string &journalPath);
+
+    bool load(Kitsunemimi::ErrorContainer &error);
+    bool save(Kitsunemimi::ErrorContainer &error);
+    bool remove(Kitsunemimi::ErrorContainer &error);
+
+    void setDataset(const std::string &datasetUuid,
+                    const std::string &datasetType,
+                    const std::string &datasetName);
+    void addFile(const JournalFile &file);
+    void addSentRange(const std::string &fileUuid,
+                      const uint64_t start,
+                      const uint64_t end);
+
+    const std::string& getPath() const;
+    std::string getDatasetUuid();
+    std::string getDatasetType();
+    std::string getDatasetName();
+    std::vector<JournalFile> getFiles();
+    std::vector<ByteRange> getMissingRanges(const std::string &fileUuid);
+
+private:
+    std::string m_journalPath = "";
+    std::string m_datasetUuid = "";
+    std::string m_datasetType = "";
+    std::string m_datasetName = "";
+    std::vector<JournalFile> m_files;
+
+    std::mutex m_lock;
+    std::chrono::steady_clock::time_point m_lastSave;
+
+    JournalFile* getFile(const std::string &fileUuid);
+    bool writeToDisk(Kitsunemimi::ErrorContainer &error);
+};
+
+bool readFileState(JournalFile &file,
+                   UploadSource &source,
+                   const uint32_t numberOfHashThreads,
+                   Kitsunemimi::ErrorContainer &error);
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_UPLOAD_JOURNAL_H
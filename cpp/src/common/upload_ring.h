@@ -0,0 +1,268 @@
+/**
+ * @file        upload_ring.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMISDK_UPLOAD_RING_H
+#define KITSUNEMIMI_HANAMISDK_UPLOAD_RING_H
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <stdint.h>
+
+#include <libHanamiAiSdk/data_set.h>
+
+namespace HanamiAI
+{
+
+/**
+ * @brief segment of a file, which was read and waits to be send
+ */
+struct UploadSegment
+{
+    // buffer for the data of the segment, which stays empty, if the data can be send from
+    // its source directly
+    std::vector<uint8_t> data;
+    // buffer for the compressed data, which is kept for the next usage of the segment
+    std::vector<uint8_t> compressed;
+    const uint8_t* payload = nullptr;
+    // number of bytes to send, which is smaller than the size, if the payload is compressed
+    uint64_t payloadSize = 0;
+    UploadCompression compression = NO_COMPRESSION;
+    // position and size of the segment within the uncompressed file
+    uint64_t position = 0;
+    uint64_t size = 0;
+    bool isLast = false;
+};
+
+/**
+ * @brief Fixed number of segment-buffers, which are passed between a reader and one or more
+ *        senders. The reader fills free buffers while the senders still send the previous
+ *        segments, so reading and sending overlap, while the memory stays limited to the
+ *        buffers of the ring. Optionally a number of workers process the read segments, for
+ *        example to compress them, before they are given to the senders.
+ */
+class UploadRing
+{
+public:
+    /**
+     * @brief constructor
+     *
+     * @param numberOfSlots number of segment-buffers
+     * @param bufferSize size of each segment-buffer
+     * @param numberOfWorkers number of workers between the reader and the senders or 0, if
+     *                        the read segments are directly given to the senders
+     */
+    UploadRing(const uint64_t numberOfSlots,
+               const uint64_t bufferSize,
+               const uint64_t numberOfWorkers = 0)
+    {
+        m_numberOfWorkers = numberOfWorkers;
+        m_segments.resize(numberOfSlots);
+        for(UploadSegment &segment : m_segments)
+        {
+            segment.data.resize(bufferSize);
+            m_free.push_back(&segment);
+        }
+    }
+
+    UploadRing(const UploadRing&) = delete;
+    UploadRing& operator=(const UploadRing&) = delete;
+
+    /**
+     * @brief get an empty buffer for the reader and block until one is free
+     *
+     * @return nullptr, if the ring was aborted, else empty segment
+     */
+    UploadSegment* getFree()
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_freeCv.wait(lock, [this] { return m_aborted || m_free.size() > 0; });
+        if(m_aborted) {
+            return nullptr;
+        }
+
+        UploadSegment* segment = m_free.front();
+        m_free.pop_front();
+        return segment;
+    }
+
+    /**
+     * @brief give a segment, which was filled by the reader, to the workers or directly to the
+     *        senders, if the ring has no workers
+     *
+     * @param segment segment, which was filled by the reader
+     */
+    void pushRead(UploadSegment* segment)
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if(m_numberOfWorkers == 0)
+        {
+            m_filled.push_back(segment);
+            m_filledCv.notify_one();
+            return;
+        }
+
+        m_read.push_back(segment);
+        m_readCv.notify_one();
+    }
+
+    /**
+     * @brief get the next read segment for a worker and block until one is available
+     *
+     * @return nullptr, if the ring was aborted or the reader is finished and all segments were
+     *         taken, else read segment
+     */
+    UploadSegment* getRead()
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_readCv.wait(lock, [this] {
+            return m_aborted || m_read.size() > 0 || m_readerFinished;
+        });
+        if(m_aborted || m_read.size() == 0) {
+            return nullptr;
+        }
+
+        UploadSegment* segment = m_read.front();
+        m_read.pop_front();
+        return segment;
+    }
+
+    /**
+     * @brief give a segment, which is ready to send, to the senders
+     *
+     * @param segment segment, which was processed by a worker
+     */
+    void pushFilled(UploadSegment* segment)
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_filled.push_back(segment);
+        m_filledCv.notify_one();
+    }
+
+    /**
+     * @brief get the next filled segment for a sender and block until one is available
+     *
+     * @return nullptr, if the ring was aborted or the reader and all workers are finished and
+     *         all segments were taken, else filled segment
+     */
+    UploadSegment* getFilled()
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_filledCv.wait(lock, [this] {
+            return m_aborted
+                   || m_filled.size() > 0
+                   || (m_readerFinished && m_finishedWorkers == m_numberOfWorkers);
+        });
+        if(m_aborted || m_filled.size() == 0) {
+            return nullptr;
+        }
+
+        UploadSegment* segment = m_filled.front();
+        m_filled.pop_front();
+        return segment;
+    }
+
+    /**
+     * @brief give a segment, which was send, back to the reader
+     *
+     * @param segment segment to release
+     */
+    void release(UploadSegment* segment)
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_sentBytes += segment->size;
+        m_free.push_back(segment);
+        m_freeCv.notify_one();
+    }
+
+    /**
+     * @brief get number of bytes of all segments, which were released by the senders
+     */
+    uint64_t getSentBytes()
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        return m_sentBytes;
+    }
+
+    /**
+     * @brief mark that the reader has read all segments
+     */
+    void finishReader()
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_readerFinished = true;
+        m_readCv.notify_all();
+        m_filledCv.notify_all();
+    }
+
+    /**
+     * @brief mark that a worker has processed all segments
+     */
+    void finishWorker()
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_finishedWorkers++;
+        m_filledCv.notify_all();
+    }
+
+    /**
+     * @brief stop the reader and all senders, for example after an error
+     */
+    void abort()
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_aborted = true;
+        m_freeCv.notify_all();
+        m_readCv.notify_all();
+        m_filledCv.notify_all();
+    }
+
+    /**
+     * @brief check if the ring was aborted
+     */
+    bool isAborted()
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        return m_aborted;
+    }
+
+private:
+    std::vector<UploadSegment> m_segments;
+    std::deque<UploadSegment*> m_free;
+    std::deque<UploadSegment*> m_read;
+    std::deque<UploadSegment*> m_filled;
+
+    std::mutex m_lock;
+    std::condition_variable m_freeCv;
+    std::condition_variable m_readCv;
+    std::condition_variable m_filledCv;
+    uint64_t m_sentBytes = 0;
+    uint64_t m_numberOfWorkers = 0;
+    uint64_t m_finishedWorkers = 0;
+    bool m_readerFinished = false;
+    bool m_aborted = false;
+};
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_UPLOAD_RING_H
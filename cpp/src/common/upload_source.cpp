@@ -0,0 +1,388 @@
+/**
+ * @file        upload_source.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <common/upload_source.h>
+#include <common/content_hash.h>
+
+#include <fstream>
+#include <algorithm>
+#include <string.h>
+
+// number of bytes, which are requested at once from streams and chunk-producers, whose data
+// are collected in memory
+#define UPLOAD_SOURCE_CHUNK_SIZE (1024 * 1024)
+
+// data are hashed chunk by chunk, so sources, which are not in memory, are not read completely
+// into memory
+#define UPLOAD_SOURCE_HASH_CHUNK_SIZE (64ULL * 1024ULL * 1024ULL)
+
+namespace HanamiAI
+{
+
+/**
+ * @brief constructor
+ */
+UploadSource::UploadSource() {}
+
+/**
+ * @brief destructor
+ */
+UploadSource::~UploadSource()
+{
+    delete m_binaryFile;
+}
+
+/**
+ * @brief use a local file as source. The file is mapped into memory and if this fails, it is
+ *        read segment by segment instead.
+ *
+ * @param filePath path to the file
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+UploadSource::initFile(const std::string &filePath,
+                       Kitsunemimi::ErrorContainer &error)
+{
+    m_name = "file '" + filePath + "'";
+    m_filePath = filePath;
+
+    Kitsunemimi::ErrorContainer mapError;
+    if(m_mappedFile.open(filePath, mapError))
+    {
+        m_data = m_mappedFile.getData();
+        m_size = m_mappedFile.getSize();
+        return true;
+    }
+
+    std::ifstream in(filePath, std::ifstream::ate | std::ifstream::binary);
+    const long fileSize = in.tellg();
+    if(fileSize < 0)
+    {
+        error.addMeesage("Failed to get size of file '" + filePath + "'");
+        return false;
+    }
+    m_size = static_cast<uint64_t>(fileSize);
+
+    LOG_WARNING("Failed to map file '" + filePath + "', so it is read with copies");
+    m_binaryFile = new Kitsunemimi::BinaryFile(filePath);
+
+    return true;
+}
+
+/**
+ * @brief use a buffer in memory as source, which is send without copy and must be valid until
+ *        the end of the upload
+ *
+ * @param data pointer to the data
+ * @param dataSize number of bytes of the data
+ */
+void
+UploadSource::initMemory(const uint8_t* data,
+                         const uint64_t dataSize)
+{
+    m_name = "memory-buffer";
+    m_data = data;
+    m_size = dataSize;
+}
+
+/**
+ * @brief use a stream as source. If the stream is seekable, the size is taken from the stream
+ *        and the data are read segment by segment while sending, beginning at the current
+ *        position of the stream. Other streams are read completely into memory.
+ *
+ * @param stream stream, which must be valid until the end of the upload
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+UploadSource::initStream(std::istream &stream,
+                         Kitsunemimi::ErrorContainer &error)
+{
+    m_name = "stream";
+
+    const std::istream::pos_type start = stream.tellg();
+    if(start != std::istream::pos_type(-1))
+    {
+        stream.seekg(0, std::ios::end);
+        const std::istream::pos_type end = stream.tellg();
+        stream.seekg(start);
+        if(end != std::istream::pos_type(-1) && stream.good())
+        {
+            m_stream = &stream;
+            m_streamStart = static_cast<uint64_t>(start);
+            m_streamPosition = m_streamStart;
+            m_size = static_cast<uint64_t>(end - start);
+            return true;
+        }
+        stream.clear();
+    }
+
+    return readStreamIntoBuffer(stream, error);
+}
+
+/**
+ * @brief use a chunk-producer as source. The size of the data is unknown, until the producer
+ *        is finished, so all chunks are collected in memory before the upload.
+ *
+ * @param producer callback, which provides the data
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+UploadSource::initProducer(const UploadChunkProducer &producer,
+                           Kitsunemimi::ErrorContainer &error)
+{
+    m_name = "chunk-producer";
+
+    uint64_t size = 0;
+    while(true)
+    {
+        m_buffer.resize(size + UPLOAD_SOURCE_CHUNK_SIZE);
+        uint64_t numberOfBytes = 0;
+        if(producer(&m_buffer[size], UPLOAD_SOURCE_CHUNK_SIZE, numberOfBytes) == false)
+        {
+            error.addMeesage("Chunk-producer of upload failed after "
+                             + std::to_string(size)
+                             + " bytes");
+            return false;
+        }
+        if(numberOfBytes > UPLOAD_SOURCE_CHUNK_SIZE)
+        {
+            error.addMeesage("Chunk-producer of upload wrote more bytes than the buffer has");
+            return false;
+        }
+        if(numberOfBytes == 0) {
+            break;
+        }
+        size += numberOfBytes;
+    }
+
+    m_buffer.resize(size);
+    m_data = m_buffer.data();
+    m_size = size;
+
+    return true;
+}
+
+/**
+ * @brief read the complete rest of a stream into the internal buffer
+ *
+ * @param stream stream to read
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+UploadSource::readStreamIntoBuffer(std::istream &stream,
+                                   Kitsunemimi::ErrorContainer &error)
+{
+    uint64_t size = 0;
+    while(stream.eof() == false)
+    {
+        m_buffer.resize(size + UPLOAD_SOURCE_CHUNK_SIZE);
+        stream.read(reinterpret_cast<char*>(&m_buffer[size]), UPLOAD_SOURCE_CHUNK_SIZE);
+        if(stream.bad())
+        {
+            error.addMeesage("Failed to read stream of upload after "
+                             + std::to_string(size)
+                             + " bytes");
+            return false;
+        }
+        size += static_cast<uint64_t>(stream.gcount());
+    }
+
+    m_buffer.resize(size);
+    m_data = m_buffer.data();
+    m_size = size;
+
+    return true;
+}
+
+/**
+ * @brief get name of the source for messages
+ */
+const std::string&
+UploadSource::getName() const
+{
+    return m_name;
+}
+
+/**
+ * @brief get path of the file, or an empty string, if the source is not a file
+ */
+const std::string&
+UploadSource::getFilePath() const
+{
+    return m_filePath;
+}
+
+/**
+ * @brief get number of bytes of the source
+ */
+uint64_t
+UploadSource::getSize() const
+{
+    return m_size;
+}
+
+/**
+ * @brief get pointer to the data, if they are completely in memory
+ *
+ * @return nullptr, if the data have to be read with read-function, else pointer to the data
+ */
+const uint8_t*
+UploadSource::getData() const
+{
+    return m_data;
+}
+
+/**
+ * @brief tell the kernel, which part of a mapped file is needed next
+ *
+ * @param position start of the part
+ * @param size number of bytes of the part
+ */
+void
+UploadSource::prefetch(const uint64_t position,
+                       const uint64_t size)
+{
+    if(m_mappedFile.getData() != nullptr) {
+        m_mappedFile.prefetch(position, size);
+    }
+}
+
+/**
+ * @brief copy a part of the data into a buffer. Streams are only seeked, if the part doesn't
+ *        follow directly after the last one, so the data must be read by a single thread.
+ *
+ * @param buffer target-buffer with at least the given size
+ * @param position start of the part within the data
+ * @param size number of bytes to read
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+UploadSource::read(uint8_t* buffer,
+                   const uint64_t position,
+                   const uint64_t size,
+                   Kitsunemimi::ErrorContainer &error)
+{
+    if(position + size > m_size)
+    {
+        error.addMeesage("Read outside of " + m_name);
+        return false;
+    }
+
+    if(m_data != nullptr)
+    {
+        memcpy(buffer, &m_data[position], size);
+        return true;
+    }
+
+    if(m_binaryFile != nullptr)
+    {
+        if(m_binaryFile->readDataFromFile(buffer, position, size, error) == false)
+        {
+            error.addMeesage("Failed to read " + m_name);
+            return false;
+        }
+        return true;
+    }
+
+    if(m_stream != nullptr)
+    {
+        if(m_streamStart + position != m_streamPosition) {
+            m_stream->seekg(static_cast<std::istream::off_type>(m_streamStart + position));
+        }
+
+        m_stream->read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(size));
+        if(static_cast<uint64_t>(m_stream->gcount()) != size)
+        {
+            error.addMeesage("Failed to read " + m_name + " at position "
+                             + std::to_string(position));
+            m_stream->clear();
+            m_streamPosition = UINT64_MAX;
+            return false;
+        }
+        m_streamPosition = m_streamStart + position + size;
+
+        return true;
+    }
+
+    return size == 0;
+}
+
+/**
+ * @brief get the content-hash of the data. The hash is only calculated by the first call.
+ *
+ * @param contentHash reference for the content-hash
+ * @param numberOfHashThreads number of threads for hashing or 0 to select it automatically
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+UploadSource::getContentHash(std::string &contentHash,
+                             const uint32_t numberOfHashThreads,
+                             Kitsunemimi::ErrorContainer &error)
+{
+    if(m_contentHash != "")
+    {
+        contentHash = m_contentHash;
+        return true;
+    }
+
+    // data in memory are hashed directly and all others are read chunk by chunk, with the
+    // same result for both
+    std::vector<std::string> chunkHashes;
+    std::vector<uint8_t> buffer;
+    for(uint64_t pos = 0; pos < m_size; pos += UPLOAD_SOURCE_HASH_CHUNK_SIZE)
+    {
+        const uint64_t chunkSize = std::min<uint64_t>(UPLOAD_SOURCE_HASH_CHUNK_SIZE, m_size - pos);
+        const uint8_t* chunk = nullptr;
+        if(m_data != nullptr)
+        {
+            chunk = &m_data[pos];
+        }
+        else
+        {
+            buffer.resize(chunkSize);
+            if(read(buffer.data(), pos, chunkSize, error) == false) {
+                return false;
+            }
+            chunk = buffer.data();
+        }
+        chunkHashes.push_back(hashContent(chunk, chunkSize, numberOfHashThreads));
+    }
+
+    m_contentHash = combineContentHashes("file", chunkHashes);
+    contentHash = m_contentHash;
+
+    return true;
+}
+
+} // namespace HanamiAI
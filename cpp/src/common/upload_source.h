@@ -0,0 +1,104 @@
+/**
+ * @file        upload_source.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMISDK_UPLOAD_SOURCE_H
+#define KITSUNEMIMI_HANAMISDK_UPLOAD_SOURCE_H
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <stdint.h>
+
+#include <libHanamiAiSdk/data_set.h>
+#include <common/mapped_file.h>
+
+#include <libKitsunemimiCommon/logger.h>
+#include <libKitsunemimiCommon/files/binary_file.h>
+
+namespace HanamiAI
+{
+
+/**
+ * @brief Data of a single file of a data-set, which should be uploaded. The data can come from
+ *        a local file, a buffer in memory or a stream. Files and buffers are send directly
+ *        from memory, while streams are read segment by segment. Because shiori needs the size
+ *        of the data before the upload, streams without a known size and chunk-producers are
+ *        collected in an internal buffer first.
+ */
+class UploadSource
+{
+public:
+    UploadSource();
+    ~UploadSource();
+
+    UploadSource(const UploadSource&) = delete;
+    UploadSource& operator=(const UploadSource&) = delete;
+
+    bool initFile(const std::string &filePath,
+                  Kitsunemimi::ErrorContainer &error);
+    void initMemory(const uint8_t* data,
+                    const uint64_t dataSize);
+    bool initStream(std::istream &stream,
+                    Kitsunemimi::ErrorContainer &error);
+    bool initProducer(const UploadChunkProducer &producer,
+                      Kitsunemimi::ErrorContainer &error);
+
+    const std::string& getName() const;
+    const std::string& getFilePath() const;
+    uint64_t getSize() const;
+    const uint8_t* getData() const;
+
+    void prefetch(const uint64_t position,
+                  const uint64_t size);
+    bool read(uint8_t* buffer,
+              const uint64_t position,
+              const uint64_t size,
+              Kitsunemimi::ErrorContainer &error);
+    bool getContentHash(std::string &contentHash,
+                        const uint32_t numberOfHashThreads,
+                        Kitsunemimi::ErrorContainer &error);
+
+private:
+    std::string m_name = "";
+    std::string m_filePath = "";
+    uint64_t m_size = 0;
+    // cached, so the manifest and the journal of an upload don't hash the data twice
+    std::string m_contentHash = "";
+
+    // data, which are completely in memory
+    const uint8_t* m_data = nullptr;
+    MappedFile m_mappedFile;
+    std::vector<uint8_t> m_buffer;
+
+    // data, which have to be read segment by segment
+    Kitsunemimi::BinaryFile* m_binaryFile = nullptr;
+    std::istream* m_stream = nullptr;
+    uint64_t m_streamStart = 0;
+    uint64_t m_streamPosition = 0;
+
+    bool readStreamIntoBuffer(std::istream &stream,
+                              Kitsunemimi::ErrorContainer &error);
+};
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_UPLOAD_SOURCE_H
@@ -0,0 +1,99 @@
+/**
+ * @file        upload_streams.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#include <common/upload_streams.h>
+
+namespace HanamiAI
+{
+
+/**
+ * @brief get number of websockets for an upload
+ *
+ * @param dataSize total number of bytes to upload
+ * @param requestedStreams number of streams requested by the user or 0 to select the number
+ *                         automatically based on the size of the data
+ *
+ * @return number of streams
+ */
+uint32_t
+getNumberOfUploadStreams(const uint64_t dataSize,
+                         const uint32_t requestedStreams)
+{
+    uint64_t numberOfStreams = requestedStreams;
+    if(numberOfStreams == 0) {
+        numberOfStreams = dataSize / BYTES_PER_UPLOAD_STREAM;
+    }
+
+    if(numberOfStreams < 1) {
+        numberOfStreams = 1;
+    }
+    if(numberOfStreams > MAX_UPLOAD_STREAMS) {
+        numberOfStreams = MAX_UPLOAD_STREAMS;
+    }
+
+    return static_cast<uint32_t>(numberOfStreams);
+}
+
+/**
+ * @brief distribute the websockets of an upload over the files, which are send at the same
+ *        time. Each file gets one websocket and the remaining websockets are distributed by
+ *        the size of the files.
+ *
+ * @param files files of the upload
+ * @param numberOfStreams total number of websockets, which must be at least the number of files
+ *
+ * @return number of websockets for each file
+ */
+std::vector<uint32_t>
+distributeUploadStreams(const std::vector<JournalFile> &files,
+                        const uint32_t numberOfStreams)
+{
+    std::vector<uint32_t> streamsPerFile(files.size(), 1);
+    const uint32_t additionalStreams = numberOfStreams - static_cast<uint32_t>(files.size());
+
+    uint64_t totalSize = 0;
+    uint64_t biggestFile = 0;
+    for(uint64_t i = 0; i < files.size(); i++)
+    {
+        totalSize += files[i].fileSize;
+        if(files[i].fileSize > files[biggestFile].fileSize) {
+            biggestFile = i;
+        }
+    }
+
+    uint32_t distributedStreams = 0;
+    for(uint64_t i = 0; i < files.size() && totalSize > 0; i++)
+    {
+        const uint32_t streams = static_cast<uint32_t>((additionalStreams * files[i].fileSize)
+                                                        / totalSize);
+        streamsPerFile[i] += streams;
+        distributedStreams += streams;
+    }
+
+    // the remaining websockets of the rounding go to the biggest file
+    streamsPerFile[biggestFile] += additionalStreams - distributedStreams;
+
+    return streamsPerFile;
+}
+
+} // namespace HanamiAI
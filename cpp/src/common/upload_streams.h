@@ -0,0 +1,51 @@
+/**
+ * @file        upload_streams.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#ifndef KITSUNEMIMI_HANAMISDK_UPLOAD_STREAMS_H
+#define KITSUNEMIMI_HANAMISDK_UPLOAD_STREAMS_H
+
+#include <vector>
+#include <stdint.h>
+
+#include <common/upload_journal.h>
+
+// maximum number of websockets, which are used for the upload of a data-set
+#define MAX_UPLOAD_STREAMS 8
+
+// number of bytes of a data-set for each additional websocket, when the number of streams
+// is selected automatically. Small files are not faster with more streams, because the
+// initialization of the websockets would take longer than the transfer.
+#define BYTES_PER_UPLOAD_STREAM (16 * 1024 * 1024)
+
+namespace HanamiAI
+{
+
+uint32_t getNumberOfUploadStreams(const uint64_t dataSize,
+                                  const uint32_t requestedStreams);
+
+std::vector<uint32_t> distributeUploadStreams(const std::vector<JournalFile> &files,
+                                              const uint32_t numberOfStreams);
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_UPLOAD_STREAMS_H
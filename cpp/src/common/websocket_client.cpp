@@ -37,10 +37,32 @@ WebsocketClient::WebsocketClient() {}
  */
 WebsocketClient::~WebsocketClient()
 {
-    m_websocket->close(websocket::close_code::normal);
-    // a 'delete' on the m_websocket-pointer breaks the program,
-    // because of bad programming in the websocket-class of the boost beast library
-    // TODO: fix the memory-leak
+    if(m_websocket == nullptr) {
+        return;
+    }
+
+    // a read of waitForMessage, which still waits for a message, can not be combined with the
+    // close-handshake, so it is canceled and the connection is closed without handshake
+    if(m_readPending)
+    {
+        beast::error_code ec;
+        beast::get_lowest_layer(*m_websocket).cancel(ec);
+        m_ioContext.restart();
+        m_ioContext.run();
+        delete m_websocket;
+        return;
+    }
+
+    try {
+        m_websocket->close(websocket::close_code::normal);
+    }
+    catch(const std::exception &e) {
+        LOG_WARNING("Failed to close websocket: '" + std::string(e.what()) + "'");
+    }
+
+    // the websocket can be deleted here, because the io- and ssl-context, which it references,
+    // are members of the client and still valid at this point
+    delete m_websocket;
 }
 
 /**
@@ -66,17 +88,16 @@ WebsocketClient::initClient(std::string &socketUuid,
     try
     {
         // init ssl
-        ssl::context ctx{ssl::context::tlsv13_client};
-        /*if(loadCertificates(ctx) == false)
+        /*if(loadCertificates(m_sslContext) == false)
         {
             error.addMeesage("Failed to load certificates for creating Websocket-Client");
             LOG_ERROR(error);
             return false;
         }*/
 
-        net::io_context ioc;
-        tcp::resolver resolver{ioc};
-        m_websocket = new websocket::stream<beast::ssl_stream<tcp::socket>>{ioc, ctx};
+        tcp::resolver resolver{m_ioContext};
+        m_websocket = new websocket::stream<beast::ssl_stream<tcp::socket>>{m_ioContext,
+                                                                           m_sslContext};
 
         // Look up the domain name
         const auto results = resolver.resolve(host, port);
@@ -175,6 +196,45 @@ WebsocketClient::sendMessage(const void* data,
     return true;
 }
 
+/**
+ * @brief send a message, which consists of two separate parts, as one websocket-frame without
+ *        copying the parts into a common buffer before
+ *
+ * @param header pointer to the first part of the message
+ * @param headerSize number of bytes of the first part
+ * @param payload pointer to the second part of the message
+ * @param payloadSize number of bytes of the second part
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+WebsocketClient::sendMessage(const void* header,
+                             const uint64_t headerSize,
+                             const void* payload,
+                             const uint64_t payloadSize,
+                             Kitsunemimi::ErrorContainer &error)
+{
+    try
+    {
+        const std::array<net::const_buffer, 2> buffers = {net::buffer(header, headerSize),
+                                                          net::buffer(payload, payloadSize)};
+
+        // Send the message
+        m_websocket->binary(true);
+        m_websocket->write(buffers);
+    }
+    catch(const std::exception &e)
+    {
+        const std::string msg(e.what());
+        error.addMeesage("Error-Message while send Websocket-Data: '" + msg + "'");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return true;
+}
+
 /**
  * @brief WebsocketClient::readMessage
  *
@@ -215,6 +275,116 @@ WebsocketClient::readMessage(uint64_t &numberOfByes,
     return nullptr;
 }
 
+/**
+ * @brief read message into the receive-buffer of the session without copying it
+ *
+ * @param numberOfByes reference for output of number of read bytes
+ * @param error reference for error-output
+ *
+ * @return nullptr if failed, else pointer to the message inside of the receive-buffer, which is
+ *         only valid until the next read
+ */
+const uint8_t*
+WebsocketClient::readMessageIntoBuffer(uint64_t &numberOfByes,
+                                       Kitsunemimi::ErrorContainer &error)
+{
+    try
+    {
+        // drop the old message, but keep the allocated memory for the next one
+        m_recvBuffer.consume(m_recvBuffer.size());
+        m_websocket->read(m_recvBuffer);
+
+        numberOfByes = m_recvBuffer.data().size();
+        if(numberOfByes == 0) {
+            return nullptr;
+        }
+
+        return static_cast<const uint8_t*>(m_recvBuffer.data().data());
+    }
+    catch(const std::exception &e)
+    {
+        numberOfByes = 0;
+        const std::string msg(e.what());
+        error.addMeesage("Error-Message while read Websocket-Data: '" + msg + "'");
+        LOG_ERROR(error);
+        return nullptr;
+    }
+
+    numberOfByes = 0;
+    return nullptr;
+}
+
+/**
+ * @brief wait for the next message for a limited time. In contrast to the other read-functions,
+ *        the read continues in the background after a timeout, so the next call of this
+ *        function continues to wait for the same message and no message is lost. As long as
+ *        a read is pending, no other read-function must be used.
+ *
+ * @param numberOfByes reference for output of number of read bytes
+ * @param timeout reference, which is set to true, if no message arrived within the time
+ * @param timeoutMs maximum time in milliseconds to wait for the message
+ * @param error reference for error-output
+ *
+ * @return nullptr if failed or timed out, else pointer to the message inside of the
+ *         receive-buffer, which is only valid until the next read
+ */
+const uint8_t*
+WebsocketClient::waitForMessage(uint64_t &numberOfByes,
+                                bool &timeout,
+                                const uint64_t timeoutMs,
+                                Kitsunemimi::ErrorContainer &error)
+{
+    numberOfByes = 0;
+    timeout = false;
+
+    try
+    {
+        if(m_readPending == false)
+        {
+            m_recvBuffer.consume(m_recvBuffer.size());
+            m_readPending = true;
+            m_readFinished = false;
+            m_websocket->async_read(m_recvBuffer,
+                                    [this](const beast::error_code &ec, std::size_t)
+            {
+                m_readError = ec;
+                m_readFinished = true;
+            });
+        }
+
+        // the context returns early, when the read is finished and it has no work anymore
+        m_ioContext.restart();
+        m_ioContext.run_for(std::chrono::milliseconds(timeoutMs));
+        if(m_readFinished == false)
+        {
+            timeout = true;
+            return nullptr;
+        }
+
+        m_readPending = false;
+        if(m_readError) {
+            throw beast::system_error(m_readError);
+        }
+
+        numberOfByes = m_recvBuffer.data().size();
+        if(numberOfByes == 0) {
+            return nullptr;
+        }
+
+        return static_cast<const uint8_t*>(m_recvBuffer.data().data());
+    }
+    catch(const std::exception &e)
+    {
+        numberOfByes = 0;
+        const std::string msg(e.what());
+        error.addMeesage("Error-Message while read Websocket-Data: '" + msg + "'");
+        LOG_ERROR(error);
+        return nullptr;
+    }
+
+    return nullptr;
+}
+
 /**
  * @brief load ssl-certificates for ssl-encryption of websocket  (not used at the moment)
  *
@@ -0,0 +1,352 @@
+/**
+ * @file        concurrency_limiter.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libHanamiAiSdk/concurrency_limiter.h>
+#include <libHanamiAiSdk/direct_session.h>
+#include <libHanamiAiSdk/prepared_request.h>
+
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+
+// latency, which is still seen as unloaded, relative to the minimal latency
+#define LATENCY_TOLERANCE 2.0
+
+// factor to reduce the limit of the AIMD-algorithm on overload
+#define AIMD_BACKOFF_FACTOR 0.9
+
+// weight of a new limit within the smoothed limit of the gradient-algorithm
+#define GRADIENT_SMOOTHING 0.2
+
+// factor, by which the minimal latency grows with each sample, to follow a host, which became
+// permanently slower. This is small enough, that the limit is reduced first under overload,
+// which brings the latency back to the minimum.
+#define MIN_LATENCY_DECAY 1.0001
+
+namespace HanamiAI
+{
+
+/**
+ * @brief session of the pool of the limiter
+ */
+struct LimitedSession
+{
+    DirectSession* session = nullptr;
+    PreparedRequest prepared {REQUEST_INPUT_PREPARED, "input"};
+};
+
+/**
+ * @brief constructor
+ *
+ * @param sessions direct-io-sessions to the same host, which limit the maximum concurrency.
+ *                 Each session is only used by the limiter afterwards and is not owned by it.
+ * @param algorithm algorithm to adjust the limit
+ * @param initialLimit limit at the beginning
+ * @param maxQueueSize maximum number of requests, which wait for a free slot
+ * @param maxQueueTimeMs maximum time in milliseconds, which a request waits for a free slot
+ */
+ConcurrencyLimiter::ConcurrencyLimiter(const std::vector<DirectSession*> &sessions,
+                                       const LimitAlgorithm algorithm,
+                                       const uint64_t initialLimit,
+                                       const uint64_t maxQueueSize,
+                                       const uint64_t maxQueueTimeMs)
+{
+    m_algorithm = algorithm;
+    m_maxQueueSize = maxQueueSize;
+    m_maxQueueTimeMs = maxQueueTimeMs;
+
+    for(DirectSession* session : sessions)
+    {
+        LimitedSession* limitedSession = new LimitedSession();
+        limitedSession->session = session;
+        m_sessions.push_back(limitedSession);
+
+        // already broken sessions are never used
+        if(session->isBroken())
+        {
+            m_stats.numberOfBrokenSessions++;
+            continue;
+        }
+        m_freeSessions.push_back(limitedSession);
+        m_numberOfHealthySessions++;
+    }
+
+    const double maxLimit = std::max(static_cast<double>(m_numberOfHealthySessions), 1.0);
+    m_limit = std::min(std::max(static_cast<double>(initialLimit), 1.0), maxLimit);
+}
+
+/**
+ * @brief destructor
+ */
+ConcurrencyLimiter::~ConcurrencyLimiter()
+{
+    for(LimitedSession* session : m_sessions) {
+        delete session;
+    }
+}
+
+/**
+ * @brief get the current limit for the number of running requests
+ */
+uint64_t
+ConcurrencyLimiter::getLimit()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return static_cast<uint64_t>(m_limit);
+}
+
+/**
+ * @brief get current statistics of the limiter
+ */
+LimiterStatistics
+ConcurrencyLimiter::getStatistics()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    LimiterStatistics stats = m_stats;
+    stats.limit = static_cast<uint64_t>(m_limit);
+    stats.minLatencyUs = m_minLatencyUs;
+    stats.lastLatencyUs = m_lastLatencyUs;
+
+    return stats;
+}
+
+/**
+ * @brief adjust the limit with the latency of a finished request. Must be called while holding
+ *        the lock of the limiter.
+ *
+ * @param success true, if the request was successful
+ * @param latencyUs latency of the request in microseconds
+ */
+void
+ConcurrencyLimiter::updateLimit(const bool success,
+                                const double latencyUs)
+{
+    const double maxLimit = std::max(static_cast<double>(m_numberOfHealthySessions), 1.0);
+
+    if(success)
+    {
+        m_lastLatencyUs = latencyUs;
+        if(m_minLatencyUs == 0.0) {
+            m_minLatencyUs = latencyUs;
+        } else {
+            m_minLatencyUs = std::min(latencyUs, m_minLatencyUs * MIN_LATENCY_DECAY);
+        }
+    }
+
+    if(m_algorithm == AIMD_LIMIT)
+    {
+        if(success && latencyUs <= m_minLatencyUs * LATENCY_TOLERANCE) {
+            m_limit += 1.0 / m_limit;
+        } else {
+            m_limit *= AIMD_BACKOFF_FACTOR;
+        }
+    }
+    else
+    {
+        // failed requests count as requests with the maximum tolerated latency
+        const double gradient = success ? std::min(std::max(LATENCY_TOLERANCE * m_minLatencyUs
+                                                            / latencyUs, 0.5), 1.0)
+                                        : 0.5;
+        // the square-root of the limit is the number of requests, which are allowed to wait
+        // on the host, so the limit can still grow, while the latency is at its minimum
+        const double newLimit = m_limit * gradient + std::sqrt(m_limit);
+        m_limit = (1.0 - GRADIENT_SMOOTHING) * m_limit + GRADIENT_SMOOTHING * newLimit;
+    }
+
+    m_limit = std::min(std::max(m_limit, 1.0), maxLimit);
+}
+
+/**
+ * @brief remove a broken session from the pool, which reduces the maximum limit. Must be called
+ *        while holding the lock of the limiter.
+ */
+void
+ConcurrencyLimiter::removeBrokenSession()
+{
+    m_numberOfHealthySessions--;
+    m_stats.numberOfBrokenSessions++;
+
+    const double maxLimit = std::max(static_cast<double>(m_numberOfHealthySessions), 1.0);
+    m_limit = std::min(m_limit, maxLimit);
+
+    LOG_WARNING("Removed broken session from concurrency-limiter");
+}
+
+/**
+ * @brief wait until the number of running requests is below the limit and take a free session
+ *
+ * @param error reference for error-output
+ *
+ * @return nullptr, if rejected or all sessions are broken, else session for the request
+ */
+LimitedSession*
+ConcurrencyLimiter::acquire(Kitsunemimi::ErrorContainer &error)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    // waiting requests are also woken up, when the last session breaks, so they fail fast
+    const auto hasFreeSlot = [this] {
+        return m_numberOfHealthySessions == 0
+               || (m_stats.numberOfRunningRequests < static_cast<uint64_t>(m_limit)
+                   && m_freeSessions.size() > 0);
+    };
+
+    if(m_numberOfHealthySessions == 0)
+    {
+        error.addMeesage("All sessions of the concurrency-limiter are broken");
+        return nullptr;
+    }
+
+    if(hasFreeSlot() == false)
+    {
+        if(m_stats.numberOfQueuedRequests >= m_maxQueueSize)
+        {
+            m_stats.numberOfRejectedRequests++;
+            error.addMeesage("Request rejected, because the queue of the limiter is full");
+            return nullptr;
+        }
+
+        m_stats.numberOfQueuedRequests++;
+        const bool gotSlot = m_cv.wait_for(lock,
+                                           std::chrono::milliseconds(m_maxQueueTimeMs),
+                                           hasFreeSlot);
+        m_stats.numberOfQueuedRequests--;
+
+        if(gotSlot == false)
+        {
+            m_stats.numberOfRejectedRequests++;
+            error.addMeesage("Request rejected, because it waited too long for the limiter");
+            return nullptr;
+        }
+
+        if(m_numberOfHealthySessions == 0)
+        {
+            error.addMeesage("All sessions of the concurrency-limiter are broken");
+            return nullptr;
+        }
+    }
+
+    LimitedSession* session = m_freeSessions.back();
+    m_freeSessions.pop_back();
+    m_stats.numberOfRunningRequests++;
+
+    return session;
+}
+
+/**
+ * @brief give a session back to the pool and adjust the limit
+ *
+ * @param session session to give back
+ * @param success true, if the request was successful
+ * @param broken true, if the session is broken, so it is removed from the pool
+ * @param latencyUs latency of the request in microseconds
+ */
+void
+ConcurrencyLimiter::release(LimitedSession* session,
+                            const bool success,
+                            const bool broken,
+                            const double latencyUs)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+
+        m_stats.numberOfRunningRequests--;
+        m_stats.numberOfRequests++;
+        if(success == false) {
+            m_stats.numberOfErrors++;
+        }
+
+        // the failure of a broken session says nothing about the load of the host, so it is
+        // not used to adjust the limit
+        if(broken)
+        {
+            removeBrokenSession();
+        }
+        else
+        {
+            m_freeSessions.push_back(session);
+            updateLimit(success, latencyUs);
+        }
+    }
+
+    // the limit could be increased, so more than one waiting request can get a slot
+    m_cv.notify_all();
+}
+
+/**
+ * @brief request a single input, if the limit allows it
+ *
+ * @param inputValues pointer to the input-values
+ * @param numberOfInputValues number of input-values
+ * @param outputValues pointer to the buffer for the output-values
+ * @param numberOfOutputValues expected number of output-values
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false, if rejected by the limiter or failed
+ */
+bool
+ConcurrencyLimiter::request(const float* inputValues,
+                            const uint64_t numberOfInputValues,
+                            float* outputValues,
+                            const uint64_t numberOfOutputValues,
+                            Kitsunemimi::ErrorContainer &error)
+{
+    if(m_sessions.size() == 0)
+    {
+        error.addMeesage("Concurrency-limiter has no sessions");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    LimitedSession* session = acquire(error);
+    if(session == nullptr)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const bool success = session->session->request(session->prepared,
+                                                   inputValues,
+                                                   numberOfInputValues,
+                                                   outputValues,
+                                                   numberOfOutputValues,
+                                                   error);
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    release(session,
+            success,
+            session->session->isBroken(),
+            std::chrono::duration<double, std::micro>(end - start).count());
+
+    if(success == false)
+    {
+        error.addMeesage("Request over concurrency-limiter failed");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace HanamiAI
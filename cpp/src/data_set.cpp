@@ -23,30 +23,47 @@
 #include <libHanamiAiSdk/data_set.h>
 #include <libHanamiAiSdk/common/websocket_client.h>
 #include <common/http_client.h>
+#include <common/upload_ring.h>
+#include <common/segment_size_tuner.h>
+#include <common/upload_journal.h>
+#include <common/content_hash.h>
+#include <common/segment_compression.h>
+#include <common/upload_source.h>
+#include <common/upload_streams.h>
 
 #include <libKitsunemimiCrypto/common.h>
 #include <libKitsunemimiJson/json_item.h>
 #include <libKitsunemimiCommon/items/data_items.h>
-#include <libKitsunemimiCommon/files/binary_file.h>
 
 #include <../../libKitsunemimiHanamiMessages/protobuffers/shiori_messages.proto3.pb.h>
+#include <google/protobuf/wire_format_lite.h>
+#include <google/protobuf/io/coded_stream.h>
 
-namespace HanamiAI
-{
+#include <thread>
+#include <deque>
+#include <chrono>
 
-/**
- * @brief get size of a local file
- *
- * @param filePath path the file to check
- *
- * @return size of file if successful, or -1 if failed
- */
-long
-getFileSize(const std::string &filePath)
+// number of segments, which are read in advance, while the previous segments are still send
+#define UPLOAD_PREFETCH_SEGMENTS 2
+
+// distance in bytes, how far the kernel should read ahead of the current segment of a
+// mapped file
+#define UPLOAD_READAHEAD_SIZE (4 * 1024 * 1024)
+
+// number of bytes, which have to be written over a websocket after a segment, before the
+// segment is marked as send in the journal of the upload
+#define JOURNAL_UNCONFIRMED_BYTES (8 * 1024 * 1024)
+
+// upper limit for the number of threads, which compress the segments of an upload
+#define MAX_COMPRESSION_THREADS 16
+
+// interval in milliseconds between the requests of the progress of an upload, which starts
+// small and is doubled after each request, until the upper limit is reached
+#define MIN_PROGRESS_POLL_INTERVAL 5
+#define MAX_PROGRESS_POLL_INTERVAL 1000
+
+namespace HanamiAI
 {
-    std::ifstream in(filePath, std::ifstream::ate | std::ifstream::binary);
-    return in.tellg();
-}
 
 /**
  * @brief initialize a new csv-dataset in shiori
@@ -179,103 +196,628 @@ finalizeMnistDataSet(std::string &result,
 }
 
 /**
- * @brief send data to shiori
+ * @brief check the options of an upload
+ *
+ * @param options options to check
+ * @param error reference for error-output
+ *
+ * @return true, if valid, else false
+ */
+bool
+checkUploadOptions(const UploadOptions &options,
+                   Kitsunemimi::ErrorContainer &error)
+{
+    if(options.segmentSize == 0)
+    {
+        error.addMeesage("Segment-size of the upload must be bigger than 0");
+        return false;
+    }
+
+    if(options.compression != NO_COMPRESSION
+            && options.compression != LZ4_COMPRESSION
+            && options.compression != ZSTD_COMPRESSION)
+    {
+        error.addMeesage("Unknown compression of the upload: "
+                         + std::to_string(options.compression));
+        return false;
+    }
+
+    // shiori would silently store the compressed bytes, if it doesn't support the compression
+    if(options.compression != NO_COMPRESSION
+            && options.serverSupportsCompression == false)
+    {
+        error.addMeesage("Compression of the upload is not supported by the current version of "
+                         "shiori and must be explicitly allowed by 'serverSupportsCompression'");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief get number of threads to compress the segments of an upload
+ *
+ * @param options options of the upload
+ *
+ * @return 0, if the upload is not compressed, else number of threads
+ */
+uint32_t
+getNumberOfCompressionThreads(const UploadOptions &options)
+{
+    if(options.compression == NO_COMPRESSION) {
+        return 0;
+    }
+
+    uint32_t numberOfThreads = options.numberOfCompressionThreads;
+    if(numberOfThreads == 0) {
+        numberOfThreads = std::thread::hardware_concurrency();
+    }
+
+    if(numberOfThreads < 1) {
+        numberOfThreads = 1;
+    }
+    if(numberOfThreads > MAX_COMPRESSION_THREADS) {
+        numberOfThreads = MAX_COMPRESSION_THREADS;
+    }
+
+    return numberOfThreads;
+}
+
+/**
+ * @brief open multiple websockets to shiori
+ *
+ * @param clients reference for the new websocket-clients, which have to be deleted by
+ *                deleteShioriClients
+ * @param numberOfClients number of websockets to open
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+initShioriClients(std::vector<WebsocketClient*> &clients,
+                  const uint32_t numberOfClients,
+                  Kitsunemimi::ErrorContainer &error)
+{
+    HanamiRequest* request = HanamiRequest::getInstance();
+
+    for(uint32_t i = 0; i < numberOfClients; i++)
+    {
+        WebsocketClient* client = new WebsocketClient();
+        clients.push_back(client);
+
+        std::string websocketUuid = "";
+        const bool ret = client->initClient(websocketUuid,
+                                            request->getToken(),
+                                            "shiori",
+                                            request->getHost(),
+                                            request->getPort(),
+                                            error);
+        if(ret == false)
+        {
+            error.addMeesage("Failed to init websocket to shiori");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief close and delete all websockets, which were opened by initShioriClients
+ *
+ * @param clients websocket-clients to delete
+ */
+void
+deleteShioriClients(std::vector<WebsocketClient*> &clients)
+{
+    for(WebsocketClient* client : clients) {
+        delete client;
+    }
+    clients.clear();
+}
+
+/**
+ * @brief read all segments of a file into the ring, while the previous segments are still
+ *        send by the websockets. If the data of the file are in memory, like a mapped file or
+ *        a buffer, the segments only point into the memory and the reader only tells the
+ *        kernel, which parts are needed next.
+ *
+ * @param source source of the data of the file
+ * @param ranges ranges of the file, which should be send
+ * @param ring ring with the buffers for the segments
+ * @param options options of the upload
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+readFileSegments(UploadSource &source,
+                 const std::vector<ByteRange> &ranges,
+                 UploadRing &ring,
+                 const UploadOptions &options,
+                 Kitsunemimi::ErrorContainer &error)
+{
+    SegmentSizeTuner tuner(options.segmentSize,
+                           options.maxSegmentSize,
+                           options.adaptiveSegmentSize);
+
+    const uint8_t* sourceData = source.getData();
+    const uint64_t dataSize = source.getSize();
+
+    for(const ByteRange &range : ranges)
+    {
+        // an empty range is still send as one empty segment, which is necessary for empty files
+        uint64_t pos = range.start;
+        do
+        {
+            UploadSegment* segment = ring.getFree();
+            if(segment == nullptr) {
+                return true;
+            }
+
+            // check the size for the last segment of the range
+            tuner.update(ring.getSentBytes());
+            uint64_t segmentSize = tuner.getSegmentSize();
+            if(range.end - pos < segmentSize) {
+                segmentSize = range.end - pos;
+            }
+
+            if(sourceData != nullptr)
+            {
+                segment->payload = &sourceData[pos];
+                source.prefetch(pos + UPLOAD_READAHEAD_SIZE, segmentSize);
+            }
+            else if(segmentSize > 0)
+            {
+                // read segment of a file, which could not be mapped, or of a stream
+                if(source.read(&segment->data[0], pos, segmentSize, error) == false)
+                {
+                    error.addMeesage("Failed to read " + source.getName());
+                    ring.abort();
+                    return false;
+                }
+                segment->payload = &segment->data[0];
+            }
+
+            segment->payloadSize = segmentSize;
+            segment->compression = NO_COMPRESSION;
+            segment->position = pos;
+            segment->size = segmentSize;
+            segment->isLast = pos + segmentSize >= dataSize;
+            ring.pushRead(segment);
+
+            pos += segmentSize;
+        }
+        while(pos < range.end);
+    }
+
+    ring.finishReader();
+
+    return true;
+}
+
+/**
+ * @brief compress the segments, which were read from the file, before they are send. Multiple
+ *        of these functions run at the same time, so the compression doesn't limit the upload
+ *        and runs while the senders still send the previous segments.
+ *
+ * @param ring ring with the segments, which were read from the file
+ * @param compression compression-algorithm
+ */
+void
+compressFileSegments(UploadRing &ring,
+                     const UploadCompression compression)
+{
+    UploadSegment* segment = ring.getRead();
+    while(segment != nullptr)
+    {
+        // segments, which don't become smaller, are send uncompressed
+        const uint64_t compressedSize = compressSegment(segment->compressed,
+                                                        segment->payload,
+                                                        segment->size,
+                                                        compression);
+        if(compressedSize > 0)
+        {
+            segment->payload = &segment->compressed[0];
+            segment->payloadSize = compressedSize;
+            segment->compression = compression;
+        }
+
+        ring.pushFilled(segment);
+        segment = ring.getRead();
+    }
+
+    ring.finishWorker();
+}
+
+/**
+ * @brief send segments of a file over a single websocket. Multiple of these functions run at
+ *        the same time over different websockets and take the next segment from the ring, so
+ *        each websocket sends as many segments as it can handle. The segments arrive out of
+ *        order at shiori, which places them by their position within the file.
+ *
+ * Only the small fields of the message are serialized by protobuf. The data-field is appended
+ * by hand and the payload is send directly from the segment, so the data is not copied into
+ * the message and again into a send-buffer. Compressed segments get two additional fields with
+ * the compression and the uncompressed size, so the receiver can decompress them.
+ *
+ * @param client websocket over which the segments should be send
+ * @param datasetUuid uuid of the dataset where the file belongs to
+ * @param fileUuid uuid of the file for identification in shiori
+ * @param ring ring with the segments, which were read from the file
+ * @param journal journal to store the send ranges or nullptr, if the upload has no journal
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+sendFileSegments(WebsocketClient* client,
+                 const std::string &datasetUuid,
+                 const std::string &fileUuid,
+                 UploadRing &ring,
+                 UploadJournal* journal,
+                 Kitsunemimi::ErrorContainer &error)
+{
+    // a successful write only means, that the data is in the send-buffer of the socket, so the
+    // last segments of the websocket are not marked as send in the journal, until enough data
+    // was written after them, or all segments were written successfully
+    std::deque<ByteRange> unconfirmed;
+    uint64_t unconfirmedBytes = 0;
+
+    using google::protobuf::internal::WireFormatLite;
+    using google::protobuf::io::CodedOutputStream;
+
+    const uint32_t dataTag = WireFormatLite::MakeTag(FileUpload_Message::kDataFieldNumber,
+                                                     WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+    const uint32_t compressionTag = WireFormatLite::MakeTag(UPLOAD_COMPRESSION_FIELD_NUMBER,
+                                                            WireFormatLite::WIRETYPE_VARINT);
+    const uint32_t rawSizeTag = WireFormatLite::MakeTag(UPLOAD_RAW_SIZE_FIELD_NUMBER,
+                                                        WireFormatLite::WIRETYPE_VARINT);
+    std::vector<uint8_t> headerBuffer;
+
+    FileUpload_Message message;
+    message.set_fileuuid(fileUuid);
+    message.set_datasetuuid(datasetUuid);
+    message.set_type(UploadDataType::DATASET_TYPE);
+
+    UploadSegment* segment = ring.getFilled();
+    while(segment != nullptr)
+    {
+        message.set_islast(segment->isLast);
+        message.set_position(segment->position);
+
+        // serialize all fields except of the data, followed by the tag and length of the data
+        const uint64_t fieldsSize = message.ByteSizeLong();
+        headerBuffer.resize(fieldsSize + 48);
+        if(message.SerializeToArray(&headerBuffer[0], fieldsSize) == false)
+        {
+            error.addMeesage("Failed to serialize learn-message");
+            ring.abort();
+            return false;
+        }
+        uint8_t* end = &headerBuffer[fieldsSize];
+        if(segment->compression != NO_COMPRESSION)
+        {
+            end = CodedOutputStream::WriteVarint32ToArray(compressionTag, end);
+            end = CodedOutputStream::WriteVarint32ToArray(segment->compression, end);
+            end = CodedOutputStream::WriteVarint32ToArray(rawSizeTag, end);
+            end = CodedOutputStream::WriteVarint64ToArray(segment->size, end);
+        }
+        end = CodedOutputStream::WriteVarint32ToArray(dataTag, end);
+        end = CodedOutputStream::WriteVarint64ToArray(segment->payloadSize, end);
+        const uint64_t headerSize = static_cast<uint64_t>(end - &headerBuffer[0]);
+
+        // send segment
+        if(client->sendMessage(&headerBuffer[0],
+                               headerSize,
+                               segment->payload,
+                               segment->payloadSize,
+                               error) == false)
+        {
+            error.addMeesage("Failed to send segment at position "
+                             + std::to_string(segment->position));
+            ring.abort();
+            return false;
+        }
+
+        if(journal != nullptr)
+        {
+            ByteRange range;
+            range.start = segment->position;
+            range.end = segment->position + segment->size;
+            unconfirmed.push_back(range);
+            unconfirmedBytes += segment->size;
+
+            while(unconfirmedBytes - (unconfirmed.front().end - unconfirmed.front().start)
+                  >= JOURNAL_UNCONFIRMED_BYTES)
+            {
+                const ByteRange confirmed = unconfirmed.front();
+                unconfirmed.pop_front();
+                unconfirmedBytes -= confirmed.end - confirmed.start;
+                journal->addSentRange(fileUuid, confirmed.start, confirmed.end);
+            }
+        }
+
+        ring.release(segment);
+        segment = ring.getFilled();
+    }
+
+    // the ring was aborted by another websocket, so the own segments are not confirmed
+    if(ring.isAborted()) {
+        return true;
+    }
+
+    for(const ByteRange &range : unconfirmed)
+    {
+        if(journal != nullptr) {
+            journal->addSentRange(fileUuid, range.start, range.end);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief send data to shiori. If the data are in memory, like a mapped file or a buffer, the
+ *        segments are send directly from there, while a separate thread tells the kernel to
+ *        read the following segments of a mapped file in advance. If the data have to be read,
+ *        like a file, which could not be mapped, or a stream, this thread reads them into a
+ *        small ring of buffers instead, so reading and sending still overlap.
+ *        The segments of the file are distributed over all given
+ *        websockets, which send at the same time, so the upload is not limited by the window
+ *        of a single tcp-connection. If the upload is compressed, a pool of threads compresses
+ *        the segments between reading and sending.
  *
- * @param session session over which the data should be send
+ * @param clients websockets over which the data should be send
  * @param datasetUuid uuid of the dataset where the file belongs to
  * @param fileUuid uuid of the file for identification in shiori
- * @param filePath path to file, which should be send
+ * @param source source of the data, which should be send
+ * @param options options of the upload
+ * @param journal journal of the upload or nullptr, if the upload has no journal. If a journal
+ *                is given, only the ranges, which are missing in the journal, are send.
  * @param error reference for error-output
  *
  * @return true, if successful, else false
  */
 bool
-sendFile(WebsocketClient* client,
+sendFile(const std::vector<WebsocketClient*> &clients,
          const std::string &datasetUuid,
          const std::string &fileUuid,
-         const std::string &filePath,
+         UploadSource &source,
+         const UploadOptions &options,
+         UploadJournal* journal,
          Kitsunemimi::ErrorContainer &error)
 {
-    // get data, which should be send
-    const uint64_t dataSize = getFileSize(filePath);
-    Kitsunemimi::BinaryFile sourceFile(filePath);
+    const uint64_t dataSize = source.getSize();
 
-    bool success = true;
-    uint64_t pos = 0;
+    std::vector<ByteRange> ranges;
+    if(journal != nullptr)
+    {
+        ranges = journal->getMissingRanges(fileUuid);
+        if(ranges.size() == 0 && dataSize > 0) {
+            return true;
+        }
+    }
+    if(ranges.size() == 0)
+    {
+        ByteRange fullRange;
+        fullRange.end = dataSize;
+        ranges.push_back(fullRange);
+    }
+
+    // the buffers must be big enough for the biggest segment, which can be selected, but are
+    // only necessary, if the data are not in memory
+    uint64_t bufferSize = 0;
+    if(dataSize > 0 && source.getData() == nullptr)
+    {
+        bufferSize = options.segmentSize;
+        if(options.adaptiveSegmentSize) {
+            bufferSize = std::max(options.segmentSize, options.maxSegmentSize);
+        }
+    }
+
+    // each websocket and each compression-thread holds one segment and the reader can fill
+    // UPLOAD_PREFETCH_SEGMENTS segments in advance
+    const uint32_t numberOfCompressors = getNumberOfCompressionThreads(options);
+    UploadRing ring(clients.size() + numberOfCompressors + UPLOAD_PREFETCH_SEGMENTS,
+                    bufferSize,
+                    numberOfCompressors);
+
+    Kitsunemimi::ErrorContainer readError;
+    bool readSuccess = false;
+    std::thread reader([&] {
+        readSuccess = readFileSegments(source,
+                                       ranges,
+                                       ring,
+                                       options,
+                                       readError);
+    });
+
+    std::vector<std::thread> compressors;
+    for(uint32_t i = 0; i < numberOfCompressors; i++)
+    {
+        compressors.emplace_back([&] {
+            compressFileSegments(ring, options.compression);
+        });
+    }
 
-    // prepare buffer
-    uint64_t segmentSize = 96 * 1024;
+    // the first websocket is served by the current thread
+    std::vector<std::thread> senders;
+    std::vector<Kitsunemimi::ErrorContainer> errors(clients.size());
+    std::vector<uint8_t> results(clients.size(), 0);
 
-    uint8_t readBuffer[96*1024];
-    uint8_t sendBuffer[128*1024];
+    for(uint64_t i = 1; i < clients.size(); i++)
+    {
+        senders.emplace_back([&, i] {
+            results[i] = sendFileSegments(clients.at(i),
+                                          datasetUuid,
+                                          fileUuid,
+                                          ring,
+                                          journal,
+                                          errors[i]);
+        });
+    }
+    results[0] = sendFileSegments(clients.at(0),
+                                  datasetUuid,
+                                  fileUuid,
+                                  ring,
+                                  journal,
+                                  errors[0]);
+
+    for(std::thread &sender : senders) {
+        sender.join();
+    }
+    for(std::thread &compressor : compressors) {
+        compressor.join();
+    }
+    reader.join();
 
-    do
+    // store the progress, so the upload can be resumed, if it failed
+    if(journal != nullptr)
     {
-        // check the size for the last segment
-        segmentSize = 96 * 1024;
-        if(dataSize - pos < segmentSize) {
-            segmentSize = dataSize - pos;
+        Kitsunemimi::ErrorContainer journalError;
+        if(journal->save(journalError) == false) {
+            LOG_ERROR(journalError);
         }
+    }
 
-        FileUpload_Message message;
-        message.set_fileuuid(fileUuid);
-        message.set_datasetuuid(datasetUuid);
-        message.set_type(UploadDataType::DATASET_TYPE);
-        message.set_islast(false);
-        if(pos + segmentSize >= dataSize) {
-            message.set_islast(true);
-        }
+    bool success = true;
+    if(readSuccess == false)
+    {
+        LOG_ERROR(readError);
+        error.addMeesage("Failed to read " + source.getName());
+        success = false;
+    }
 
-        // read segment of the local file
-        if(sourceFile.readDataFromFile(&readBuffer[0], pos, segmentSize, error) == false)
+    for(uint64_t i = 0; i < clients.size(); i++)
+    {
+        if(results[i] == 0)
         {
+            LOG_ERROR(errors[i]);
+            error.addMeesage("Failed to send "
+                             + source.getName()
+                             + " over stream "
+                             + std::to_string(i));
             success = false;
-            error.addMeesage("Failed to read file '" + filePath + "'");
-            break;
         }
+    }
 
-        message.set_position(pos);
-        message.set_data(readBuffer, segmentSize);
+    return success;
+}
+
+/**
+ * @brief wait for the frame, which shiori sends over the websocket of the upload, when the
+ *        data-set is complete. This frame is a json-object with the uuid of the data-set and
+ *        the flag "complete". All other messages are ignored.
+ *
+ * @param client websocket of the upload
+ * @param uuid uuid of the dataset
+ * @param waitTime maximum time in milliseconds to wait
+ * @param listen reference, which is set to false, if the websocket failed and can not be used
+ *               to wait for the frame anymore
+ *
+ * @return true, if the frame arrived within the time, else false
+ */
+bool
+waitForCompletionFrame(WebsocketClient* client,
+                       const std::string &uuid,
+                       const uint64_t waitTime,
+                       bool &listen)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(waitTime);
 
-        const uint64_t msgSize = message.ByteSizeLong();
-        if(message.SerializeToArray(sendBuffer, msgSize) == false)
+    while(true)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        uint64_t remaining = 0;
+        if(deadline > now)
         {
-            error.addMeesage("Failed to serialize learn-message");
-            return false;
+            remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now)
+                            .count();
         }
 
-        // send segment
-        if(client->sendMessage(sendBuffer, msgSize, error) == false)
+        uint64_t numberOfBytes = 0;
+        bool timeout = false;
+        Kitsunemimi::ErrorContainer readError;
+        const uint8_t* data = client->waitForMessage(numberOfBytes, timeout, remaining, readError);
+        if(timeout) {
+            return false;
+        }
+        if(data == nullptr)
         {
-            LOG_ERROR(error);
-            success = false;
-            break;
+            // shiori or the torii may close the websocket, so the progress is only polled
+            LOG_WARNING("Websocket of upload failed, so the progress is only polled");
+            listen = false;
+            return false;
         }
 
-        pos += segmentSize;
+        const std::string message(reinterpret_cast<const char*>(data), numberOfBytes);
+        Kitsunemimi::JsonItem frame;
+        Kitsunemimi::ErrorContainer parseError;
+        if(frame.parse(message, parseError)
+                && frame.get("uuid").getString() == uuid
+                && frame.get("complete").getBool())
+        {
+            return true;
+        }
     }
-    while(pos < dataSize);
 
-    return success;
+    return false;
 }
 
 /**
- * @brief wait until the upload of all tempfiles are complete
+ * @brief wait until the upload of all tempfiles are complete. The completion is signaled by a
+ *        frame over the websocket of the upload. Additionally the progress is requested in
+ *        intervals, which start at a few milliseconds and double after each request, so short
+ *        uploads are finished without delay, while long ones don't flood shiori with requests.
  *
+ * @param client websocket of the upload or nullptr to only request the progress
  * @param uuid uuid of the dataset
+ * @param timeout maximum time in milliseconds to wait or 0 to wait without limit
  * @param error reference for error-output
  *
  * @return true, if successful, else false
  */
 bool
-waitUntilFullyUploaded(const std::string &uuid,
+waitUntilFullyUploaded(WebsocketClient* client,
+                       const std::string &uuid,
+                       const uint64_t timeout,
                        Kitsunemimi::ErrorContainer &error)
 {
-    // TODO: add timeout-timer
-    bool completeUploaded = false;
-    while(completeUploaded == false)
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t interval = MIN_PROGRESS_POLL_INTERVAL;
+    bool listen = client != nullptr;
+
+    while(true)
     {
-        sleep(1);
+        // limit the wait-time to the remaining time until the timeout
+        uint64_t waitTime = interval;
+        if(timeout > 0)
+        {
+            const uint64_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                         std::chrono::steady_clock::now() - start).count();
+            if(elapsed >= timeout)
+            {
+                error.addMeesage("Timeout while waiting for the completion of data-set '"
+                                 + uuid
+                                 + "' after "
+                                 + std::to_string(elapsed)
+                                 + " ms");
+                return false;
+            }
+            waitTime = std::min(waitTime, timeout - elapsed);
+        }
+
+        if(listen)
+        {
+            if(waitForCompletionFrame(client, uuid, waitTime, listen)) {
+                return true;
+            }
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(waitTime));
+        }
 
         std::string progressStr = "";
         if(getDatasetProgress(progressStr, uuid, error) == false)
@@ -291,176 +833,863 @@ waitUntilFullyUploaded(const std::string &uuid,
             return false;
         }
 
-        completeUploaded = progress.get("complete").getBool();
+        if(progress.get("complete").getBool()) {
+            return true;
+        }
+
+        interval = std::min(interval * 2, static_cast<uint64_t>(MAX_PROGRESS_POLL_INTERVAL));
     }
 
     return true;
 }
 
 /**
- * @brief upload new csv-data-set to shiori
+ * @brief send all files of a data-set to shiori at the same time and wait until shiori has
+ *        completed the data-set. Each file gets its own websockets, so small files, like the
+ *        labels of a MNIST-data-set, don't wait behind bigger ones.
  *
- * @param result reference for response-message
- * @param dataSetName name for the new data-set
- * @param inputFilePath path to file with the inputs
+ * @param datasetUuid uuid of the data-set
+ * @param files files to send with their uuids and sizes
+ * @param sources sources of the data of the files in the same order as the files
+ * @param options options of the upload
+ * @param journal journal of the upload or nullptr, if the upload has no journal
  * @param error reference for error-output
  *
  * @return true, if successful, else false
  */
 bool
-uploadCsvData(std::string &result,
-              const std::string &dataSetName,
-              const std::string &inputFilePath,
-              Kitsunemimi::ErrorContainer &error)
+uploadFiles(const std::string &datasetUuid,
+            const std::vector<JournalFile> &files,
+            const std::vector<UploadSource*> &sources,
+            const UploadOptions &options,
+            UploadJournal* journal,
+            Kitsunemimi::ErrorContainer &error)
 {
-    // init new mnist-data-set
-    if(createCsvDataSet(result,
-                        dataSetName,
-                        getFileSize(inputFilePath),
-                        error) == false)
+    uint64_t totalSize = 0;
+    for(const JournalFile &file : files) {
+        totalSize += file.fileSize;
+    }
+
+    // init websockets to shiori, with at least one websocket for each file
+    uint32_t numberOfStreams = getNumberOfUploadStreams(totalSize, options.numberOfStreams);
+    numberOfStreams = std::max(numberOfStreams, static_cast<uint32_t>(files.size()));
+    std::vector<WebsocketClient*> clients;
+    if(initShioriClients(clients, numberOfStreams, error) == false)
     {
+        deleteShioriClients(clients);
         return false;
     }
 
-    // parse output to get the uuid
-    Kitsunemimi::JsonItem jsonItem;
-    if(jsonItem.parse(result, error) == false)
+    // split the websockets into separate groups for the files
+    const std::vector<uint32_t> streamsPerFile = distributeUploadStreams(files, numberOfStreams);
+    std::vector<std::vector<WebsocketClient*>> fileClients(files.size());
+    uint64_t nextClient = 0;
+    for(uint64_t i = 0; i < files.size(); i++)
     {
-        LOG_ERROR(error);
-        return false;
+        for(uint32_t j = 0; j < streamsPerFile[i]; j++)
+        {
+            fileClients[i].push_back(clients.at(nextClient));
+            nextClient++;
+        }
     }
 
-    // get ids from inital reponse to identify the file-transfer
-    const std::string uuid = jsonItem.get("uuid").getString();
-    const std::string inputUuid = jsonItem.get("uuid_input_file").getString();
-
-    // init websocket to shiori
-    WebsocketClient wsClient;
-    std::string websocketUuid = "";
-    const bool ret = wsClient.initClient(websocketUuid,
-                                         HanamiRequest::getInstance()->getToken(),
-                                         "shiori",
-                                         HanamiRequest::getInstance()->getHost(),
-                                         HanamiRequest::getInstance()->getPort(),
-                                         error);
-    if(ret == false)
-    {
-        error.addMeesage("Failed to init websocket to shiori");
-        LOG_ERROR(error);
-        return false;
+    // send all files at the same time, where the first file is send by the current thread
+    std::vector<std::thread> fileThreads;
+    std::vector<Kitsunemimi::ErrorContainer> errors(files.size());
+    std::vector<uint8_t> results(files.size(), 0);
+
+    for(uint64_t i = 1; i < files.size(); i++)
+    {
+        fileThreads.emplace_back([&, i] {
+            results[i] = sendFile(fileClients[i],
+                                  datasetUuid,
+                                  files[i].fileUuid,
+                                  *sources[i],
+                                  options,
+                                  journal,
+                                  errors[i]);
+        });
+    }
+    results[0] = sendFile(fileClients[0],
+                          datasetUuid,
+                          files[0].fileUuid,
+                          *sources[0],
+                          options,
+                          journal,
+                          errors[0]);
+
+    for(std::thread &fileThread : fileThreads) {
+        fileThread.join();
     }
 
-    // send file
-    if(sendFile(&wsClient, uuid, inputUuid, inputFilePath, error) == false)
+    bool success = true;
+    for(uint64_t i = 0; i < files.size(); i++)
     {
-        LOG_ERROR(error);
-        return false;
+        if(results[i] == 0)
+        {
+            LOG_ERROR(errors[i]);
+            error.addMeesage("Failed to send " + sources[i]->getName());
+            success = false;
+        }
     }
 
-    // wait until all data-transfers to shiori are completed
-    if(waitUntilFullyUploaded(uuid, error) == false)
+    if(success == false)
     {
-        LOG_ERROR(error);
+        deleteShioriClients(clients);
+        if(journal != nullptr) {
+            error.addMeesage("Upload can be resumed with journal '" + journal->getPath() + "'");
+        }
         return false;
     }
 
-    if(finalizeCsvDataSet(result, uuid, inputUuid, error) == false)
+    // wait for the completion, while the websockets are still open, because shiori signals
+    // the completion over them
+    if(waitUntilFullyUploaded(clients.at(0),
+                              datasetUuid,
+                              options.completionTimeout,
+                              error) == false)
     {
-        LOG_ERROR(error);
+        deleteShioriClients(clients);
+        error.addMeesage("Failed to wait for fully uploaded files");
         return false;
     }
 
+    deleteShioriClients(clients);
+
     return true;
 }
 
 /**
- * @brief upload new mnist-data-set to shiori
+ * @brief create the journal of a new upload, if a path for the journal is given
  *
- * @param result reference for response-message
- * @param dataSetName name for the new data-set
- * @param inputFilePath path to file with the inputs
- * @param labelFilePath path to file with the labels
+ * @param journal journal to initialize
+ * @param datasetUuid uuid of the data-set
+ * @param datasetType type of the data-set
+ * @param datasetName name of the data-set
+ * @param files files of the data-set, which get the state of the local files
+ * @param sources sources of the files
+ * @param options options of the upload
  * @param error reference for error-output
  *
  * @return true, if successful, else false
  */
 bool
-uploadMnistData(std::string &result,
-                const std::string &dataSetName,
-                const std::string &inputFilePath,
-                const std::string &labelFilePath,
-                Kitsunemimi::ErrorContainer &error)
+initJournal(UploadJournal &journal,
+            const std::string &datasetUuid,
+            const std::string &datasetType,
+            const std::string &datasetName,
+            std::vector<JournalFile> &files,
+            const std::vector<UploadSource*> &sources,
+            const UploadOptions &options,
+            Kitsunemimi::ErrorContainer &error)
 {
-    // init new mnist-data-set
-    if(createMnistDataSet(result,
-                          dataSetName,
-                          getFileSize(inputFilePath),
-                          getFileSize(labelFilePath),
-                          error) == false)
+    journal.setDataset(datasetUuid, datasetType, datasetName);
+    for(uint64_t i = 0; i < files.size(); i++)
     {
-        return false;
+        if(readFileState(files[i], *sources[i], options.numberOfHashThreads, error) == false) {
+            return false;
+        }
+        journal.addFile(files[i]);
     }
 
-    // parse output to get the uuid
-    Kitsunemimi::JsonItem jsonItem;
-    if(jsonItem.parse(result, error) == false)
-    {
-        LOG_ERROR(error);
+    return journal.save(error);
+}
+
+/**
+ * @brief search the manifest for a data-set with the same content as the given files. Only
+ *        data, which are in memory, are hashed, because other data would have to be read
+ *        twice.
+ *
+ * @param result reference for the metadata of the existing data-set
+ * @param contentHash reference for the content-hash of the files, which is empty, if the
+ *                    files could not be hashed
+ * @param datasetType type of the data-set
+ * @param sources sources of all files of the data-set
+ * @param options options of the upload
+ *
+ * @return true, if an existing data-set was found, else false
+ */
+bool
+findExistingDataset(std::string &result,
+                    std::string &contentHash,
+                    const std::string &datasetType,
+                    const std::vector<UploadSource*> &sources,
+                    const UploadOptions &options)
+{
+    contentHash = "";
+    if(options.manifestPath == "") {
+        return false;
+    }
+
+    // data, which can not be hashed, only disable the deduplication, but don't break the upload.
+    // The hashes of the files are cached by the sources and reused for the journal.
+    Kitsunemimi::ErrorContainer error;
+    std::vector<std::string> fileHashes(sources.size());
+    for(uint64_t i = 0; i < sources.size(); i++)
+    {
+        if(sources[i]->getData() == nullptr && sources[i]->getSize() > 0)
+        {
+            LOG_WARNING("Content of " + sources[i]->getName() + " is not in memory, so it is "
+                        "not checked against the manifest");
+            return false;
+        }
+        if(sources[i]->getContentHash(fileHashes[i], options.numberOfHashThreads, error) == false)
+        {
+            LOG_ERROR(error);
+            return false;
+        }
+    }
+    contentHash = combineContentHashes(datasetType, fileHashes);
+
+    UploadManifest manifest(options.manifestPath);
+    std::string datasetUuid = "";
+    if(manifest.find(contentHash, datasetUuid) == false) {
+        return false;
+    }
+
+    // the data-set could be deleted in the meantime, so the entry is only valid, if shiori
+    // still knows the data-set
+    if(getDataset(result, datasetUuid, error) == false)
+    {
+        LOG_WARNING("Data-set with UUID '" + datasetUuid + "' from the manifest doesn't exist "
+                    "anymore, so the data are uploaded again");
+        if(manifest.remove(contentHash, error) == false) {
+            LOG_ERROR(error);
+        }
+        result = "";
+        return false;
+    }
+
+    LOG_DEBUG("Data-set with the same content already exists with UUID '" + datasetUuid + "'");
+
+    return true;
+}
+
+/**
+ * @brief add a new data-set to the manifest, after it was uploaded successfully
+ *
+ * @param contentHash content-hash of the data-set or empty string, if it was not hashed
+ * @param datasetUuid uuid of the new data-set
+ * @param options options of the upload
+ */
+void
+registerDataset(const std::string &contentHash,
+                const std::string &datasetUuid,
+                const UploadOptions &options)
+{
+    if(options.manifestPath == "" || contentHash == "") {
+        return;
+    }
+
+    Kitsunemimi::ErrorContainer error;
+    UploadManifest manifest(options.manifestPath);
+    if(manifest.add(contentHash, datasetUuid, error) == false) {
+        LOG_ERROR(error);
+    }
+}
+
+/**
+ * @brief upload new data-set to shiori
+ *
+ * @param result reference for response-message
+ * @param dataSetName name for the new data-set
+ * @param datasetType type of the data-set, which is "csv" or "mnist"
+ * @param sources sources of the files of the data-set, which are the inputs for a csv-data-set
+ *                and the inputs and labels for a mnist-data-set
+ * @param error reference for error-output
+ * @param options options of the upload
+ *
+ * @return true, if successful, else false
+ */
+bool
+uploadDataset(std::string &result,
+              const std::string &dataSetName,
+              const std::string &datasetType,
+              const std::vector<UploadSource*> &sources,
+              Kitsunemimi::ErrorContainer &error,
+              const UploadOptions &options)
+{
+    // check if the data-set was already uploaded before
+    std::string contentHash = "";
+    if(findExistingDataset(result, contentHash, datasetType, sources, options)) {
+        return true;
+    }
+
+    // init new data-set
+    bool created = false;
+    if(datasetType == "csv")
+    {
+        created = createCsvDataSet(result, dataSetName, sources[0]->getSize(), error);
+    }
+    else
+    {
+        created = createMnistDataSet(result,
+                                     dataSetName,
+                                     sources[0]->getSize(),
+                                     sources[1]->getSize(),
+                                     error);
+    }
+    if(created == false) {
+        return false;
+    }
+
+    // parse output to get the uuid
+    Kitsunemimi::JsonItem jsonItem;
+    if(jsonItem.parse(result, error) == false)
+    {
+        LOG_ERROR(error);
         return false;
     }
 
     // get ids from inital reponse to identify the file-transfer
     const std::string uuid = jsonItem.get("uuid").getString();
-    const std::string inputUuid = jsonItem.get("uuid_input_file").getString();
-    const std::string labelUuid = jsonItem.get("uuid_label_file").getString();
-
-    // init websocket to shiori
-    WebsocketClient wsClient;
-    std::string websocketUuid = "";
-    const bool ret = wsClient.initClient(websocketUuid,
-                                         HanamiRequest::getInstance()->getToken(),
-                                         "shiori",
-                                         HanamiRequest::getInstance()->getHost(),
-                                         HanamiRequest::getInstance()->getPort(),
-                                         error);
-    if(ret == false)
-    {
-        error.addMeesage("Failed to init websocket to shiori");
+    std::vector<JournalFile> files(sources.size());
+    files[0].fileUuid = jsonItem.get("uuid_input_file").getString();
+    if(datasetType == "mnist") {
+        files[1].fileUuid = jsonItem.get("uuid_label_file").getString();
+    }
+
+    bool fromFiles = true;
+    for(uint64_t i = 0; i < files.size(); i++)
+    {
+        files[i].filePath = sources[i]->getFilePath();
+        files[i].fileSize = sources[i]->getSize();
+        fromFiles = fromFiles && files[i].filePath != "";
+    }
+
+    // init journal to be able to resume the upload, which needs the data again and so is only
+    // possible for files
+    UploadJournal journal(options.journalPath);
+    UploadJournal* usedJournal = nullptr;
+    if(options.journalPath != "" && fromFiles == false)
+    {
+        LOG_WARNING("Upload of data-set '" + dataSetName + "' has no journal, because its data "
+                    "don't come from files");
+    }
+    else if(options.journalPath != "")
+    {
+        if(initJournal(journal,
+                       uuid,
+                       datasetType,
+                       dataSetName,
+                       files,
+                       sources,
+                       options,
+                       error) == false)
+        {
+            LOG_ERROR(error);
+            return false;
+        }
+        usedJournal = &journal;
+    }
+
+    // send files and wait until all data-transfers to shiori are completed
+    if(uploadFiles(uuid, files, sources, options, usedJournal, error) == false)
+    {
+        error.addMeesage("Failed to send files of " + datasetType + "-dataset");
         LOG_ERROR(error);
         return false;
     }
 
-    // send file with inputs
-    if(sendFile(&wsClient, uuid, inputUuid, inputFilePath, error) == false)
+    bool finalized = false;
+    if(datasetType == "csv") {
+        finalized = finalizeCsvDataSet(result, uuid, files[0].fileUuid, error);
+    } else {
+        finalized = finalizeMnistDataSet(result, uuid, files[0].fileUuid, files[1].fileUuid, error);
+    }
+
+    if(finalized == false)
     {
-        error.addMeesage("Failed to send file with input-values");
+        error.addMeesage("Failed to finalize " + datasetType + "-dataset");
         LOG_ERROR(error);
         return false;
     }
 
-    // send file with labels
-    if(sendFile(&wsClient, uuid, labelUuid, labelFilePath, error) == false)
+    registerDataset(contentHash, uuid, options);
+
+    if(usedJournal != nullptr && usedJournal->remove(error) == false) {
+        LOG_ERROR(error);
+    }
+
+    return true;
+}
+
+/**
+ * @brief upload new csv-data-set to shiori
+ *
+ * @param result reference for response-message
+ * @param dataSetName name for the new data-set
+ * @param inputFilePath path to file with the inputs
+ * @param error reference for error-output
+ * @param options options of the upload
+ *
+ * @return true, if successful, else false
+ */
+bool
+uploadCsvData(std::string &result,
+              const std::string &dataSetName,
+              const std::string &inputFilePath,
+              Kitsunemimi::ErrorContainer &error,
+              const UploadOptions &options)
+{
+    if(checkUploadOptions(options, error) == false)
     {
-        error.addMeesage("Failed to send file with labes");
         LOG_ERROR(error);
         return false;
     }
 
-    // wait until all data-transfers to shiori are completed
-    if(waitUntilFullyUploaded(uuid, error) == false)
+    UploadSource input;
+    if(input.initFile(inputFilePath, error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return uploadDataset(result, dataSetName, "csv", {&input}, error, options);
+}
+
+/**
+ * @brief upload new csv-data-set from a buffer in memory to shiori, which is send without copy
+ *
+ * @param result reference for response-message
+ * @param dataSetName name for the new data-set
+ * @param inputData pointer to the inputs, which must be valid until the upload is finished
+ * @param inputDataSize number of bytes of the inputs
+ * @param error reference for error-output
+ * @param options options of the upload
+ *
+ * @return true, if successful, else false
+ */
+bool
+uploadCsvData(std::string &result,
+              const std::string &dataSetName,
+              const uint8_t* inputData,
+              const uint64_t inputDataSize,
+              Kitsunemimi::ErrorContainer &error,
+              const UploadOptions &options)
+{
+    if(checkUploadOptions(options, error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    UploadSource input;
+    input.initMemory(inputData, inputDataSize);
+
+    return uploadDataset(result, dataSetName, "csv", {&input}, error, options);
+}
+
+/**
+ * @brief upload new csv-data-set from a stream to shiori. A seekable stream is read segment by
+ *        segment from its current position while sending, other streams are read completely
+ *        into memory before the upload.
+ *
+ * @param result reference for response-message
+ * @param dataSetName name for the new data-set
+ * @param input stream with the inputs
+ * @param error reference for error-output
+ * @param options options of the upload
+ *
+ * @return true, if successful, else false
+ */
+bool
+uploadCsvData(std::string &result,
+              const std::string &dataSetName,
+              std::istream &input,
+              Kitsunemimi::ErrorContainer &error,
+              const UploadOptions &options)
+{
+    if(checkUploadOptions(options, error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    UploadSource inputSource;
+    if(inputSource.initStream(input, error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return uploadDataset(result, dataSetName, "csv", {&inputSource}, error, options);
+}
+
+/**
+ * @brief upload new csv-data-set from a chunk-producer to shiori. Because shiori needs the size
+ *        of the data at the beginning, all chunks are collected in memory before the upload.
+ *
+ * @param result reference for response-message
+ * @param dataSetName name for the new data-set
+ * @param input callback, which provides the inputs
+ * @param error reference for error-output
+ * @param options options of the upload
+ *
+ * @return true, if successful, else false
+ */
+bool
+uploadCsvData(std::string &result,
+              const std::string &dataSetName,
+              const UploadChunkProducer &input,
+              Kitsunemimi::ErrorContainer &error,
+              const UploadOptions &options)
+{
+    if(checkUploadOptions(options, error) == false)
     {
-        error.addMeesage("Failed to wait for fully uploaded files");
         LOG_ERROR(error);
         return false;
     }
 
-    if(finalizeMnistDataSet(result, uuid, inputUuid, labelUuid, error) == false)
+    UploadSource inputSource;
+    if(inputSource.initProducer(input, error) == false)
     {
-        error.addMeesage("Failed to finalize MNIST-dataset");
         LOG_ERROR(error);
         return false;
     }
 
+    return uploadDataset(result, dataSetName, "csv", {&inputSource}, error, options);
+}
+
+/**
+ * @brief upload new mnist-data-set to shiori
+ *
+ * @param result reference for response-message
+ * @param dataSetName name for the new data-set
+ * @param inputFilePath path to file with the inputs
+ * @param labelFilePath path to file with the labels
+ * @param error reference for error-output
+ * @param options options of the upload
+ *
+ * @return true, if successful, else false
+ */
+bool
+uploadMnistData(std::string &result,
+                const std::string &dataSetName,
+                const std::string &inputFilePath,
+                const std::string &labelFilePath,
+                Kitsunemimi::ErrorContainer &error,
+                const UploadOptions &options)
+{
+    if(checkUploadOptions(options, error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    UploadSource input;
+    UploadSource labels;
+    if(input.initFile(inputFilePath, error) == false
+            || labels.initFile(labelFilePath, error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return uploadDataset(result, dataSetName, "mnist", {&input, &labels}, error, options);
+}
+
+/**
+ * @brief upload new mnist-data-set from buffers in memory to shiori, which are send without copy
+ *
+ * @param result reference for response-message
+ * @param dataSetName name for the new data-set
+ * @param inputData pointer to the inputs, which must be valid until the upload is finished
+ * @param inputDataSize number of bytes of the inputs
+ * @param labelData pointer to the labels, which must be valid until the upload is finished
+ * @param labelDataSize number of bytes of the labels
+ * @param error reference for error-output
+ * @param options options of the upload
+ *
+ * @return true, if successful, else false
+ */
+bool
+uploadMnistData(std::string &result,
+                const std::string &dataSetName,
+                const uint8_t* inputData,
+                const uint64_t inputDataSize,
+                const uint8_t* labelData,
+                const uint64_t labelDataSize,
+                Kitsunemimi::ErrorContainer &error,
+                const UploadOptions &options)
+{
+    if(checkUploadOptions(options, error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    UploadSource inputSource;
+    UploadSource labelSource;
+    inputSource.initMemory(inputData, inputDataSize);
+    labelSource.initMemory(labelData, labelDataSize);
+
+    return uploadDataset(result,
+                         dataSetName,
+                         "mnist",
+                         {&inputSource, &labelSource},
+                         error,
+                         options);
+}
+
+/**
+ * @brief upload new mnist-data-set from streams to shiori. Seekable streams are read segment by
+ *        segment from their current position while sending, other streams are read completely
+ *        into memory before the upload.
+ *
+ * @param result reference for response-message
+ * @param dataSetName name for the new data-set
+ * @param input stream with the inputs
+ * @param labels stream with the labels, which must be another stream than the inputs, because
+ *               both are read at the same time
+ * @param error reference for error-output
+ * @param options options of the upload
+ *
+ * @return true, if successful, else false
+ */
+bool
+uploadMnistData(std::string &result,
+                const std::string &dataSetName,
+                std::istream &input,
+                std::istream &labels,
+                Kitsunemimi::ErrorContainer &error,
+                const UploadOptions &options)
+{
+    if(checkUploadOptions(options, error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    if(&input == &labels)
+    {
+        error.addMeesage("Inputs and labels of a MNIST-dataset can not use the same stream");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    UploadSource inputSource;
+    UploadSource labelSource;
+    if(inputSource.initStream(input, error) == false
+            || labelSource.initStream(labels, error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return uploadDataset(result,
+                         dataSetName,
+                         "mnist",
+                         {&inputSource, &labelSource},
+                         error,
+                         options);
+}
+
+/**
+ * @brief upload new mnist-data-set from chunk-producers to shiori. Because shiori needs the size
+ *        of the data at the beginning, all chunks are collected in memory before the upload.
+ *
+ * @param result reference for response-message
+ * @param dataSetName name for the new data-set
+ * @param input callback, which provides the inputs
+ * @param labels callback, which provides the labels
+ * @param error reference for error-output
+ * @param options options of the upload
+ *
+ * @return true, if successful, else false
+ */
+bool
+uploadMnistData(std::string &result,
+                const std::string &dataSetName,
+                const UploadChunkProducer &input,
+                const UploadChunkProducer &labels,
+                Kitsunemimi::ErrorContainer &error,
+                const UploadOptions &options)
+{
+    if(checkUploadOptions(options, error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    UploadSource inputSource;
+    UploadSource labelSource;
+    if(inputSource.initProducer(input, error) == false
+            || labelSource.initProducer(labels, error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return uploadDataset(result,
+                         dataSetName,
+                         "mnist",
+                         {&inputSource, &labelSource},
+                         error,
+                         options);
+}
+
+/**
+ * @brief restart an upload, whose local files were changed since the start of the upload. The
+ *        incomplete data-set is deleted and the files are uploaded as new data-set with a new
+ *        journal at the same path.
+ *
+ * @param result reference for response-message
+ * @param journal journal of the failed upload
+ * @param sources sources of the changed files
+ * @param error reference for error-output
+ * @param options options of the upload
+ *
+ * @return true, if successful, else false
+ */
+bool
+restartUpload(std::string &result,
+              UploadJournal &journal,
+              const std::vector<UploadSource*> &sources,
+              Kitsunemimi::ErrorContainer &error,
+              const UploadOptions &options)
+{
+    const std::string uuid = journal.getDatasetUuid();
+    LOG_WARNING("Files of data-set with UUID '" + uuid + "' have changed since the start of the "
+                "upload, so the upload is restarted");
+
+    // the old data-set can never be completed, so a failed delete only leaves it in shiori
+    std::string deleteResult = "";
+    Kitsunemimi::ErrorContainer deleteError;
+    if(deleteDataset(deleteResult, uuid, deleteError) == false)
+    {
+        deleteError.addMeesage("Failed to delete incomplete data-set with UUID '" + uuid + "'");
+        LOG_ERROR(deleteError);
+    }
+
+    UploadOptions restartOptions = options;
+    restartOptions.journalPath = journal.getPath();
+    if(uploadDataset(result,
+                     journal.getDatasetName(),
+                     journal.getDatasetType(),
+                     sources,
+                     error,
+                     restartOptions) == false)
+    {
+        return false;
+    }
+
+    // the new upload doesn't write a journal, if the data-set was found in the manifest, so the
+    // old journal has to be deleted here
+    if(journal.remove(error) == false) {
+        LOG_ERROR(error);
+    }
+
+    return true;
+}
+
+/**
+ * @brief resume an upload, which was started with a journal and failed before all data were
+ *        send. Only the ranges of the files, which are not marked as send in the journal, are
+ *        send again. After a successful upload the data-set is finalized and the journal is
+ *        deleted. If the size, modification-time or content of a file has changed since the
+ *        start of the upload, the whole upload is restarted with a new data-set instead.
+ *
+ * @param result reference for response-message
+ * @param journalPath path to the journal of the failed upload
+ * @param error reference for error-output
+ * @param options options of the upload
+ *
+ * @return true, if successful, else false
+ */
+bool
+resumeUpload(std::string &result,
+             const std::string &journalPath,
+             Kitsunemimi::ErrorContainer &error,
+             const UploadOptions &options)
+{
+    if(checkUploadOptions(options, error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    UploadJournal journal(journalPath);
+    if(journal.load(error) == false)
+    {
+        error.addMeesage("Failed to load upload-journal '" + journalPath + "'");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    const std::string uuid = journal.getDatasetUuid();
+    const std::string type = journal.getDatasetType();
+    const std::vector<JournalFile> files = journal.getFiles();
+
+    if((type == "csv" && files.size() != 1)
+            || (type == "mnist" && files.size() != 2)
+            || (type != "csv" && type != "mnist"))
+    {
+        error.addMeesage("Upload-journal '" + journalPath + "' has an invalid data-set");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // the missing ranges can only be send, if the local files are still the same like at the
+    // start of the upload
+    std::vector<UploadSource> sources(files.size());
+    std::vector<UploadSource*> sourcePointers;
+    bool filesChanged = false;
+    for(uint64_t i = 0; i < files.size(); i++)
+    {
+        if(sources[i].initFile(files[i].filePath, error) == false)
+        {
+            LOG_ERROR(error);
+            return false;
+        }
+        sourcePointers.push_back(&sources[i]);
+
+        JournalFile current = files[i];
+        if(readFileState(current, sources[i], options.numberOfHashThreads, error) == false)
+        {
+            LOG_ERROR(error);
+            return false;
+        }
+        if(current.fileSize != files[i].fileSize
+                || current.modificationTime != files[i].modificationTime
+                || current.contentHash != files[i].contentHash)
+        {
+            LOG_WARNING("File '"
+                        + files[i].filePath
+                        + "' has changed since the start of the upload");
+            filesChanged = true;
+        }
+    }
+
+    if(filesChanged) {
+        return restartUpload(result, journal, sourcePointers, error, options);
+    }
+
+    // send missing ranges and wait until all data-transfers to shiori are completed
+    if(uploadFiles(uuid, files, sourcePointers, options, &journal, error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    bool finalized = false;
+    if(type == "csv") {
+        finalized = finalizeCsvDataSet(result, uuid, files[0].fileUuid, error);
+    } else {
+        finalized = finalizeMnistDataSet(result, uuid, files[0].fileUuid, files[1].fileUuid, error);
+    }
+
+    if(finalized == false)
+    {
+        error.addMeesage("Failed to finalize data-set with UUID '" + uuid + "'");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    if(journal.remove(error) == false) {
+        LOG_ERROR(error);
+    }
+
     return true;
 }
 
@@ -0,0 +1,316 @@
+/**
+ * @file        delta_encoding.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libHanamiAiSdk/delta_encoding.h>
+
+#include <string.h>
+#include <algorithm>
+
+// size of the frame-header with type, shift and number of values or changes
+#define DELTA_HEADER_SIZE 9
+#define KEYFRAME_TYPE 0
+#define DELTA_TYPE 1
+
+namespace HanamiAI
+{
+
+/**
+ * @brief compare two floats bitwise, so NaN and negative zero are handled exactly
+ */
+inline bool
+sameBits(const float a, const float b)
+{
+    uint32_t x = 0;
+    uint32_t y = 0;
+    memcpy(&x, &a, 4);
+    memcpy(&y, &b, 4);
+    return x == y;
+}
+
+/**
+ * @brief write the header of a frame
+ */
+inline void
+writeDeltaHeader(uint8_t* target,
+                 const uint8_t type,
+                 const uint32_t shift,
+                 const uint32_t number)
+{
+    target[0] = type;
+    memcpy(&target[1], &shift, 4);
+    memcpy(&target[5], &number, 4);
+}
+
+/**
+ * @brief constructor
+ *
+ * @param keyframeInterval maximum number of frames between two keyframes, to resynchronize
+ *                         the decoder in regular intervals
+ * @param maxShift maximum shift, which is checked against the previous vector
+ */
+DeltaEncoder::DeltaEncoder(const uint32_t keyframeInterval,
+                           const uint32_t maxShift)
+{
+    m_keyframeInterval = keyframeInterval;
+    m_maxShift = maxShift;
+}
+
+/**
+ * @brief get maximum size of a frame, which is the size of a keyframe
+ *
+ * @param numberOfValues number of values of the vector
+ *
+ * @return maximum number of bytes of a frame
+ */
+uint64_t
+DeltaEncoder::getMaxFrameSize(const uint64_t numberOfValues) const
+{
+    return DELTA_HEADER_SIZE + numberOfValues * sizeof(float);
+}
+
+/**
+ * @brief reset the encoder, so the next frame is a keyframe
+ */
+void
+DeltaEncoder::reset()
+{
+    m_hasPrevious = false;
+    m_framesSinceKeyframe = 0;
+}
+
+/**
+ * @brief count the values, which have to be send for a specific shift
+ *
+ * @param values new values
+ * @param numberOfValues number of values
+ * @param shift shift against the previous vector
+ * @param limit counting stops, when this number is reached
+ *
+ * @return number of changed values
+ */
+uint64_t
+DeltaEncoder::countChanges(const float* values,
+                           const uint64_t numberOfValues,
+                           const uint32_t shift,
+                           const uint64_t limit) const
+{
+    // values at the end, which were shifted in, are always new
+    uint64_t changes = shift;
+    const uint64_t end = numberOfValues - shift;
+
+    for(uint64_t i = 0; i < end && changes < limit; i++) {
+        changes += sameBits(values[i], m_previous[i + shift]) == false;
+    }
+
+    return changes;
+}
+
+/**
+ * @brief encode the next vector of the stream
+ *
+ * @param target pointer to buffer with at least getMaxFrameSize() bytes
+ * @param values pointer to the values of the vector
+ * @param numberOfValues number of values
+ *
+ * @return number of written bytes
+ */
+uint64_t
+DeltaEncoder::encode(uint8_t* target,
+                     const float* values,
+                     const uint64_t numberOfValues)
+{
+    const uint64_t keyframeSize = getMaxFrameSize(numberOfValues);
+
+    // an empty vector is always send as keyframe, which has only the header
+    if(numberOfValues == 0)
+    {
+        writeDeltaHeader(target, KEYFRAME_TYPE, 0, 0);
+        m_previous.clear();
+        m_framesSinceKeyframe = 0;
+        m_hasPrevious = true;
+        return keyframeSize;
+    }
+
+    bool useKeyframe = m_hasPrevious == false
+                       || m_previous.size() != numberOfValues
+                       || m_framesSinceKeyframe + 1 >= m_keyframeInterval;
+
+    // search shift with the smallest number of changes
+    uint32_t bestShift = 0;
+    uint64_t bestChanges = numberOfValues;
+    if(useKeyframe == false)
+    {
+        const uint64_t maxShift = std::min(static_cast<uint64_t>(m_maxShift), numberOfValues);
+        for(uint32_t shift = 0; shift <= maxShift; shift++)
+        {
+            const uint64_t changes = countChanges(values, numberOfValues, shift, bestChanges);
+            if(changes < bestChanges)
+            {
+                bestChanges = changes;
+                bestShift = shift;
+            }
+        }
+
+        // fall back to keyframe, if the delta is not smaller
+        const uint64_t deltaSize = DELTA_HEADER_SIZE
+                                   + bestChanges * (sizeof(uint32_t) + sizeof(float));
+        useKeyframe = deltaSize >= keyframeSize;
+    }
+
+    uint64_t frameSize = 0;
+    if(useKeyframe)
+    {
+        writeDeltaHeader(target, KEYFRAME_TYPE, 0, static_cast<uint32_t>(numberOfValues));
+        memcpy(&target[DELTA_HEADER_SIZE], values, numberOfValues * sizeof(float));
+        frameSize = keyframeSize;
+
+        m_previous.resize(numberOfValues);
+        m_framesSinceKeyframe = 0;
+        m_hasPrevious = true;
+    }
+    else
+    {
+        writeDeltaHeader(target, DELTA_TYPE, bestShift, static_cast<uint32_t>(bestChanges));
+
+        uint8_t* pos = &target[DELTA_HEADER_SIZE];
+        for(uint64_t i = 0; i < numberOfValues; i++)
+        {
+            if(i < numberOfValues - bestShift
+                    && sameBits(values[i], m_previous[i + bestShift]))
+            {
+                continue;
+            }
+
+            const uint32_t index = static_cast<uint32_t>(i);
+            memcpy(pos, &index, 4);
+            memcpy(pos + 4, &values[i], 4);
+            pos += 8;
+        }
+        frameSize = static_cast<uint64_t>(pos - target);
+
+        m_framesSinceKeyframe++;
+    }
+
+    memcpy(m_previous.data(), values, numberOfValues * sizeof(float));
+
+    return frameSize;
+}
+
+/**
+ * @brief reset the decoder, so only a keyframe is accepted as next frame
+ */
+void
+DeltaDecoder::reset()
+{
+    m_hasPrevious = false;
+}
+
+/**
+ * @brief decode the next frame of the stream
+ *
+ * @param target pointer to buffer for the decoded values
+ * @param data pointer to the frame
+ * @param dataSize number of bytes of the frame
+ * @param numberOfValues number of values of the vector
+ *
+ * @return false, if the frame is broken or doesn't fit to the previous one, else true. A
+ *         broken frame doesn't change the state of the decoder.
+ */
+bool
+DeltaDecoder::decode(float* target,
+                     const uint8_t* data,
+                     const uint64_t dataSize,
+                     const uint64_t numberOfValues)
+{
+    if(dataSize < DELTA_HEADER_SIZE) {
+        return false;
+    }
+
+    uint32_t shift = 0;
+    uint32_t number = 0;
+    memcpy(&shift, &data[1], 4);
+    memcpy(&number, &data[5], 4);
+
+    if(data[0] == KEYFRAME_TYPE)
+    {
+        if(number != numberOfValues
+                || dataSize != DELTA_HEADER_SIZE + numberOfValues * sizeof(float))
+        {
+            return false;
+        }
+
+        m_previous.resize(numberOfValues);
+        if(numberOfValues > 0)
+        {
+            memcpy(m_previous.data(),
+                   &data[DELTA_HEADER_SIZE],
+                   numberOfValues * sizeof(float));
+        }
+        m_hasPrevious = true;
+    }
+    else
+    {
+        // a delta can only be applied on top of a vector with the same size
+        if(m_hasPrevious == false
+                || m_previous.size() != numberOfValues
+                || shift > numberOfValues
+                || dataSize != DELTA_HEADER_SIZE + number * (sizeof(uint32_t) + sizeof(float)))
+        {
+            return false;
+        }
+
+        // check all indexes, before the previous vector is changed, so it stays valid for
+        // the next frames, if this one is broken
+        const uint8_t* pos = &data[DELTA_HEADER_SIZE];
+        for(uint32_t i = 0; i < number; i++)
+        {
+            uint32_t index = 0;
+            memcpy(&index, &pos[i * 8], 4);
+            if(index >= numberOfValues) {
+                return false;
+            }
+        }
+
+        if(numberOfValues == 0) {
+            return true;
+        }
+
+        memmove(m_previous.data(),
+                m_previous.data() + shift,
+                (numberOfValues - shift) * sizeof(float));
+
+        for(uint32_t i = 0; i < number; i++)
+        {
+            uint32_t index = 0;
+            memcpy(&index, &pos[i * 8], 4);
+            memcpy(&m_previous[index], &pos[i * 8 + 4], 4);
+        }
+    }
+
+    if(numberOfValues > 0) {
+        memcpy(target, m_previous.data(), numberOfValues * sizeof(float));
+    }
+
+    return true;
+}
+
+} // namespace HanamiAI
@@ -0,0 +1,950 @@
+/**
+ * @file        direct_session.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libHanamiAiSdk/direct_session.h>
+#include <libHanamiAiSdk/value_encoding.h>
+#include <libHanamiAiSdk/common/websocket_client.h>
+#include <common/direct_io_messages.h>
+#include <common/result_cache.h>
+#include <common/encoded_values.h>
+
+// maximum number of responses, which are allowed to be outstanding while sending batches. The
+// responses are small, so this keeps the receive-side of the socket from filling up, while the
+// sender is still writing frames, which would otherwise block both sides.
+#define MAX_PENDING_RESPONSES 64
+
+namespace HanamiAI
+{
+
+/**
+ * @brief constructor
+ *
+ * @param wsClient initialized websocket-client to the cluster, which is owned by the session
+ * @param clusterUuid uuid of the cluster, which is connected by the session
+ */
+DirectSession::DirectSession(WebsocketClient* wsClient,
+                             const std::string &clusterUuid)
+{
+    m_wsClient = wsClient;
+    m_clusterUuid = clusterUuid;
+    m_messages = new DirectIoMessages();
+}
+
+/**
+ * @brief destructor
+ */
+DirectSession::~DirectSession()
+{
+    delete m_resultCache;
+    delete m_messages;
+    delete m_wsClient;
+}
+
+/**
+ * @brief enable the cache for the results of single requests. Identical inputs are answered by
+ *        the cache, until the cluster is trained or restored. Batch-requests are not cached.
+ *
+ * @param maxBytes maximum number of bytes of all cached input- and output-values
+ */
+void
+DirectSession::enableResultCache(const uint64_t maxBytes)
+{
+    delete m_resultCache;
+    m_resultCache = new ResultCache(maxBytes, m_clusterUuid);
+}
+
+/**
+ * @brief set encoding of the input- and should-values of the default-segments. The default
+ *        FP32_ENCODING is the only one, which is supported by the current version of kyouko.
+ *        All other encodings send the values with reduced precision in additional fields of
+ *        the message and must only be used with servers, which explicitly support them.
+ *        Encoded output-values in responses are always decoded.
+ *
+ * @param encoding new encoding
+ */
+void
+DirectSession::setValueEncoding(const ValueEncoding encoding)
+{
+    m_learnInput.setEncoding(encoding);
+    m_learnShould.setEncoding(encoding);
+    m_requestInput.setEncoding(encoding);
+}
+
+/**
+ * @brief enable or disable the sparse-encoding of the input-values of the default-segments,
+ *        which sends mostly-zero inputs as (index, value)-pairs. It is selected per message and
+ *        like setValueEncoding only supported by servers, which explicitly support it.
+ *
+ * @param enabled true to enable the sparse-encoding
+ * @param maxDensity maximum ratio of non-zero values for the sparse-encoding
+ */
+void
+DirectSession::setSparseEncoding(const bool enabled,
+                                 const float maxDensity)
+{
+    m_learnInput.setSparseEncoding(enabled, maxDensity);
+    m_requestInput.setSparseEncoding(enabled, maxDensity);
+}
+
+/**
+ * @brief enable or disable the delta-encoding of the input-values of the default-segments,
+ *        which sends only the shift and the changed values against the previous input, like
+ *        for sliding windows over a time-series. Learn- and request-inputs are separate
+ *        streams. Like setValueEncoding it is only supported by servers, which explicitly
+ *        support it.
+ *
+ * @param enabled true to enable the delta-encoding
+ * @param keyframeInterval maximum number of messages between two keyframes
+ */
+void
+DirectSession::setDeltaEncoding(const bool enabled,
+                                const uint32_t keyframeInterval)
+{
+    m_learnInput.setDeltaEncoding(enabled, keyframeInterval);
+    m_requestInput.setDeltaEncoding(enabled, keyframeInterval);
+}
+
+/**
+ * @brief disable the result-cache and free all cached results
+ */
+void
+DirectSession::disableResultCache()
+{
+    delete m_resultCache;
+    m_resultCache = nullptr;
+}
+
+/**
+ * @brief remove all cached results of the session
+ */
+void
+DirectSession::clearResultCache()
+{
+    if(m_resultCache != nullptr) {
+        m_resultCache->clear();
+    }
+}
+
+/**
+ * @brief check if the session is broken by a failed transfer. A broken session can not be
+ *        used anymore and has to be replaced by a new one.
+ */
+bool
+DirectSession::isBroken() const
+{
+    return m_broken;
+}
+
+/**
+ * @brief check if the session can still be used
+ *
+ * @param error reference for error-output
+ *
+ * @return false, if the session is broken, else true
+ */
+bool
+DirectSession::checkSession(Kitsunemimi::ErrorContainer &error)
+{
+    if(m_broken)
+    {
+        error.addMeesage("Direct-session to cluster '"
+                         + m_clusterUuid
+                         + "' is broken by a previous failed transfer and has to be recreated");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief get uuid of the cluster of the session
+ */
+const std::string&
+DirectSession::getClusterUuid() const
+{
+    return m_clusterUuid;
+}
+
+/**
+ * @brief get number of input-values of the last successful call
+ */
+uint64_t
+DirectSession::getNumberOfInputValues() const
+{
+    return m_numberOfInputValues;
+}
+
+/**
+ * @brief get number of output-values of the last successful call
+ */
+uint64_t
+DirectSession::getNumberOfOutputValues() const
+{
+    return m_numberOfOutputValues;
+}
+
+/**
+ * @brief get statistics of the data-transfer of the session
+ */
+const DirectSessionStatistics&
+DirectSession::getStatistics() const
+{
+    return m_stats;
+}
+
+/**
+ * @brief fill a prepared message with values and send it
+ *
+ * @param prepared prepared message for the target-segment
+ * @param values pointer to the values to send
+ * @param numberOfValues number of values
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DirectSession::sendPrepared(PreparedRequest &prepared,
+                            const float* values,
+                            const uint64_t numberOfValues,
+                            Kitsunemimi::ErrorContainer &error)
+{
+    // the frame of the prepared message is sized by the values and only reallocated when it
+    // has to grow, so the only limit is the maximum message-size of protobuf
+    uint64_t frameSize = 0;
+    const uint8_t* frame = prepared.fill(values, numberOfValues, frameSize);
+    if(frame == nullptr)
+    {
+        // nothing was written to the websocket, so the session is still usable
+        m_stats.numberOfErrors++;
+        error.addMeesage("Number of values is too big for a single message: "
+                         + std::to_string(numberOfValues));
+        return false;
+    }
+
+    if(m_wsClient->sendMessage(frame, frameSize, error) == false)
+    {
+        // a partly written frame can not be recovered
+        m_broken = true;
+        m_stats.numberOfErrors++;
+        return false;
+    }
+
+    m_stats.numberOfSentMessages++;
+    m_stats.numberOfSentBytes += frameSize;
+
+    return true;
+}
+
+/**
+ * @brief receive a message into the receive-buffer of the websocket
+ *
+ * @param numberOfBytes reference for the size of the message
+ * @param error reference for error-output
+ *
+ * @return nullptr, if failed, else pointer to the message, which is valid until the next read
+ */
+const uint8_t*
+DirectSession::receiveMessage(uint64_t &numberOfBytes,
+                              Kitsunemimi::ErrorContainer &error)
+{
+    numberOfBytes = 0;
+    const uint8_t* recvData = m_wsClient->readMessageIntoBuffer(numberOfBytes, error);
+    if(recvData == nullptr
+            || numberOfBytes == 0)
+    {
+        m_broken = true;
+        m_stats.numberOfErrors++;
+        error.addMeesage("Got no valid response");
+        return nullptr;
+    }
+
+    m_stats.numberOfReceivedMessages++;
+    m_stats.numberOfReceivedBytes += numberOfBytes;
+
+    return recvData;
+}
+
+/**
+ * @brief receive a single response of a running learn-batch
+ *
+ * @param responseId number of the response within the batch
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DirectSession::receiveLearnResponse(const uint64_t responseId,
+                                    Kitsunemimi::ErrorContainer &error)
+{
+    uint64_t numberOfBytes = 0;
+    const uint8_t* recvData = receiveMessage(numberOfBytes, error);
+    if(recvData == nullptr) {
+        return false;
+    }
+
+    // every sample results in two responses. The first one is the bogus-response of the input,
+    // which exist only because of issue:
+    //     https://github.com/kitsudaiki/KyoukoMind/issues/27
+    // and the second one is the end-message of the sample
+    if(responseId % 2 == 0) {
+        return true;
+    }
+
+    if(m_messages->response.ParseFromArray(recvData, numberOfBytes) == false)
+    {
+        m_stats.numberOfErrors++;
+        error.addMeesage("Got no valid learn-end-message");
+        return false;
+    }
+
+    m_stats.numberOfLearnedSamples++;
+
+    return true;
+}
+
+/**
+ * @brief get the output-values of a response, which was parsed into the response-message
+ *
+ * @param recvData pointer to the serialized response
+ * @param numberOfBytes size of the serialized response
+ * @param numberOfValues reference for returning the number of output-values
+ * @param maxNumberOfValues maximum number of encoded values, which are accepted
+ *
+ * @return nullptr, if the encoded values of the response are broken, else pointer to the values
+ */
+const float*
+DirectSession::getResponseValues(const uint8_t* recvData,
+                                 const uint64_t numberOfBytes,
+                                 uint64_t &numberOfValues,
+                                 const uint64_t maxNumberOfValues)
+{
+    const ClusterIO_Message &response = m_messages->response;
+    numberOfValues = static_cast<uint64_t>(response.values_size());
+
+    // plain float-values, like kyouko sends them
+    if(numberOfValues > 0
+            || response.numberofvalues() == 0)
+    {
+        return response.values().data();
+    }
+
+    // the values are not in the values-field, so they can only be encoded
+    EncodedValues encoded;
+    if(parseEncodedValues(encoded, recvData, numberOfBytes) == false
+            || encoded.hasEncoding == false)
+    {
+        return nullptr;
+    }
+
+    // check the number of values, before the buffer is resized, so a broken response can not
+    // trigger a huge allocation. Values of the dense encodings have a fixed size.
+    if(encoded.numberOfValues > maxNumberOfValues) {
+        return nullptr;
+    }
+    if(encoded.encoding <= INT8_ENCODING
+            && encoded.dataSize != getEncodedSize(static_cast<ValueEncoding>(encoded.encoding),
+                                                  encoded.numberOfValues))
+    {
+        return nullptr;
+    }
+
+    m_decodedOutput.resize(encoded.numberOfValues);
+    if(decodeEncodedValues(m_decodedOutput.data(), encoded) == false) {
+        return nullptr;
+    }
+
+    numberOfValues = encoded.numberOfValues;
+    return m_decodedOutput.data();
+}
+
+/**
+ * @brief receive a single response of a request and write its output-values into the buffer
+ *
+ * @param outputRow pointer to the buffer for the output-values
+ * @param numberOfOutputColumns expected number of output-values
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DirectSession::receiveRequestResponse(float* outputRow,
+                                      const uint64_t numberOfOutputColumns,
+                                      Kitsunemimi::ErrorContainer &error)
+{
+    uint64_t numberOfBytes = 0;
+    const uint8_t* recvData = receiveMessage(numberOfBytes, error);
+    if(recvData == nullptr) {
+        return false;
+    }
+
+    ClusterIO_Message &response = m_messages->response;
+    if(response.ParseFromArray(recvData, numberOfBytes) == false)
+    {
+        m_stats.numberOfErrors++;
+        error.addMeesage("Got no valid request response");
+        return false;
+    }
+
+    uint64_t numberOfValues = 0;
+    const float* values = getResponseValues(recvData,
+                                            numberOfBytes,
+                                            numberOfValues,
+                                            numberOfOutputColumns);
+    if(values == nullptr)
+    {
+        m_stats.numberOfErrors++;
+        error.addMeesage("Got request response with broken encoded values");
+        return false;
+    }
+
+    if(numberOfValues != numberOfOutputColumns)
+    {
+        m_stats.numberOfErrors++;
+        error.addMeesage("Number of output-values in response ("
+                         + std::to_string(numberOfValues)
+                         + ") doesn't match the number of columns of the output-matrix ("
+                         + std::to_string(numberOfOutputColumns)
+                         + ")");
+        return false;
+    }
+
+    memcpy(outputRow, values, numberOfOutputColumns * sizeof(float));
+    m_numberOfOutputValues = numberOfOutputColumns;
+    m_stats.numberOfRequests++;
+
+    return true;
+}
+
+/**
+ * @brief learn single value with prepared messages
+ *
+ * @param preparedInput prepared message for the input-segment
+ * @param inputValues float-pointer to array with input-values for input-segment
+ * @param numberOfInputValues number of input-values for input-segment
+ * @param preparedShould prepared message for the output-segment
+ * @param shouldValues float-pointer to array with should-values for output-segment
+ * @param numberOfShouldValues number of should-values for output-segment
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DirectSession::learn(PreparedRequest &preparedInput,
+                     const float* inputValues,
+                     const uint64_t numberOfInputValues,
+                     PreparedRequest &preparedShould,
+                     const float* shouldValues,
+                     const uint64_t numberOfShouldValues,
+                     Kitsunemimi::ErrorContainer &error)
+{
+    if(checkSession(error) == false) {
+        return false;
+    }
+
+    if(preparedInput.getType() != LEARN_INPUT_PREPARED
+            || preparedShould.getType() != LEARN_SHOULD_PREPARED)
+    {
+        error.addMeesage("Prepared requests have the wrong type for learning");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // the cluster is changed by the learning, so all cached results of the cluster become
+    // invalid. This is done before and after the learning, because other sessions can
+    // request the cluster at the same time.
+    invalidateClusterResults(m_clusterUuid);
+
+    // send input
+    if(sendPrepared(preparedInput, inputValues, numberOfInputValues, error) == false)
+    {
+        error.addMeesage("Failed to send input-values");
+        LOG_ERROR(error);
+        invalidateClusterResults(m_clusterUuid);
+        return false;
+    }
+
+    // receive bogus-response
+    if(receiveLearnResponse(0, error) == false)
+    {
+        LOG_ERROR(error);
+        invalidateClusterResults(m_clusterUuid);
+        return false;
+    }
+
+    // send should
+    if(sendPrepared(preparedShould, shouldValues, numberOfShouldValues, error) == false)
+    {
+        // the input was already accepted by the server, which still waits for the should-values,
+        // so the session can not be used anymore, even if nothing was written to the websocket
+        m_broken = true;
+        error.addMeesage("Failed to send should-values");
+        LOG_ERROR(error);
+        invalidateClusterResults(m_clusterUuid);
+        return false;
+    }
+
+    // receive and check end-message
+    if(receiveLearnResponse(1, error) == false)
+    {
+        LOG_ERROR(error);
+        invalidateClusterResults(m_clusterUuid);
+        return false;
+    }
+
+    m_numberOfInputValues = numberOfInputValues;
+    m_numberOfOutputValues = numberOfShouldValues;
+
+    // results, which were requested by other sessions while learning, can be cached with the
+    // generation of the start of the learning, so they have to be invalidated again
+    invalidateClusterResults(m_clusterUuid);
+
+    return true;
+}
+
+/**
+ * @brief request single value with a prepared message
+ *
+ * @param preparedInput prepared message for the input-segment
+ * @param inputValues float-pointer to array with input-values for input-segment
+ * @param numberOfInputValues number of input-values for input-segment
+ * @param outputValues pointer to buffer for the output-values
+ * @param numberOfOutputValues expected number of output-values
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DirectSession::request(PreparedRequest &preparedInput,
+                       const float* inputValues,
+                       const uint64_t numberOfInputValues,
+                       float* outputValues,
+                       const uint64_t numberOfOutputValues,
+                       Kitsunemimi::ErrorContainer &error)
+{
+    if(checkSession(error) == false) {
+        return false;
+    }
+
+    if(preparedInput.getType() != REQUEST_INPUT_PREPARED)
+    {
+        error.addMeesage("Prepared request has the wrong type for requesting");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // check cache
+    uint64_t hash = 0;
+    uint64_t generation = 0;
+    if(m_resultCache != nullptr)
+    {
+        generation = m_resultCache->getGeneration();
+        hash = hashValues(inputValues, numberOfInputValues);
+        if(m_resultCache->get(inputValues, numberOfInputValues, hash, m_cachedOutput)
+                && m_cachedOutput.size() == numberOfOutputValues)
+        {
+            memcpy(outputValues, &m_cachedOutput[0], numberOfOutputValues * sizeof(float));
+            m_stats.numberOfCacheHits++;
+            return true;
+        }
+    }
+
+    // send input
+    if(sendPrepared(preparedInput, inputValues, numberOfInputValues, error) == false)
+    {
+        error.addMeesage("Failed to send input-values");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // receive response
+    if(receiveRequestResponse(outputValues, numberOfOutputValues, error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    m_numberOfInputValues = numberOfInputValues;
+
+    if(m_resultCache != nullptr)
+    {
+        m_resultCache->add(inputValues, numberOfInputValues, hash,
+                           outputValues, numberOfOutputValues,
+                           generation);
+    }
+
+    return true;
+}
+
+/**
+ * @brief learn single value
+ *
+ * @param inputValues vector with all input-values
+ * @param shouldValues vector with all should-values
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DirectSession::learn(std::vector<float> &inputValues,
+                     std::vector<float> &shouldValues,
+                     Kitsunemimi::ErrorContainer &error)
+{
+    return learn(&inputValues[0],
+                 inputValues.size(),
+                 &shouldValues[0],
+                 shouldValues.size(),
+                 error);
+}
+
+/**
+ * @brief learn single value
+ *
+ * @param inputValues float-pointer to array with input-values for input-segment
+ * @param numberOfInputValues number of input-values for input-segment
+ * @param shouldValues float-pointer to array with should-values for output-segment
+ * @param numberOfShouldValues number of should-values for output-segment
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DirectSession::learn(const float* inputValues,
+                     const uint64_t numberOfInputValues,
+                     const float* shouldValues,
+                     const uint64_t numberOfShouldValues,
+                     Kitsunemimi::ErrorContainer &error)
+{
+    return learn(m_learnInput,
+                 inputValues,
+                 numberOfInputValues,
+                 m_learnShould,
+                 shouldValues,
+                 numberOfShouldValues,
+                 error);
+}
+
+/**
+ * @brief request single value
+ *
+ * @param inputValues vector with all input-values
+ * @param numberOfOutputValues reference for returning number of output-values
+ * @param error reference for error-output
+ *
+ * @return nullptr, if failed, else array with the output-values, which has to be deleted
+ *         by the caller
+ */
+float*
+DirectSession::request(std::vector<float> &inputValues,
+                       uint64_t &numberOfOutputValues,
+                       Kitsunemimi::ErrorContainer &error)
+{
+    return request(&inputValues[0],
+                   inputValues.size(),
+                   numberOfOutputValues,
+                   error);
+}
+
+/**
+ * @brief request single value
+ *
+ * @param inputValues float-pointer to array with input-values for input-segment
+ * @param numberOfInputValues number of input-values for input-segment
+ * @param numberOfOutputValues reference for returning number of output-values
+ * @param error reference for error-output
+ *
+ * @return nullptr, if failed, else array with the output-values, which has to be deleted
+ *         by the caller
+ */
+float*
+DirectSession::request(const float* inputValues,
+                       const uint64_t numberOfInputValues,
+                       uint64_t &numberOfOutputValues,
+                       Kitsunemimi::ErrorContainer &error)
+{
+    numberOfOutputValues = 0;
+    if(checkSession(error) == false) {
+        return nullptr;
+    }
+
+    // check cache
+    uint64_t hash = 0;
+    uint64_t generation = 0;
+    if(m_resultCache != nullptr)
+    {
+        generation = m_resultCache->getGeneration();
+        hash = hashValues(inputValues, numberOfInputValues);
+        if(m_resultCache->get(inputValues, numberOfInputValues, hash, m_cachedOutput))
+        {
+            numberOfOutputValues = m_cachedOutput.size();
+            float* result = new float[numberOfOutputValues];
+            if(numberOfOutputValues > 0) {
+                memcpy(result, &m_cachedOutput[0], numberOfOutputValues * sizeof(float));
+            }
+            m_stats.numberOfCacheHits++;
+            return result;
+        }
+    }
+
+    // send input
+    if(sendPrepared(m_requestInput, inputValues, numberOfInputValues, error) == false)
+    {
+        error.addMeesage("Failed to send input-values");
+        LOG_ERROR(error);
+        return nullptr;
+    }
+
+    // receive response
+    uint64_t numberOfBytes = 0;
+    const uint8_t* recvData = receiveMessage(numberOfBytes, error);
+    if(recvData == nullptr)
+    {
+        error.addMeesage("Got no valid request response");
+        LOG_ERROR(error);
+        return nullptr;
+    }
+
+    // read message from response
+    ClusterIO_Message &response = m_messages->response;
+    if(response.ParseFromArray(recvData, numberOfBytes) == false)
+    {
+        m_stats.numberOfErrors++;
+        error.addMeesage("Got no valid request response");
+        LOG_ERROR(error);
+        return nullptr;
+    }
+
+    // convert output
+    const float* values = getResponseValues(recvData,
+                                            numberOfBytes,
+                                            numberOfOutputValues,
+                                            MAX_NUMBER_OF_PREPARED_VALUES);
+    if(values == nullptr)
+    {
+        numberOfOutputValues = 0;
+        m_stats.numberOfErrors++;
+        error.addMeesage("Got request response with broken encoded values");
+        LOG_ERROR(error);
+        return nullptr;
+    }
+
+    float* result = new float[numberOfOutputValues];
+    if(numberOfOutputValues > 0) {
+        memcpy(result, values, numberOfOutputValues * sizeof(float));
+    }
+
+    m_numberOfInputValues = numberOfInputValues;
+    m_numberOfOutputValues = numberOfOutputValues;
+    m_stats.numberOfRequests++;
+
+    if(m_resultCache != nullptr)
+    {
+        m_resultCache->add(inputValues, numberOfInputValues, hash,
+                           result, numberOfOutputValues,
+                           generation);
+    }
+
+    return result;
+}
+
+/**
+ * @brief learn multiple samples with one call. All frames of the batch are sent back to back
+ *        and the responses are collected while the following frames are still in flight, so
+ *        the throughput is not limited by the round-trip-time per sample anymore. If the batch
+ *        fails, responses of the batch can still be pending on the websocket, so the session
+ *        is marked as broken and rejects all following calls.
+ *
+ * @param inputValues float-pointer to matrix with input-values in row-major order
+ * @param numberOfInputValuesPerSample number of input-values of each sample
+ * @param shouldValues float-pointer to matrix with should-values in row-major order
+ * @param numberOfShouldValuesPerSample number of should-values of each sample
+ * @param batchSize number of samples
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DirectSession::learnBatch(const float* inputValues,
+                          const uint64_t numberOfInputValuesPerSample,
+                          const float* shouldValues,
+                          const uint64_t numberOfShouldValuesPerSample,
+                          const uint64_t batchSize,
+                          Kitsunemimi::ErrorContainer &error)
+{
+    if(checkSession(error) == false) {
+        return false;
+    }
+
+    uint64_t numberOfSentFrames = 0;
+    uint64_t numberOfReceivedResponses = 0;
+
+    // invalidate cached results before and after the learning, because other sessions can
+    // request the cluster at the same time
+    invalidateClusterResults(m_clusterUuid);
+
+    for(uint64_t i = 0; i < batchSize; i++)
+    {
+        // send input
+        if(sendPrepared(m_learnInput,
+                        &inputValues[i * numberOfInputValuesPerSample],
+                        numberOfInputValuesPerSample,
+                        error) == false)
+        {
+            error.addMeesage("Failed to send input-values of sample " + std::to_string(i));
+            m_broken = true;
+            LOG_ERROR(error);
+            invalidateClusterResults(m_clusterUuid);
+            return false;
+        }
+
+        // send should
+        if(sendPrepared(m_learnShould,
+                        &shouldValues[i * numberOfShouldValuesPerSample],
+                        numberOfShouldValuesPerSample,
+                        error) == false)
+        {
+            error.addMeesage("Failed to send should-values of sample " + std::to_string(i));
+            m_broken = true;
+            LOG_ERROR(error);
+            invalidateClusterResults(m_clusterUuid);
+            return false;
+        }
+
+        numberOfSentFrames += 2;
+
+        // collect responses, which already arrived, to limit the number of pending responses
+        while(numberOfSentFrames - numberOfReceivedResponses > MAX_PENDING_RESPONSES)
+        {
+            if(receiveLearnResponse(numberOfReceivedResponses, error) == false)
+            {
+                m_broken = true;
+                LOG_ERROR(error);
+                invalidateClusterResults(m_clusterUuid);
+                return false;
+            }
+            numberOfReceivedResponses++;
+        }
+    }
+
+    // collect remaining responses of the batch
+    while(numberOfReceivedResponses < numberOfSentFrames)
+    {
+        if(receiveLearnResponse(numberOfReceivedResponses, error) == false)
+        {
+            m_broken = true;
+            LOG_ERROR(error);
+            invalidateClusterResults(m_clusterUuid);
+            return false;
+        }
+        numberOfReceivedResponses++;
+    }
+
+    m_numberOfInputValues = numberOfInputValuesPerSample;
+    m_numberOfOutputValues = numberOfShouldValuesPerSample;
+
+    // results, which were requested by other sessions while learning, can be cached with the
+    // generation of the start of the learning, so they have to be invalidated again
+    invalidateClusterResults(m_clusterUuid);
+
+    return true;
+}
+
+/**
+ * @brief request multiple inputs with one call. The inputs are sent back to back and the
+ *        responses are collected while the following inputs are still in flight. If the batch
+ *        fails, responses of the batch can still be pending on the websocket, so the session
+ *        is marked as broken and rejects all following calls.
+ *
+ * @param inputMatrix float-pointer to matrix with input-values in row-major order
+ * @param numberOfRows number of inputs within the matrix
+ * @param numberOfInputColumns number of input-values of each input
+ * @param outputMatrix pointer to preallocated matrix for the output-values in row-major order
+ *                     with numberOfRows x numberOfOutputColumns values
+ * @param numberOfOutputColumns number of output-values of each input
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+DirectSession::requestBatch(const float* inputMatrix,
+                            const uint64_t numberOfRows,
+                            const uint64_t numberOfInputColumns,
+                            float* outputMatrix,
+                            const uint64_t numberOfOutputColumns,
+                            Kitsunemimi::ErrorContainer &error)
+{
+    if(checkSession(error) == false) {
+        return false;
+    }
+
+    uint64_t numberOfReceivedResponses = 0;
+
+    for(uint64_t i = 0; i < numberOfRows; i++)
+    {
+        // send input
+        if(sendPrepared(m_requestInput,
+                        &inputMatrix[i * numberOfInputColumns],
+                        numberOfInputColumns,
+                        error) == false)
+        {
+            error.addMeesage("Failed to send input-values of row " + std::to_string(i));
+            m_broken = true;
+            LOG_ERROR(error);
+            return false;
+        }
+
+        // collect responses, which already arrived, to limit the number of pending responses
+        while(i + 1 - numberOfReceivedResponses > MAX_PENDING_RESPONSES)
+        {
+            if(receiveRequestResponse(&outputMatrix[numberOfReceivedResponses
+                                                    * numberOfOutputColumns],
+                                      numberOfOutputColumns,
+                                      error) == false)
+            {
+                m_broken = true;
+                LOG_ERROR(error);
+                return false;
+            }
+            numberOfReceivedResponses++;
+        }
+    }
+
+    // collect remaining responses of the batch
+    while(numberOfReceivedResponses < numberOfRows)
+    {
+        if(receiveRequestResponse(&outputMatrix[numberOfReceivedResponses * numberOfOutputColumns],
+                                  numberOfOutputColumns,
+                                  error) == false)
+        {
+            m_broken = true;
+            LOG_ERROR(error);
+            return false;
+        }
+        numberOfReceivedResponses++;
+    }
+
+    m_numberOfInputValues = numberOfInputColumns;
+
+    return true;
+}
+
+} // namespace HanamiAI
@@ -0,0 +1,402 @@
+/**
+ * @file        ensemble.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libHanamiAiSdk/ensemble.h>
+#include <libHanamiAiSdk/direct_session.h>
+#include <libHanamiAiSdk/prepared_request.h>
+#include <common/cpu_features.h>
+
+#include <string.h>
+#include <thread>
+
+namespace HanamiAI
+{
+
+//==================================================================================================
+// reduction
+//==================================================================================================
+
+#ifdef HANAMI_X86_SIMD
+
+HANAMI_TARGET_AVX2 uint64_t
+sumRowsAvx2(float* result,
+            const float* outputMatrix,
+            const uint64_t numberOfMembers,
+            const uint64_t numberOfOutputValues)
+{
+    uint64_t i = 0;
+    for(; i + 8 <= numberOfOutputValues; i += 8)
+    {
+        __m256 sum = _mm256_loadu_ps(&outputMatrix[i]);
+        for(uint64_t m = 1; m < numberOfMembers; m++) {
+            sum = _mm256_add_ps(sum, _mm256_loadu_ps(&outputMatrix[m * numberOfOutputValues + i]));
+        }
+        _mm256_storeu_ps(&result[i], sum);
+    }
+    return i;
+}
+
+HANAMI_TARGET_AVX2 uint64_t
+maxRowsAvx2(float* result,
+            const float* outputMatrix,
+            const uint64_t numberOfMembers,
+            const uint64_t numberOfOutputValues)
+{
+    uint64_t i = 0;
+    for(; i + 8 <= numberOfOutputValues; i += 8)
+    {
+        __m256 max = _mm256_loadu_ps(&outputMatrix[i]);
+        for(uint64_t m = 1; m < numberOfMembers; m++)
+        {
+            const __m256 row = _mm256_loadu_ps(&outputMatrix[m * numberOfOutputValues + i]);
+            max = _mm256_max_ps(row, max);
+        }
+        _mm256_storeu_ps(&result[i], max);
+    }
+    return i;
+}
+
+#endif
+
+/**
+ * @brief reduce the outputs of all members of an ensemble to a single output
+ *
+ * @param outputMatrix matrix with one row of output-values for each member
+ * @param numberOfMembers number of rows of the matrix
+ * @param numberOfOutputValues number of output-values of each member
+ * @param reduction type of the reduction
+ * @param result pointer to the buffer for the reduced output-values
+ */
+void
+reduceEnsembleOutput(const float* outputMatrix,
+                     const uint64_t numberOfMembers,
+                     const uint64_t numberOfOutputValues,
+                     const EnsembleReduction reduction,
+                     float* result)
+{
+    if(numberOfMembers == 0 || numberOfOutputValues == 0) {
+        return;
+    }
+
+    if(reduction == VOTE_REDUCTION)
+    {
+        // each member votes for the position of its highest output-value
+        memset(result, 0, numberOfOutputValues * sizeof(float));
+        const float weight = 1.0f / static_cast<float>(numberOfMembers);
+        for(uint64_t m = 0; m < numberOfMembers; m++)
+        {
+            const float* row = &outputMatrix[m * numberOfOutputValues];
+            uint64_t best = 0;
+            for(uint64_t i = 1; i < numberOfOutputValues; i++)
+            {
+                if(row[i] > row[best]) {
+                    best = i;
+                }
+            }
+            result[best] += weight;
+        }
+        return;
+    }
+
+    uint64_t i = 0;
+    if(reduction == MEAN_REDUCTION)
+    {
+#ifdef HANAMI_X86_SIMD
+        if(hasAvx2()) {
+            i = sumRowsAvx2(result, outputMatrix, numberOfMembers, numberOfOutputValues);
+        }
+#endif
+        for(; i < numberOfOutputValues; i++)
+        {
+            float sum = outputMatrix[i];
+            for(uint64_t m = 1; m < numberOfMembers; m++) {
+                sum += outputMatrix[m * numberOfOutputValues + i];
+            }
+            result[i] = sum;
+        }
+
+        const float factor = 1.0f / static_cast<float>(numberOfMembers);
+        for(i = 0; i < numberOfOutputValues; i++) {
+            result[i] *= factor;
+        }
+    }
+    else if(reduction == MAX_REDUCTION)
+    {
+#ifdef HANAMI_X86_SIMD
+        if(hasAvx2()) {
+            i = maxRowsAvx2(result, outputMatrix, numberOfMembers, numberOfOutputValues);
+        }
+#endif
+        for(; i < numberOfOutputValues; i++)
+        {
+            float max = outputMatrix[i];
+            for(uint64_t m = 1; m < numberOfMembers; m++)
+            {
+                const float value = outputMatrix[m * numberOfOutputValues + i];
+                max = value > max ? value : max;
+            }
+            result[i] = max;
+        }
+    }
+}
+
+//==================================================================================================
+// worker
+//==================================================================================================
+
+/**
+ * @brief worker, which sends the input of each call of the ensemble over one session
+ */
+struct EnsembleWorker
+{
+    Ensemble* ensemble = nullptr;
+    DirectSession* session = nullptr;
+    uint64_t memberId = 0;
+    PreparedRequest prepared {REQUEST_INPUT_PREPARED, "input"};
+    std::thread thread;
+
+    bool success = false;
+    Kitsunemimi::ErrorContainer error;
+
+    void run();
+};
+
+/**
+ * @brief loop of the worker-thread
+ */
+void
+EnsembleWorker::run()
+{
+    uint64_t lastGeneration = 0;
+    const uint64_t numberOfOutputValues = ensemble->m_numberOfOutputValues;
+
+    while(true)
+    {
+        const float* inputValues = nullptr;
+        uint64_t numberOfInputValues = 0;
+        float* outputRow = nullptr;
+
+        // wait for the next call
+        {
+            std::unique_lock<std::mutex> lock(ensemble->m_stateLock);
+            ensemble->m_startCv.wait(lock, [&] {
+                return ensemble->m_abort || ensemble->m_generation != lastGeneration;
+            });
+            if(ensemble->m_abort) {
+                return;
+            }
+
+            lastGeneration = ensemble->m_generation;
+            inputValues = ensemble->m_inputValues;
+            numberOfInputValues = ensemble->m_numberOfInputValues;
+            outputRow = &ensemble->m_outputMatrix[memberId * numberOfOutputValues];
+        }
+
+        error = Kitsunemimi::ErrorContainer();
+        success = session->request(prepared,
+                                   inputValues,
+                                   numberOfInputValues,
+                                   outputRow,
+                                   numberOfOutputValues,
+                                   error);
+
+        // the last finished worker wakes up the caller
+        std::lock_guard<std::mutex> guard(ensemble->m_stateLock);
+        ensemble->m_numberOfPendingWorkers--;
+        if(ensemble->m_numberOfPendingWorkers == 0) {
+            ensemble->m_doneCv.notify_one();
+        }
+    }
+}
+
+//==================================================================================================
+// ensemble
+//==================================================================================================
+
+/**
+ * @brief constructor
+ *
+ * @param sessions direct-io-sessions of all members of the ensemble. Each session is only used
+ *                 by the worker-thread of the ensemble afterwards and is not owned by it.
+ * @param numberOfOutputValues number of output-values of each member
+ */
+Ensemble::Ensemble(const std::vector<DirectSession*> &sessions,
+                   const uint64_t numberOfOutputValues)
+{
+    m_numberOfOutputValues = numberOfOutputValues;
+    m_reductionBuffer.resize(sessions.size() * numberOfOutputValues);
+
+    for(uint64_t i = 0; i < sessions.size(); i++)
+    {
+        EnsembleWorker* worker = new EnsembleWorker();
+        worker->ensemble = this;
+        worker->session = sessions.at(i);
+        worker->memberId = i;
+        worker->thread = std::thread(&EnsembleWorker::run, worker);
+
+        m_workers.push_back(worker);
+    }
+}
+
+/**
+ * @brief destructor
+ */
+Ensemble::~Ensemble()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_stateLock);
+        m_abort = true;
+        m_startCv.notify_all();
+    }
+
+    for(EnsembleWorker* worker : m_workers)
+    {
+        worker->thread.join();
+        delete worker;
+    }
+}
+
+/**
+ * @brief get number of members of the ensemble
+ */
+uint64_t
+Ensemble::getNumberOfMembers() const
+{
+    return m_workers.size();
+}
+
+/**
+ * @brief get number of output-values of each member
+ */
+uint64_t
+Ensemble::getNumberOfOutputValues() const
+{
+    return m_numberOfOutputValues;
+}
+
+/**
+ * @brief start all workers with the input and wait until the slowest one is finished. The
+ *        request-lock must be held by the caller.
+ *
+ * @return true, if successful for all members, else false
+ */
+bool
+Ensemble::runMembers(const float* inputValues,
+                     const uint64_t numberOfInputValues,
+                     float* outputMatrix,
+                     Kitsunemimi::ErrorContainer &error)
+{
+    if(m_workers.size() == 0)
+    {
+        error.addMeesage("Ensemble has no members");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // start all workers and wait until the slowest one is finished
+    {
+        std::unique_lock<std::mutex> lock(m_stateLock);
+        m_inputValues = inputValues;
+        m_numberOfInputValues = numberOfInputValues;
+        m_outputMatrix = outputMatrix;
+        m_numberOfPendingWorkers = m_workers.size();
+        m_generation++;
+        m_startCv.notify_all();
+
+        m_doneCv.wait(lock, [this] { return m_numberOfPendingWorkers == 0; });
+    }
+
+    bool result = true;
+    for(EnsembleWorker* worker : m_workers)
+    {
+        if(worker->success == false)
+        {
+            error.addMeesage(worker->error.toString());
+            error.addMeesage("Request failed for member "
+                             + std::to_string(worker->memberId)
+                             + " of the ensemble");
+            result = false;
+        }
+    }
+
+    if(result == false) {
+        LOG_ERROR(error);
+    }
+
+    return result;
+}
+
+/**
+ * @brief send an input to all members at the same time and collect all outputs
+ *
+ * @param inputValues pointer to the input-values
+ * @param numberOfInputValues number of input-values
+ * @param outputMatrix pointer to buffer for the output-matrix, which gets one row with
+ *                     the output-values of each member in the order of the sessions
+ * @param error reference for error-output
+ *
+ * @return true, if successful for all members, else false
+ */
+bool
+Ensemble::request(const float* inputValues,
+                  const uint64_t numberOfInputValues,
+                  float* outputMatrix,
+                  Kitsunemimi::ErrorContainer &error)
+{
+    std::lock_guard<std::mutex> requestGuard(m_requestLock);
+    return runMembers(inputValues, numberOfInputValues, outputMatrix, error);
+}
+
+/**
+ * @brief send an input to all members at the same time and reduce all outputs to one
+ *
+ * @param inputValues pointer to the input-values
+ * @param numberOfInputValues number of input-values
+ * @param reduction type of the reduction of the outputs of all members
+ * @param result pointer to buffer for the reduced output-values
+ * @param error reference for error-output
+ *
+ * @return true, if successful for all members, else false
+ */
+bool
+Ensemble::request(const float* inputValues,
+                  const uint64_t numberOfInputValues,
+                  const EnsembleReduction reduction,
+                  float* result,
+                  Kitsunemimi::ErrorContainer &error)
+{
+    std::lock_guard<std::mutex> requestGuard(m_requestLock);
+
+    if(runMembers(inputValues, numberOfInputValues, m_reductionBuffer.data(), error) == false) {
+        return false;
+    }
+
+    reduceEnsembleOutput(m_reductionBuffer.data(),
+                         m_workers.size(),
+                         m_numberOfOutputValues,
+                         reduction,
+                         result);
+
+    return true;
+}
+
+} // namespace HanamiAI
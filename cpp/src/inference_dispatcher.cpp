@@ -0,0 +1,489 @@
+/**
+ * @file        inference_dispatcher.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libHanamiAiSdk/inference_dispatcher.h>
+#include <libHanamiAiSdk/direct_session.h>
+#include <common/mpsc_queue.h>
+
+#include <string.h>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+namespace HanamiAI
+{
+
+/**
+ * @brief single request of a calling thread, which lives on the stack of the caller until the
+ *        request was processed by a worker
+ */
+struct DispatchRequest : MpscNode
+{
+    const float* inputValues = nullptr;
+    float* outputValues = nullptr;
+
+    bool finished = false;
+    bool success = false;
+    // true, if the request failed, because the session of the worker is broken, so it can be
+    // given to another worker
+    bool sessionBroken = false;
+    std::string errorMessage = "";
+    std::mutex mutex;
+    std::condition_variable cv;
+};
+
+/**
+ * @brief mark a request as finished and wake up the waiting caller
+ *
+ * @param request request to finish
+ * @param success true, if the output-values of the request are valid
+ * @param errorMessage message of the error, if not successful
+ * @param sessionBroken true, if the request failed, because the session is broken
+ */
+void
+finishRequest(DispatchRequest* request,
+              const bool success,
+              const std::string &errorMessage = "",
+              const bool sessionBroken = false)
+{
+    // notify while holding the lock, because the caller destroys the request as soon as
+    // it can acquire the lock again
+    std::lock_guard<std::mutex> guard(request->mutex);
+    request->success = success;
+    request->errorMessage = errorMessage;
+    request->sessionBroken = sessionBroken;
+    request->finished = true;
+    request->cv.notify_one();
+}
+
+/**
+ * @brief worker, which collects the requests for one session and sends them as bursts
+ */
+struct DispatchWorker
+{
+    DirectSession* session = nullptr;
+    MpscQueue queue;
+    std::thread thread;
+    std::atomic<bool> abort {false};
+
+    // set by the worker-thread, when its session is broken, so the callers can skip the
+    // worker without touching the session itself
+    std::atomic<bool> broken {false};
+
+    // number of requests, which were given to the worker and are not finished yet
+    std::atomic<uint64_t> numberOfPendingRequests {0};
+
+    // the worker sleeps on the condition-variable while the queue is empty and the producers
+    // only lock the mutex to wake it up, when the sleeping-flag is set
+    std::mutex waitMutex;
+    std::condition_variable waitCondition;
+    std::atomic<bool> sleeping {false};
+
+    uint64_t numberOfInputValues = 0;
+    uint64_t numberOfOutputValues = 0;
+    uint64_t maxBurstSize = 0;
+    std::chrono::microseconds maxDelay;
+
+    // buffers of the worker, which are reused for all bursts
+    std::vector<DispatchRequest*> burst;
+    std::vector<float> inputMatrix;
+    std::vector<float> outputMatrix;
+
+    void addRequest(DispatchRequest* request);
+    void wakeUp();
+    bool waitForRequests(const std::chrono::steady_clock::time_point* deadline);
+
+    void run();
+    bool collectBurst();
+    void processBurst();
+    void failRemainingRequests();
+};
+
+/**
+ * @brief add a new request to the queue of the worker (can be called by any thread)
+ *
+ * @param request request to add
+ */
+void
+DispatchWorker::addRequest(DispatchRequest* request)
+{
+    queue.push(request);
+
+    // pairs with the fence in waitForRequests, so either the worker sees the new request in
+    // the queue or this thread sees the sleeping-flag of the worker
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(sleeping.load(std::memory_order_relaxed)) {
+        wakeUp();
+    }
+}
+
+/**
+ * @brief wake up the worker-thread, if it waits for new requests
+ */
+void
+DispatchWorker::wakeUp()
+{
+    std::lock_guard<std::mutex> guard(waitMutex);
+    waitCondition.notify_one();
+}
+
+/**
+ * @brief block until the queue contains a request or the worker should be stopped
+ *
+ * @param deadline point in time, where the waiting should be stopped at latest, or nullptr
+ *                 to wait without timeout
+ *
+ * @return false, if the deadline was reached or the worker should be stopped, else true
+ */
+bool
+DispatchWorker::waitForRequests(const std::chrono::steady_clock::time_point* deadline)
+{
+    std::unique_lock<std::mutex> lock(waitMutex);
+
+    sleeping.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    bool result = true;
+    while(queue.isEmpty())
+    {
+        if(abort.load(std::memory_order_relaxed))
+        {
+            result = false;
+            break;
+        }
+
+        if(deadline == nullptr)
+        {
+            waitCondition.wait(lock);
+        }
+        else if(waitCondition.wait_until(lock, *deadline) == std::cv_status::timeout)
+        {
+            result = queue.isEmpty() == false;
+            break;
+        }
+    }
+
+    sleeping.store(false, std::memory_order_relaxed);
+
+    return result;
+}
+
+/**
+ * @brief collect requests from the queue until the burst is full or the first request of
+ *        the burst waited for the maximum delay
+ *
+ * @return false, if no request is in the queue, else true
+ */
+bool
+DispatchWorker::collectBurst()
+{
+    burst.clear();
+
+    DispatchRequest* request = static_cast<DispatchRequest*>(queue.pop());
+    if(request == nullptr) {
+        return false;
+    }
+    burst.push_back(request);
+
+    const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now()
+                                                           + maxDelay;
+    while(burst.size() < maxBurstSize)
+    {
+        request = static_cast<DispatchRequest*>(queue.pop());
+        if(request != nullptr)
+        {
+            burst.push_back(request);
+            continue;
+        }
+
+        // a producer is in the middle of a push, so its request is available in a moment
+        if(queue.isEmpty() == false)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        if(waitForRequests(&deadline) == false) {
+            break;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief send all requests of the current burst pipelined over the session and give the
+ *        results back to the callers
+ */
+void
+DispatchWorker::processBurst()
+{
+    const uint64_t numberOfRows = burst.size();
+
+    // requests, which were queued before the session broke, can not be processed anymore
+    if(broken.load(std::memory_order_relaxed))
+    {
+        for(uint64_t i = 0; i < numberOfRows; i++) {
+            finishRequest(burst[i], false, "Session of the inference-dispatcher is broken", true);
+        }
+        numberOfPendingRequests.fetch_sub(numberOfRows, std::memory_order_acq_rel);
+        return;
+    }
+
+    for(uint64_t i = 0; i < numberOfRows; i++)
+    {
+        memcpy(&inputMatrix[i * numberOfInputValues],
+               burst[i]->inputValues,
+               numberOfInputValues * sizeof(float));
+    }
+
+    Kitsunemimi::ErrorContainer error;
+    const bool success = session->requestBatch(&inputMatrix[0],
+                                               numberOfRows,
+                                               numberOfInputValues,
+                                               &outputMatrix[0],
+                                               numberOfOutputValues,
+                                               error);
+
+    std::string errorMessage = "";
+    if(success == false)
+    {
+        errorMessage = error.toString();
+        if(session->isBroken()) {
+            broken.store(true, std::memory_order_relaxed);
+        }
+    }
+    const bool sessionBroken = broken.load(std::memory_order_relaxed);
+
+    for(uint64_t i = 0; i < numberOfRows; i++)
+    {
+        if(success)
+        {
+            memcpy(burst[i]->outputValues,
+                   &outputMatrix[i * numberOfOutputValues],
+                   numberOfOutputValues * sizeof(float));
+        }
+        finishRequest(burst[i], success, errorMessage, sessionBroken);
+    }
+
+    numberOfPendingRequests.fetch_sub(numberOfRows, std::memory_order_acq_rel);
+}
+
+/**
+ * @brief fail all requests, which are still in the queue or are currently added by other
+ *        threads, when the worker is stopped
+ */
+void
+DispatchWorker::failRemainingRequests()
+{
+    while(numberOfPendingRequests.load(std::memory_order_acquire) > 0)
+    {
+        DispatchRequest* request = static_cast<DispatchRequest*>(queue.pop());
+        if(request == nullptr)
+        {
+            // a producer is in the middle of a push
+            std::this_thread::yield();
+            continue;
+        }
+
+        finishRequest(request, false, "Inference-dispatcher was closed");
+        numberOfPendingRequests.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+/**
+ * @brief loop of the worker-thread
+ */
+void
+DispatchWorker::run()
+{
+    while(abort.load(std::memory_order_relaxed) == false)
+    {
+        if(collectBurst())
+        {
+            processBurst();
+            continue;
+        }
+
+        // block until new requests are in the queue
+        waitForRequests(nullptr);
+    }
+
+    failRemainingRequests();
+}
+
+/**
+ * @brief constructor
+ *
+ * @param sessions direct-io-sessions, which should be shared. Each session is only used by
+ *                 the worker-thread of the dispatcher afterwards and is not owned by it.
+ * @param numberOfInputValues number of input-values of each request
+ * @param numberOfOutputValues number of output-values of each request
+ * @param maxBurstSize maximum number of requests, which are send together
+ * @param maxDelayUs maximum time in microseconds, which a request waits for other requests
+ *                   to fill the burst
+ */
+InferenceDispatcher::InferenceDispatcher(const std::vector<DirectSession*> &sessions,
+                                         const uint64_t numberOfInputValues,
+                                         const uint64_t numberOfOutputValues,
+                                         const uint64_t maxBurstSize,
+                                         const uint64_t maxDelayUs)
+{
+    const uint64_t burstSize = std::max(maxBurstSize, static_cast<uint64_t>(1));
+
+    for(DirectSession* session : sessions)
+    {
+        DispatchWorker* worker = new DispatchWorker();
+        worker->session = session;
+        worker->broken = session->isBroken();
+        worker->numberOfInputValues = numberOfInputValues;
+        worker->numberOfOutputValues = numberOfOutputValues;
+        worker->maxBurstSize = burstSize;
+        worker->maxDelay = std::chrono::microseconds(maxDelayUs);
+        worker->burst.reserve(burstSize);
+        worker->inputMatrix.resize(burstSize * numberOfInputValues);
+        worker->outputMatrix.resize(burstSize * numberOfOutputValues);
+        worker->thread = std::thread(&DispatchWorker::run, worker);
+
+        m_workers.push_back(worker);
+    }
+}
+
+/**
+ * @brief destructor
+ */
+InferenceDispatcher::~InferenceDispatcher()
+{
+    // reject new requests, before the workers fail the remaining ones
+    m_closed.store(true, std::memory_order_seq_cst);
+
+    for(DispatchWorker* worker : m_workers)
+    {
+        worker->abort = true;
+        worker->wakeUp();
+    }
+
+    for(DispatchWorker* worker : m_workers)
+    {
+        worker->thread.join();
+        delete worker;
+    }
+}
+
+/**
+ * @brief get the next worker in round-robin order, whose session is not broken
+ *
+ * @return nullptr, if the sessions of all workers are broken, else the selected worker
+ */
+DispatchWorker*
+InferenceDispatcher::getHealthyWorker()
+{
+    const uint64_t startId = m_nextWorker.fetch_add(1, std::memory_order_relaxed);
+
+    for(uint64_t i = 0; i < m_workers.size(); i++)
+    {
+        DispatchWorker* worker = m_workers[(startId + i) % m_workers.size()];
+        if(worker->broken.load(std::memory_order_relaxed) == false) {
+            return worker;
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief request a single input. Can be called by any number of threads at the same time and
+ *        blocks until the burst, which contains the request, was processed.
+ *
+ * @param inputValues pointer to the input-values
+ * @param outputValues pointer to the buffer for the output-values
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+InferenceDispatcher::request(const float* inputValues,
+                             float* outputValues,
+                             Kitsunemimi::ErrorContainer &error)
+{
+    if(m_workers.size() == 0)
+    {
+        error.addMeesage("Inference-dispatcher has no sessions");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    DispatchRequest request;
+    request.inputValues = inputValues;
+    request.outputValues = outputValues;
+
+    // a request, which failed because of a broken session, is given to the next worker, so
+    // each worker is tried at most once
+    for(uint64_t attempt = 0; attempt < m_workers.size(); attempt++)
+    {
+        // distribute the requests equally over all sessions, which are not broken
+        DispatchWorker* worker = getHealthyWorker();
+        if(worker == nullptr)
+        {
+            error.addMeesage("All sessions of the inference-dispatcher are broken");
+            LOG_ERROR(error);
+            return false;
+        }
+
+        // register the request before the check, so a worker, which is stopped in the
+        // meantime, waits for the request and fails it
+        worker->numberOfPendingRequests.fetch_add(1, std::memory_order_seq_cst);
+        if(m_closed.load(std::memory_order_seq_cst))
+        {
+            worker->numberOfPendingRequests.fetch_sub(1, std::memory_order_acq_rel);
+            error.addMeesage("Inference-dispatcher is already closed");
+            LOG_ERROR(error);
+            return false;
+        }
+
+        request.finished = false;
+        worker->addRequest(&request);
+
+        std::unique_lock<std::mutex> lock(request.mutex);
+        request.cv.wait(lock, [&request] { return request.finished; });
+
+        if(request.success) {
+            return true;
+        }
+
+        if(request.sessionBroken == false) {
+            break;
+        }
+    }
+
+    if(request.errorMessage != "") {
+        error.addMeesage(request.errorMessage);
+    }
+    error.addMeesage("Failed to process request within the inference-dispatcher");
+    LOG_ERROR(error);
+
+    return false;
+}
+
+} // namespace HanamiAI
@@ -21,10 +21,7 @@
  */
 
 #include <libHanamiAiSdk/io.h>
-
-#include <libHanamiAiSdk/common/websocket_client.h>
-
-#include <../../libKitsunemimiHanamiMessages/protobuffers/kyouko_messages.proto3.pb.h>
+#include <libHanamiAiSdk/direct_session.h>
 
 namespace HanamiAI
 {
@@ -32,7 +29,7 @@ namespace HanamiAI
 /**
  * @brief learn single value
  *
- * @param wsClient pointer to websocket-client for data-transfer
+ * @param session pointer to direct-session for data-transfer
  * @param inputValues vector with all input-values
  * @param shouldValues vector with all should-values
  * @param error reference for error-output
@@ -40,46 +37,38 @@ namespace HanamiAI
  * @return true, if successful, else false
  */
 bool
-learn(WebsocketClient* wsClient,
+learn(DirectSession* session,
       std::vector<float> &inputValues,
       std::vector<float> &shouldValues,
       Kitsunemimi::ErrorContainer &error)
 {
-    return learn(wsClient,
-                 &inputValues[0],
-                 inputValues.size(),
-                 &shouldValues[0],
-                 shouldValues.size(),
-                 error);
+    return session->learn(inputValues, shouldValues, error);
 }
 
 /**
  * @brief request single value
  *
- * @param wsClient pointer to websocket-client for data-transfer
+ * @param session pointer to direct-session for data-transfer
  * @param inputValues vector with all input-values
  * @param numberOfOutputValues reference for returning number of output-values
  * @param error reference for error-output
  *
- * @return true, if successful, else false
+ * @return nullptr, if failed, else array with the output-values, which has to be deleted
+ *         by the caller
  */
 float*
-request(WebsocketClient* wsClient,
+request(DirectSession* session,
         std::vector<float> &inputValues,
         uint64_t &numberOfOutputValues,
         Kitsunemimi::ErrorContainer &error)
 {
-    return request(wsClient,
-                   &inputValues[0],
-                   inputValues.size(),
-                   numberOfOutputValues,
-                   error);
+    return session->request(inputValues, numberOfOutputValues, error);
 }
 
 /**
  * @brief learn single value
  *
- * @param wsClient pointer to websocket-client for data-transfer
+ * @param session pointer to direct-session for data-transfer
  * @param inputValues float-pointer to array with input-values for input-segment
  * @param numberOfInputValues number of input-values for input-segment
  * @param shouldValues float-pointer to array with should-values for output-segment
@@ -89,193 +78,136 @@ request(WebsocketClient* wsClient,
  * @return true, if successful, else false
  */
 bool
-learn(WebsocketClient* wsClient,
-      float* inputValues,
+learn(DirectSession* session,
+      const float* inputValues,
       const uint64_t numberOfInputValues,
-      float* shouldValues,
+      const float* shouldValues,
       const uint64_t numberOfShouldValues,
       Kitsunemimi::ErrorContainer &error)
 {
-    uint8_t buffer[96*1024];
-
-    // build input-message
-    ClusterIO_Message inputMsg;
-    inputMsg.set_segmentname("input");
-    inputMsg.set_islast(false);
-    inputMsg.set_processtype(ClusterProcessType::LEARN_TYPE);
-    inputMsg.set_datatype(ClusterDataType::INPUT_TYPE);
-    inputMsg.set_numberofvalues(numberOfInputValues);
-
-    for(uint64_t i = 0; i < numberOfInputValues; i++) {
-        inputMsg.add_values(inputValues[i]);
-    }
-
-    // add input-values to message
-    const uint64_t inputMsgSize = inputMsg.ByteSizeLong();
-    if(inputMsg.SerializeToArray(buffer, inputMsgSize) == false)
-    {
-        Kitsunemimi::ErrorContainer error;
-        error.addMeesage("Failed to serialize learn-message");
-        return false;
-    }
-
-    // send input
-    if(wsClient->sendMessage(buffer, inputMsgSize, error) == false)
-    {
-        error.addMeesage("Failed to send input-values");
-        LOG_ERROR(error);
-        return false;
-    }
-
-    // receive bogus-response, which is not further processed and exist only because of issue:
-    //     https://github.com/kitsudaiki/KyoukoMind/issues/27
-    uint64_t numberOfBytes = 0;
-    uint8_t* recvData = wsClient->readMessage(numberOfBytes, error);
-    if(recvData == nullptr
-            || numberOfBytes == 0)
-    {
-        error.addMeesage("Got no valid response");
-        LOG_ERROR(error);
-        return false;
-    }
-    delete[] recvData;
-
-    // build should-message
-    ClusterIO_Message shouldMsg;
-    shouldMsg.set_segmentname("output");
-    shouldMsg.set_islast(true);
-    shouldMsg.set_processtype(ClusterProcessType::LEARN_TYPE);
-    shouldMsg.set_datatype(ClusterDataType::SHOULD_TYPE);
-    shouldMsg.set_numberofvalues(numberOfShouldValues);
-
-    for(uint64_t i = 0; i < numberOfShouldValues; i++) {
-        shouldMsg.add_values(shouldValues[i]);
-    }
-
-    // add should-values to message
-    const uint64_t shouldMsgSize = shouldMsg.ByteSizeLong();
-    if(shouldMsg.SerializeToArray(buffer, shouldMsgSize) == false)
-    {
-        Kitsunemimi::ErrorContainer error;
-        error.addMeesage("Failed to serialize learn-message");
-        return false;
-    }
-
-    // send should
-    if(wsClient->sendMessage(buffer, shouldMsgSize, error) == false)
-    {
-        error.addMeesage("Failed to send should-values");
-        LOG_ERROR(error);
-        return false;
-    }
-
-    // receive response
-    numberOfBytes = 0;
-    recvData = wsClient->readMessage(numberOfBytes, error);
-    if(recvData == nullptr
-            || numberOfBytes == 0)
-    {
-        error.addMeesage("Got no valid response");
-        LOG_ERROR(error);
-        return false;
-    }
-
-    // check end-message
-    bool success = true;
-    ClusterIO_Message response;
-    if(response.ParseFromArray(recvData, numberOfBytes) == false)
-    {
-        success = false;
-        error.addMeesage("Got no valid learn-end-message");
-        LOG_ERROR(error);
-    }
-
-    delete[] recvData;
-
-    return success;
+    return session->learn(inputValues,
+                          numberOfInputValues,
+                          shouldValues,
+                          numberOfShouldValues,
+                          error);
 }
 
 /**
  * @brief request single value
  *
- * @param wsClient pointer to websocket-client for data-transfer
+ * @param session pointer to direct-session for data-transfer
  * @param inputValues float-pointer to array with input-values for input-segment
  * @param numberOfInputValues number of input-values for input-segment
  * @param numberOfOutputValues reference for returning number of output-values
  * @param error reference for error-output
  *
- * @return true, if successful, else false
+ * @return nullptr, if failed, else array with the output-values, which has to be deleted
+ *         by the caller
  */
 float*
-request(WebsocketClient* wsClient,
-        float* inputData,
+request(DirectSession* session,
+        const float* inputData,
         const uint64_t numberOfInputValues,
         uint64_t &numberOfOutputValues,
         Kitsunemimi::ErrorContainer &error)
 {
-    uint8_t buffer[96*1024];
-
-    // build message
-    ClusterIO_Message inputMsg;
-    inputMsg.set_segmentname("input");
-    inputMsg.set_islast(true);
-    inputMsg.set_processtype(ClusterProcessType::REQUEST_TYPE);
-    inputMsg.set_datatype(ClusterDataType::INPUT_TYPE);
-    inputMsg.set_numberofvalues(numberOfInputValues);
-
-    for(uint64_t i = 0; i < numberOfInputValues; i++) {
-        inputMsg.add_values(inputData[i]);
-    }
-
-    // add input-values to message
-    const uint64_t inputMsgSize = inputMsg.ByteSizeLong();
-    if(inputMsg.SerializeToArray(buffer, inputMsgSize) == false)
-    {
-        Kitsunemimi::ErrorContainer error;
-        error.addMeesage("Failed to serialize request-message");
-        LOG_ERROR(error);
-        return nullptr;
-    }
-
-    // send message
-    if(wsClient->sendMessage(buffer, inputMsgSize, error) == false)
-    {
-        error.addMeesage("Failed to send input-values");
-        LOG_ERROR(error);
-        return nullptr;
-    }
-
-    // receive response
-    uint64_t numberOfBytes = 0;
-    uint8_t* recvData = wsClient->readMessage(numberOfBytes, error);
-    if(recvData == nullptr
-            || numberOfBytes == 0)
-    {
-        error.addMeesage("Got no valid request response");
-        LOG_ERROR(error);
-        return nullptr;
-    }
+    return session->request(inputData, numberOfInputValues, numberOfOutputValues, error);
+}
 
-    // read message from response
-    ClusterIO_Message response;
-    if(response.ParseFromArray(recvData, numberOfBytes) == false)
+/**
+ * @brief learn multiple samples with one call
+ *
+ * @param session pointer to direct-session for data-transfer
+ * @param inputValues vector with the input-values of all samples in row-major order
+ * @param shouldValues vector with the should-values of all samples in row-major order
+ * @param batchSize number of samples
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+learnBatch(DirectSession* session,
+           std::vector<float> &inputValues,
+           std::vector<float> &shouldValues,
+           const uint64_t batchSize,
+           Kitsunemimi::ErrorContainer &error)
+{
+    if(batchSize == 0
+            || inputValues.size() % batchSize != 0
+            || shouldValues.size() % batchSize != 0)
     {
-        delete[] recvData;
-        error.addMeesage("Got no valid request response");
+        error.addMeesage("Size of input- or should-values doesn't match the batch-size");
         LOG_ERROR(error);
-        return nullptr;
+        return false;
     }
 
-    // convert output
-    numberOfOutputValues = response.values_size();
-    float* result = new float[numberOfOutputValues];
-    for(uint64_t i = 0; i < numberOfOutputValues; i++) {
-        result[i] = response.values(i);
-    }
+    return session->learnBatch(&inputValues[0],
+                               inputValues.size() / batchSize,
+                               &shouldValues[0],
+                               shouldValues.size() / batchSize,
+                               batchSize,
+                               error);
+}
 
-    delete[] recvData;
+/**
+ * @brief learn multiple samples with one call
+ *
+ * @param session pointer to direct-session for data-transfer
+ * @param inputValues float-pointer to matrix with input-values in row-major order
+ * @param numberOfInputValuesPerSample number of input-values of each sample
+ * @param shouldValues float-pointer to matrix with should-values in row-major order
+ * @param numberOfShouldValuesPerSample number of should-values of each sample
+ * @param batchSize number of samples
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+learnBatch(DirectSession* session,
+           const float* inputValues,
+           const uint64_t numberOfInputValuesPerSample,
+           const float* shouldValues,
+           const uint64_t numberOfShouldValuesPerSample,
+           const uint64_t batchSize,
+           Kitsunemimi::ErrorContainer &error)
+{
+    return session->learnBatch(inputValues,
+                               numberOfInputValuesPerSample,
+                               shouldValues,
+                               numberOfShouldValuesPerSample,
+                               batchSize,
+                               error);
+}
 
-    return result;
+/**
+ * @brief request multiple inputs with one call
+ *
+ * @param session pointer to direct-session for data-transfer
+ * @param inputMatrix float-pointer to matrix with input-values in row-major order
+ * @param numberOfRows number of inputs within the matrix
+ * @param numberOfInputColumns number of input-values of each input
+ * @param outputMatrix pointer to preallocated matrix for the output-values in row-major order
+ *                     with numberOfRows x numberOfOutputColumns values
+ * @param numberOfOutputColumns number of output-values of each input
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+requestBatch(DirectSession* session,
+             const float* inputMatrix,
+             const uint64_t numberOfRows,
+             const uint64_t numberOfInputColumns,
+             float* outputMatrix,
+             const uint64_t numberOfOutputColumns,
+             Kitsunemimi::ErrorContainer &error)
+{
+    return session->requestBatch(inputMatrix,
+                                 numberOfRows,
+                                 numberOfInputColumns,
+                                 outputMatrix,
+                                 numberOfOutputColumns,
+                                 error);
 }
 
 } // namespace HanamiAI
@@ -0,0 +1,357 @@
+/**
+ * @file        prepared_request.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libHanamiAiSdk/prepared_request.h>
+#include <common/encoded_values.h>
+
+#include <string.h>
+#include <limits.h>
+
+#include <../../libKitsunemimiHanamiMessages/protobuffers/kyouko_messages.proto3.pb.h>
+
+using google::protobuf::io::CodedOutputStream;
+using google::protobuf::internal::WireFormatLite;
+
+// maximum number of bytes behind the constant fields for the tags, the number of values, the
+// encoding and the length of the values-field: three tags for the number of values, the
+// encoding and the values with at most 5 bytes each (15), the varint of the number of values
+// with at most 10 bytes, the varint of the encoding and the length with at most 5 bytes each
+// (15 + 10 + 5 + 5 = 35)
+#define MAX_VALUE_HEADER_SIZE 35
+
+namespace HanamiAI
+{
+
+/**
+ * @brief check if a payload still fits into a message, which can be parsed by protobuf
+ *
+ * @param headerSize size of the constant fields of the message
+ * @param payloadSize number of bytes of the values
+ *
+ * @return true, if the message would be smaller than 2 GiB, else false
+ */
+inline bool
+isPayloadSizeValid(const uint64_t headerSize,
+                   const uint64_t payloadSize)
+{
+    return payloadSize <= INT_MAX
+           && headerSize + MAX_VALUE_HEADER_SIZE + payloadSize <= INT_MAX;
+}
+
+/**
+ * @brief constructor, which serializes the constant fields of the message
+ *
+ * @param type type of the message
+ * @param segmentName name of the segment of the cluster, which is the target of the message
+ */
+PreparedRequest::PreparedRequest(const PreparedRequestType type,
+                                 const std::string &segmentName)
+{
+    m_type = type;
+    m_segmentName = segmentName;
+
+    ClusterIO_Message header;
+    header.set_segmentname(segmentName);
+    switch(type)
+    {
+        case REQUEST_INPUT_PREPARED:
+            header.set_islast(true);
+            header.set_processtype(ClusterProcessType::REQUEST_TYPE);
+            header.set_datatype(ClusterDataType::INPUT_TYPE);
+            break;
+        case LEARN_INPUT_PREPARED:
+            header.set_islast(false);
+            header.set_processtype(ClusterProcessType::LEARN_TYPE);
+            header.set_datatype(ClusterDataType::INPUT_TYPE);
+            break;
+        case LEARN_SHOULD_PREPARED:
+            header.set_islast(true);
+            header.set_processtype(ClusterProcessType::LEARN_TYPE);
+            header.set_datatype(ClusterDataType::SHOULD_TYPE);
+            break;
+    }
+
+    m_headerSize = header.ByteSizeLong();
+    m_frame.resize(m_headerSize);
+    header.SerializeToArray(&m_frame[0], m_headerSize);
+}
+
+/**
+ * @brief get type of the message
+ */
+PreparedRequestType
+PreparedRequest::getType() const
+{
+    return m_type;
+}
+
+/**
+ * @brief get name of the target-segment
+ */
+const std::string&
+PreparedRequest::getSegmentName() const
+{
+    return m_segmentName;
+}
+
+/**
+ * @brief set encoding of the values. Every encoding other than FP32_ENCODING writes the values
+ *        into additional fields of the message instead of the values-field, which are NOT
+ *        supported by the current version of kyouko. So these encodings must only be used
+ *        with servers, which explicitly support encoded values.
+ *
+ * @param encoding new encoding
+ */
+void
+PreparedRequest::setEncoding(const ValueEncoding encoding)
+{
+    m_encoding = encoding;
+    m_hasValueHeader = false;
+}
+
+/**
+ * @brief enable or disable the sparse-encoding. If enabled, it is checked for each message, if
+ *        the values are smaller as (index, value)-pairs, and otherwise they are send with the
+ *        normal encoding. Like all encodings other than FP32_ENCODING, it is NOT supported by
+ *        the current version of kyouko.
+ *
+ * @param enabled true to enable the sparse-encoding
+ * @param maxDensity maximum ratio of non-zero values for the sparse-encoding
+ */
+void
+PreparedRequest::setSparseEncoding(const bool enabled,
+                                   const float maxDensity)
+{
+    m_sparseEnabled = enabled;
+    m_maxDensity = maxDensity;
+    m_hasValueHeader = false;
+}
+
+/**
+ * @brief enable or disable the delta-encoding, which is used for all following messages. The
+ *        delta-frames depend on all previous messages of this object since the last keyframe,
+ *        so the server has to decode them in the same order. Like all encodings other than
+ *        FP32_ENCODING, it is NOT supported by the current version of kyouko.
+ *
+ * @param enabled true to enable the delta-encoding
+ * @param keyframeInterval maximum number of messages between two keyframes
+ * @param maxShift maximum shift of the values against the previous message
+ */
+void
+PreparedRequest::setDeltaEncoding(const bool enabled,
+                                  const uint32_t keyframeInterval,
+                                  const uint32_t maxShift)
+{
+    m_deltaEnabled = enabled;
+    m_deltaEncoder = DeltaEncoder(keyframeInterval, maxShift);
+    m_hasValueHeader = false;
+}
+
+/**
+ * @brief get encoding of the values
+ */
+ValueEncoding
+PreparedRequest::getEncoding() const
+{
+    return m_encoding;
+}
+
+/**
+ * @brief write values into the frame. Protobuf accepts fields in any order, so the number of
+ *        values and the packed values-field are appended behind the constant fields.
+ *
+ * @param values pointer to the values
+ * @param numberOfValues number of values
+ * @param frameSize reference for returning the size of the frame
+ *
+ * @return pointer to the complete serialized message, which is valid until the next call, or
+ *         nullptr, if the values are too big for a single message
+ */
+const uint8_t*
+PreparedRequest::fill(const float* values,
+                      const uint64_t numberOfValues,
+                      uint64_t &frameSize)
+{
+    // prevents an overflow, when the size of the payload is calculated
+    if(numberOfValues > INT_MAX)
+    {
+        frameSize = 0;
+        return nullptr;
+    }
+
+    if(m_deltaEnabled
+            || m_encoding == DELTA_ENCODING)
+    {
+        // checked before encoding, so the state of the encoder is not changed
+        const uint64_t maxPayloadSize = m_deltaEncoder.getMaxFrameSize(numberOfValues);
+        if(isPayloadSizeValid(m_headerSize, maxPayloadSize) == false)
+        {
+            frameSize = 0;
+            return nullptr;
+        }
+
+        // the encoder chooses between keyframe and delta, so the frame is first written into
+        // a separate buffer to get its size
+        m_deltaFrame.resize(m_deltaEncoder.getMaxFrameSize(numberOfValues));
+        const uint64_t payloadSize = m_deltaEncoder.encode(m_deltaFrame.data(),
+                                                           values,
+                                                           numberOfValues);
+        return fillEncoded(values, numberOfValues, DELTA_ENCODING, payloadSize, frameSize);
+    }
+
+    if(m_sparseEnabled)
+    {
+        uint64_t numberOfNonZeroValues = 0;
+        if(shouldUseSparseEncoding(values, numberOfValues, numberOfNonZeroValues, m_maxDensity))
+        {
+            return fillEncoded(values,
+                               numberOfValues,
+                               SPARSE_ENCODING,
+                               getSparseEncodedSize(numberOfNonZeroValues),
+                               frameSize);
+        }
+    }
+
+    if(m_encoding != FP32_ENCODING)
+    {
+        // explicitly selected sparse-encoding is used for all messages
+        uint64_t payloadSize = getEncodedSize(m_encoding, numberOfValues);
+        if(m_encoding == SPARSE_ENCODING) {
+            payloadSize = getSparseEncodedSize(countNonZeroValues(values, numberOfValues));
+        }
+
+        return fillEncoded(values, numberOfValues, m_encoding, payloadSize, frameSize);
+    }
+
+    const uint64_t payloadSize = numberOfValues * sizeof(float);
+    if(isPayloadSizeValid(m_headerSize, payloadSize) == false)
+    {
+        frameSize = 0;
+        return nullptr;
+    }
+
+    // update the variable header-part only, if the number of values changed
+    if(m_hasValueHeader == false
+            || numberOfValues != m_numberOfValues)
+    {
+        const uint32_t countTag = WireFormatLite::MakeTag(
+                    ClusterIO_Message::kNumberOfValuesFieldNumber,
+                    WireFormatLite::WIRETYPE_VARINT);
+        const uint32_t valuesTag = WireFormatLite::MakeTag(
+                    ClusterIO_Message::kValuesFieldNumber,
+                    WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+
+        // without encoding only the tags of the number of values and the values, the varint
+        // of the number of values and the length are written, which fit into the
+        // MAX_VALUE_HEADER_SIZE bytes for the encoded frames
+        m_frame.resize(m_headerSize + MAX_VALUE_HEADER_SIZE + payloadSize);
+
+        uint8_t* pos = &m_frame[m_headerSize];
+        pos = CodedOutputStream::WriteVarint32ToArray(countTag, pos);
+        pos = CodedOutputStream::WriteVarint64ToArray(numberOfValues, pos);
+        if(numberOfValues > 0)
+        {
+            pos = CodedOutputStream::WriteVarint32ToArray(valuesTag, pos);
+            pos = CodedOutputStream::WriteVarint32ToArray(static_cast<uint32_t>(payloadSize),
+                                                          pos);
+        }
+
+        m_payloadOffset = static_cast<uint64_t>(pos - &m_frame[0]);
+        m_frame.resize(m_payloadOffset + payloadSize);
+        m_numberOfValues = numberOfValues;
+        m_hasValueHeader = true;
+    }
+
+    if(payloadSize > 0) {
+        memcpy(&m_frame[m_payloadOffset], values, payloadSize);
+    }
+
+    frameSize = m_frame.size();
+    return &m_frame[0];
+}
+
+/**
+ * @brief write values with reduced precision into the frame. Behind the number of values the
+ *        encoding and the encoded values are appended as additional fields.
+ *
+ * @param values pointer to the values
+ * @param numberOfValues number of values
+ * @param encoding encoding of the values for this message
+ * @param payloadSize number of bytes of the encoded values
+ * @param frameSize reference for returning the size of the frame
+ *
+ * @return pointer to the complete serialized message, which is valid until the next call, or
+ *         nullptr, if the values are too big for a single message
+ */
+const uint8_t*
+PreparedRequest::fillEncoded(const float* values,
+                             const uint64_t numberOfValues,
+                             const ValueEncoding encoding,
+                             const uint64_t payloadSize,
+                             uint64_t &frameSize)
+{
+    if(isPayloadSizeValid(m_headerSize, payloadSize) == false)
+    {
+        frameSize = 0;
+        return nullptr;
+    }
+
+    const uint32_t countTag = WireFormatLite::MakeTag(
+                ClusterIO_Message::kNumberOfValuesFieldNumber,
+                WireFormatLite::WIRETYPE_VARINT);
+    const uint32_t encodingTag = WireFormatLite::MakeTag(
+                ENCODING_FIELD_NUMBER,
+                WireFormatLite::WIRETYPE_VARINT);
+    const uint32_t valuesTag = WireFormatLite::MakeTag(
+                ENCODED_VALUES_FIELD_NUMBER,
+                WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+
+    // three tags, two varints and a length with at most MAX_VALUE_HEADER_SIZE bytes. The
+    // frame keeps its capacity, so it is only reallocated, when it has to grow.
+    m_frame.resize(m_headerSize + MAX_VALUE_HEADER_SIZE + payloadSize);
+
+    uint8_t* pos = &m_frame[m_headerSize];
+    pos = CodedOutputStream::WriteVarint32ToArray(countTag, pos);
+    pos = CodedOutputStream::WriteVarint64ToArray(numberOfValues, pos);
+    pos = CodedOutputStream::WriteVarint32ToArray(encodingTag, pos);
+    pos = CodedOutputStream::WriteVarint32ToArray(static_cast<uint32_t>(encoding), pos);
+    pos = CodedOutputStream::WriteVarint32ToArray(valuesTag, pos);
+    pos = CodedOutputStream::WriteVarint32ToArray(static_cast<uint32_t>(payloadSize), pos);
+    if(encoding == DELTA_ENCODING)
+    {
+        memcpy(pos, m_deltaFrame.data(), payloadSize);
+        pos += payloadSize;
+    }
+    else
+    {
+        pos += encodeValues(pos, values, numberOfValues, encoding);
+    }
+
+    // the fp32-header has to be written again, when the encoding is switched back
+    m_hasValueHeader = false;
+
+    m_frame.resize(static_cast<uint64_t>(pos - &m_frame[0]));
+    frameSize = m_frame.size();
+    return &m_frame[0];
+}
+
+} // namespace HanamiAI
@@ -0,0 +1,384 @@
+/**
+ * @file        replica_balancer.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libHanamiAiSdk/replica_balancer.h>
+#include <libHanamiAiSdk/direct_session.h>
+#include <libHanamiAiSdk/prepared_request.h>
+
+// weight of a new latency-value within the average latency of a replica
+#define LATENCY_EWMA_ALPHA 0.2
+
+// number of requests of a replica, before its average latency is used for the ejection
+#define MIN_SAMPLES_FOR_EJECTION 16
+
+namespace HanamiAI
+{
+
+/**
+ * @brief single replica of the balancer
+ */
+struct Replica
+{
+    DirectSession* session = nullptr;
+    PreparedRequest prepared {REQUEST_INPUT_PREPARED, "input"};
+
+    // a session can only be used by one thread at the same time
+    std::mutex sessionLock;
+
+    // state of the replica, which is protected by the state-lock of the balancer
+    uint64_t numberOfRunningRequests = 0;
+    uint64_t numberOfRequests = 0;
+    uint64_t numberOfErrors = 0;
+    uint64_t numberOfConsecutiveErrors = 0;
+    uint64_t numberOfLatencySamples = 0;
+    double averageLatencyUs = 0.0;
+    bool ejected = false;
+    bool broken = false;
+    std::chrono::steady_clock::time_point ejectedUntil;
+};
+
+/**
+ * @brief constructor
+ *
+ * @param sessions direct-io-sessions of all replicas. Each session is only used by the balancer
+ *                 afterwards and is not owned by it.
+ * @param strategy strategy to select the replica for a request
+ * @param ejectionFactor a replica is ejected, when its average latency is higher than the
+ *                       average latency of the fastest replica multiplied by this factor
+ * @param ejectionTimeMs time in milliseconds, how long a replica stays ejected
+ * @param maxConsecutiveErrors number of failed requests in a row, which eject a replica
+ */
+ReplicaBalancer::ReplicaBalancer(const std::vector<DirectSession*> &sessions,
+                                 const BalancingStrategy strategy,
+                                 const double ejectionFactor,
+                                 const uint64_t ejectionTimeMs,
+                                 const uint64_t maxConsecutiveErrors)
+{
+    m_strategy = strategy;
+    m_ejectionFactor = ejectionFactor;
+    m_ejectionTime = std::chrono::milliseconds(ejectionTimeMs);
+    m_maxConsecutiveErrors = maxConsecutiveErrors;
+    m_lastSnapshotTime = std::chrono::steady_clock::now();
+
+    for(DirectSession* session : sessions)
+    {
+        Replica* replica = new Replica();
+        replica->session = session;
+        m_replicas.push_back(replica);
+    }
+}
+
+/**
+ * @brief destructor
+ */
+ReplicaBalancer::~ReplicaBalancer()
+{
+    for(Replica* replica : m_replicas) {
+        delete replica;
+    }
+}
+
+/**
+ * @brief get the lowest average latency of all active replicas
+ *
+ * @param excluded replica, which should be ignored
+ *
+ * @return lowest average latency or 0.0, if no other replica has enough samples
+ */
+double
+ReplicaBalancer::getFastestLatency(const Replica* excluded) const
+{
+    double fastest = 0.0;
+    for(const Replica* replica : m_replicas)
+    {
+        if(replica == excluded
+                || replica->ejected
+                || replica->numberOfLatencySamples < MIN_SAMPLES_FOR_EJECTION)
+        {
+            continue;
+        }
+
+        if(fastest == 0.0 || replica->averageLatencyUs < fastest) {
+            fastest = replica->averageLatencyUs;
+        }
+    }
+
+    return fastest;
+}
+
+/**
+ * @brief select the replica for the next request and mark the request as running
+ *
+ * @return nullptr, if the sessions of all replicas are broken, else selected replica
+ */
+Replica*
+ReplicaBalancer::selectReplica()
+{
+    std::lock_guard<std::mutex> guard(m_stateLock);
+
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    Replica* selected = nullptr;
+    Replica* fallback = nullptr;
+
+    for(Replica* replica : m_replicas)
+    {
+        if(replica->broken) {
+            continue;
+        }
+
+        // re-admit replicas after the ejection-time, which have to measure their latency again
+        if(replica->ejected && now >= replica->ejectedUntil)
+        {
+            replica->ejected = false;
+            replica->numberOfConsecutiveErrors = 0;
+            replica->numberOfLatencySamples = 0;
+            replica->averageLatencyUs = 0.0;
+        }
+
+        if(replica->ejected)
+        {
+            // replica, which is re-admitted next, is used, if all replicas are ejected
+            if(fallback == nullptr || replica->ejectedUntil < fallback->ejectedUntil) {
+                fallback = replica;
+            }
+            continue;
+        }
+
+        if(selected == nullptr)
+        {
+            selected = replica;
+            continue;
+        }
+
+        bool better = false;
+        if(m_strategy == LEAST_OUTSTANDING_BALANCING)
+        {
+            better = replica->numberOfRunningRequests < selected->numberOfRunningRequests
+                     || (replica->numberOfRunningRequests == selected->numberOfRunningRequests
+                         && replica->averageLatencyUs < selected->averageLatencyUs);
+        }
+        else
+        {
+            // the latency of a replica grows with the number of requests, which wait for it
+            const double replicaCost = replica->averageLatencyUs
+                                       * (replica->numberOfRunningRequests + 1);
+            const double selectedCost = selected->averageLatencyUs
+                                        * (selected->numberOfRunningRequests + 1);
+            better = replicaCost < selectedCost
+                     || (replicaCost == selectedCost
+                         && replica->numberOfRunningRequests < selected->numberOfRunningRequests);
+        }
+
+        if(better) {
+            selected = replica;
+        }
+    }
+
+    if(selected == nullptr) {
+        selected = fallback;
+    }
+    if(selected == nullptr) {
+        return nullptr;
+    }
+
+    selected->numberOfRunningRequests++;
+
+    return selected;
+}
+
+/**
+ * @brief update the statistics of a replica after a request and eject it, if necessary
+ *
+ * @param replica replica, which processed the request
+ * @param success true, if the request was successful
+ * @param broken true, if the session of the replica is broken by the request
+ * @param latencyUs latency of the request in microseconds
+ */
+void
+ReplicaBalancer::finishRequest(Replica* replica,
+                               const bool success,
+                               const bool broken,
+                               const uint64_t latencyUs)
+{
+    std::lock_guard<std::mutex> guard(m_stateLock);
+
+    replica->numberOfRunningRequests--;
+    replica->numberOfRequests++;
+    m_numberOfRequests++;
+    m_sumLatencyUs += latencyUs;
+
+    bool eject = false;
+    if(success)
+    {
+        replica->numberOfConsecutiveErrors = 0;
+        if(replica->numberOfLatencySamples == 0) {
+            replica->averageLatencyUs = static_cast<double>(latencyUs);
+        } else {
+            replica->averageLatencyUs = LATENCY_EWMA_ALPHA * static_cast<double>(latencyUs)
+                                        + (1.0 - LATENCY_EWMA_ALPHA) * replica->averageLatencyUs;
+        }
+        replica->numberOfLatencySamples++;
+
+        // eject replicas, which are much slower than the fastest one
+        const double fastest = getFastestLatency(replica);
+        eject = fastest > 0.0
+                && replica->numberOfLatencySamples >= MIN_SAMPLES_FOR_EJECTION
+                && replica->averageLatencyUs > fastest * m_ejectionFactor;
+    }
+    else
+    {
+        replica->numberOfErrors++;
+        replica->numberOfConsecutiveErrors++;
+        m_numberOfErrors++;
+        eject = replica->numberOfConsecutiveErrors >= m_maxConsecutiveErrors;
+    }
+
+    if(broken && replica->broken == false)
+    {
+        replica->broken = true;
+        replica->ejected = true;
+        LOG_WARNING("Removed replica with broken session from load-balancer");
+        return;
+    }
+
+    if(eject && replica->ejected == false)
+    {
+        replica->ejected = true;
+        replica->ejectedUntil = std::chrono::steady_clock::now() + m_ejectionTime;
+        LOG_WARNING("Ejected replica from load-balancer with an average latency of "
+                    + std::to_string(replica->averageLatencyUs)
+                    + "us and "
+                    + std::to_string(replica->numberOfConsecutiveErrors)
+                    + " consecutive errors");
+    }
+}
+
+/**
+ * @brief request a single input from one of the replicas
+ *
+ * @param inputValues pointer to the input-values
+ * @param numberOfInputValues number of input-values
+ * @param outputValues pointer to the buffer for the output-values
+ * @param numberOfOutputValues expected number of output-values
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+ReplicaBalancer::request(const float* inputValues,
+                         const uint64_t numberOfInputValues,
+                         float* outputValues,
+                         const uint64_t numberOfOutputValues,
+                         Kitsunemimi::ErrorContainer &error)
+{
+    if(m_replicas.size() == 0)
+    {
+        error.addMeesage("Load-balancer has no replicas");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    Replica* replica = selectReplica();
+    if(replica == nullptr)
+    {
+        error.addMeesage("Sessions of all replicas of the load-balancer are broken");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // the latency includes the time, which the request waits for the session
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool success = false;
+    bool broken = false;
+    {
+        std::lock_guard<std::mutex> guard(replica->sessionLock);
+        success = replica->session->request(replica->prepared,
+                                            inputValues,
+                                            numberOfInputValues,
+                                            outputValues,
+                                            numberOfOutputValues,
+                                            error);
+        broken = replica->session->isBroken();
+    }
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    const uint64_t latencyUs =
+            std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    finishRequest(replica, success, broken, latencyUs);
+
+    if(success == false)
+    {
+        error.addMeesage("Request over load-balancer failed");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief get current statistics of the balancer and all replicas. The rates are calculated
+ *        for the time since the last call of this function.
+ *
+ * @return snapshot of the statistics
+ */
+BalancerSnapshot
+ReplicaBalancer::getSnapshot()
+{
+    std::lock_guard<std::mutex> guard(m_stateLock);
+
+    BalancerSnapshot snapshot;
+    snapshot.numberOfRequests = m_numberOfRequests;
+    snapshot.numberOfErrors = m_numberOfErrors;
+
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(now - m_lastSnapshotTime).count();
+    const uint64_t newRequests = m_numberOfRequests - m_lastSnapshotRequests;
+    if(seconds > 0.0) {
+        snapshot.requestsPerSecond = static_cast<double>(newRequests) / seconds;
+    }
+    if(newRequests > 0)
+    {
+        snapshot.averageLatencyUs = static_cast<double>(m_sumLatencyUs - m_lastSnapshotLatencyUs)
+                                    / static_cast<double>(newRequests);
+    }
+
+    m_lastSnapshotTime = now;
+    m_lastSnapshotRequests = m_numberOfRequests;
+    m_lastSnapshotLatencyUs = m_sumLatencyUs;
+
+    for(const Replica* replica : m_replicas)
+    {
+        ReplicaSnapshot replicaSnapshot;
+        replicaSnapshot.numberOfRequests = replica->numberOfRequests;
+        replicaSnapshot.numberOfErrors = replica->numberOfErrors;
+        replicaSnapshot.numberOfRunningRequests = replica->numberOfRunningRequests;
+        replicaSnapshot.averageLatencyUs = replica->averageLatencyUs;
+        replicaSnapshot.ejected = replica->ejected;
+        replicaSnapshot.broken = replica->broken;
+        snapshot.replicas.push_back(replicaSnapshot);
+    }
+
+    return snapshot;
+}
+
+} // namespace HanamiAI
@@ -3,7 +3,7 @@ QT -= qt core gui
 TARGET = HanamiAiSdk
 CONFIG += c++17
 TEMPLATE = lib
-VERSION = 0.3.1
+VERSION = 0.4.0
 
 LIBS += -L../../../libKitsunemimiCommon/src -lKitsunemimiCommon
 LIBS += -L../../../libKitsunemimiCommon/src/debug -lKitsunemimiCommon
@@ -25,7 +25,7 @@ LIBS += -L../../../libKitsunemimiHanamiCommon/src/debug -lKitsunemimiHanamiCommo
 LIBS += -L../../../libKitsunemimiHanamiCommon/src/release -lKitsunemimiHanamiCommon
 INCLUDEPATH += ../../../libKitsunemimiHanamiCommon/include
 
-LIBS += -lssl -lcryptopp -lcrypt
+LIBS += -lssl -lcryptopp -lcrypt -llz4 -lzstd
 
 INCLUDEPATH += $$PWD \
                $$PWD/../include
@@ -41,7 +41,29 @@ HEADERS += \
     ../include/libHanamiAiSdk/user.h \
     ../include/libHanamiAiSdk/snapshot.h \
     ../include/libHanamiAiSdk/io.h \
+    ../include/libHanamiAiSdk/direct_session.h \
+    ../include/libHanamiAiSdk/prepared_request.h \
+    ../include/libHanamiAiSdk/inference_dispatcher.h \
+    ../include/libHanamiAiSdk/value_encoding.h \
+    ../include/libHanamiAiSdk/delta_encoding.h \
+    ../include/libHanamiAiSdk/ensemble.h \
+    ../include/libHanamiAiSdk/replica_balancer.h \
+    ../include/libHanamiAiSdk/concurrency_limiter.h \
     common/http_client.h \
+    common/direct_io_messages.h \
+    common/mpsc_queue.h \
+    common/cpu_features.h \
+    common/result_cache.h \
+    common/upload_ring.h \
+    common/mapped_file.h \
+    common/segment_size_tuner.h \
+    common/upload_journal.h \
+    common/hash.h \
+    common/content_hash.h \
+    common/segment_compression.h \
+    common/upload_source.h \
+    common/upload_streams.h \
+    common/encoded_values.h \
     ../include/libHanamiAiSdk/common/websocket_client.h
 
 SOURCES += \
@@ -49,13 +71,30 @@ SOURCES += \
     data_set.cpp \
     init.cpp \
     io.cpp \
+    direct_session.cpp \
+    prepared_request.cpp \
     project.cpp \
     request_result.cpp \
     task.cpp \
     template.cpp \
     user.cpp \
     snapshot.cpp \
+    inference_dispatcher.cpp \
+    value_encoding.cpp \
+    delta_encoding.cpp \
+    ensemble.cpp \
+    replica_balancer.cpp \
+    concurrency_limiter.cpp \
     common/http_client.cpp \
+    common/result_cache.cpp \
+    common/mapped_file.cpp \
+    common/upload_journal.cpp \
+    common/hash.cpp \
+    common/content_hash.cpp \
+    common/segment_compression.cpp \
+    common/upload_source.cpp \
+    common/upload_streams.cpp \
+    common/encoded_values.cpp \
     common/websocket_client.cpp
 
 
@@ -0,0 +1,769 @@
+/**
+ * @file        value_encoding.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libHanamiAiSdk/value_encoding.h>
+#include <common/cpu_features.h>
+
+#include <string.h>
+#include <math.h>
+
+namespace HanamiAI
+{
+
+//==================================================================================================
+// scalar conversions
+//==================================================================================================
+
+/**
+ * @brief convert float into half-precision float with round-to-nearest-even. NaN is converted
+ *        like the F16C-instructions do it, so it stays a quiet NaN with the upper bits of the
+ *        payload and the SIMD- and scalar-version produce the same results.
+ */
+inline uint16_t
+floatToHalf(const float value)
+{
+    const uint32_t f16Max = (127 + 16) << 23;
+    const uint32_t f32Infinity = 255 << 23;
+    const uint32_t denormMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+
+    uint32_t x = 0;
+    memcpy(&x, &value, 4);
+    const uint32_t sign = x & 0x80000000u;
+    x ^= sign;
+
+    uint16_t result = 0;
+    if(x > f32Infinity)
+    {
+        // NaN with quiet-bit and truncated payload
+        result = static_cast<uint16_t>(0x7e00 | ((x >> 13) & 0x3ff));
+    }
+    else if(x >= f16Max)
+    {
+        // overflow to infinity
+        result = 0x7c00;
+    }
+    else if(x < (113 << 23))
+    {
+        // subnormal half or zero, where the float-addition does the rounding
+        float magic = 0.0f;
+        memcpy(&magic, &denormMagic, 4);
+        float f = 0.0f;
+        memcpy(&f, &x, 4);
+        f += magic;
+        uint32_t bits = 0;
+        memcpy(&bits, &f, 4);
+        result = static_cast<uint16_t>(bits - denormMagic);
+    }
+    else
+    {
+        // normal half with rebased exponent and rounded mantissa
+        const uint32_t mantissaOdd = (x >> 13) & 1;
+        x += (static_cast<uint32_t>(15 - 127) << 23) + 0xfff;
+        x += mantissaOdd;
+        result = static_cast<uint16_t>(x >> 13);
+    }
+
+    return result | static_cast<uint16_t>(sign >> 16);
+}
+
+/**
+ * @brief convert half-precision float into float. Like the F16C-instructions, a signaling NaN
+ *        is converted into a quiet NaN.
+ */
+inline float
+halfToFloat(const uint16_t value)
+{
+    const uint32_t magic = 113 << 23;
+    const uint32_t shiftedExponent = 0x7c00 << 13;
+
+    uint32_t x = static_cast<uint32_t>(value & 0x7fff) << 13;
+    const uint32_t exponent = shiftedExponent & x;
+    x += (127 - 15) << 23;
+
+    if(exponent == shiftedExponent)
+    {
+        // infinity or NaN
+        x += (128 - 16) << 23;
+        if((value & 0x3ff) != 0) {
+            x |= 0x00400000;
+        }
+    }
+    else if(exponent == 0)
+    {
+        // zero or subnormal
+        x += 1 << 23;
+        float f = 0.0f;
+        memcpy(&f, &x, 4);
+        float m = 0.0f;
+        memcpy(&m, &magic, 4);
+        f -= m;
+        memcpy(&x, &f, 4);
+    }
+
+    x |= static_cast<uint32_t>(value & 0x8000) << 16;
+
+    float result = 0.0f;
+    memcpy(&result, &x, 4);
+    return result;
+}
+
+/**
+ * @brief convert float into bfloat16 with round-to-nearest-even
+ */
+inline uint16_t
+floatToBfloat(const float value)
+{
+    uint32_t x = 0;
+    memcpy(&x, &value, 4);
+
+    // keep NaN as quiet NaN, instead of rounding it to infinity
+    if((x & 0x7fffffff) > 0x7f800000) {
+        return static_cast<uint16_t>((x >> 16) | 0x40);
+    }
+
+    x += 0x7fff + ((x >> 16) & 1);
+    return static_cast<uint16_t>(x >> 16);
+}
+
+/**
+ * @brief convert bfloat16 into float
+ */
+inline float
+bfloatToFloat(const uint16_t value)
+{
+    const uint32_t x = static_cast<uint32_t>(value) << 16;
+    float result = 0.0f;
+    memcpy(&result, &x, 4);
+    return result;
+}
+
+/**
+ * @brief quantize a float to int8 with a precalculated inverse scale
+ */
+inline int8_t
+floatToInt8(const float value,
+            const float inverseScale)
+{
+    float quantized = nearbyintf(value * inverseScale);
+    quantized = fminf(fmaxf(quantized, -127.0f), 127.0f);
+    return static_cast<int8_t>(quantized);
+}
+
+//==================================================================================================
+// SIMD conversions
+//==================================================================================================
+
+#ifdef HANAMI_X86_SIMD
+
+HANAMI_TARGET_AVX2_F16C uint64_t
+encodeHalfAvx2(uint8_t* target,
+               const float* values,
+               const uint64_t numberOfValues)
+{
+    uint64_t i = 0;
+    for(; i + 8 <= numberOfValues; i += 8)
+    {
+        const __m256 v = _mm256_loadu_ps(&values[i]);
+        const __m128i h = _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&target[i * 2]), h);
+    }
+    return i;
+}
+
+HANAMI_TARGET_AVX2_F16C uint64_t
+decodeHalfAvx2(float* target,
+               const uint8_t* data,
+               const uint64_t numberOfValues)
+{
+    uint64_t i = 0;
+    for(; i + 8 <= numberOfValues; i += 8)
+    {
+        const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&data[i * 2]));
+        _mm256_storeu_ps(&target[i], _mm256_cvtph_ps(h));
+    }
+    return i;
+}
+
+HANAMI_TARGET_AVX2 uint64_t
+encodeBfloatAvx2(uint8_t* target,
+                 const float* values,
+                 const uint64_t numberOfValues)
+{
+    const __m256i absMask = _mm256_set1_epi32(0x7fffffff);
+    const __m256i infinity = _mm256_set1_epi32(0x7f800000);
+    const __m256i roundBase = _mm256_set1_epi32(0x7fff);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i quietBit = _mm256_set1_epi32(0x40);
+
+    uint64_t i = 0;
+    for(; i + 16 <= numberOfValues; i += 16)
+    {
+        __m256i result[2];
+        for(uint32_t j = 0; j < 2; j++)
+        {
+            const __m256i x = _mm256_castps_si256(_mm256_loadu_ps(&values[i + j * 8]));
+            const __m256i isNan = _mm256_cmpgt_epi32(_mm256_and_si256(x, absMask), infinity);
+            const __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(x, 16), one);
+            const __m256i rounded = _mm256_add_epi32(x, _mm256_add_epi32(roundBase, lsb));
+            const __m256i nanValue = _mm256_or_si256(_mm256_srli_epi32(x, 16), quietBit);
+            result[j] = _mm256_blendv_epi8(_mm256_srli_epi32(rounded, 16), nanValue, isNan);
+        }
+
+        // pack works within the 128-bit lanes, so the order has to be fixed afterwards
+        const __m256i packed = _mm256_packus_epi32(result[0], result[1]);
+        const __m256i ordered = _mm256_permute4x64_epi64(packed, 0xd8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&target[i * 2]), ordered);
+    }
+    return i;
+}
+
+HANAMI_TARGET_AVX2 uint64_t
+decodeBfloatAvx2(float* target,
+                 const uint8_t* data,
+                 const uint64_t numberOfValues)
+{
+    uint64_t i = 0;
+    for(; i + 8 <= numberOfValues; i += 8)
+    {
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&data[i * 2]));
+        const __m256i x = _mm256_slli_epi32(_mm256_cvtepu16_epi32(b), 16);
+        _mm256_storeu_ps(&target[i], _mm256_castsi256_ps(x));
+    }
+    return i;
+}
+
+HANAMI_TARGET_AVX2 float
+getMaxAbsAvx2(const float* values,
+              const uint64_t numberOfValues,
+              uint64_t &processed)
+{
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 maxValues = _mm256_setzero_ps();
+
+    uint64_t i = 0;
+    for(; i + 8 <= numberOfValues; i += 8) {
+        maxValues = _mm256_max_ps(maxValues, _mm256_and_ps(_mm256_loadu_ps(&values[i]), absMask));
+    }
+
+    float lanes[8];
+    _mm256_storeu_ps(lanes, maxValues);
+    float result = 0.0f;
+    for(uint32_t j = 0; j < 8; j++) {
+        result = fmaxf(result, lanes[j]);
+    }
+
+    processed = i;
+    return result;
+}
+
+HANAMI_TARGET_AVX2 uint64_t
+encodeInt8Avx2(int8_t* target,
+               const float* values,
+               const uint64_t numberOfValues,
+               const float inverseScale)
+{
+    const __m256 scale = _mm256_set1_ps(inverseScale);
+    const __m256 maxValue = _mm256_set1_ps(127.0f);
+    const __m256 minValue = _mm256_set1_ps(-127.0f);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    uint64_t i = 0;
+    for(; i + 32 <= numberOfValues; i += 32)
+    {
+        __m256i q[4];
+        for(uint32_t j = 0; j < 4; j++)
+        {
+            __m256 v = _mm256_mul_ps(_mm256_loadu_ps(&values[i + j * 8]), scale);
+            v = _mm256_round_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            v = _mm256_min_ps(_mm256_max_ps(v, minValue), maxValue);
+            q[j] = _mm256_cvtps_epi32(v);
+        }
+
+        // pack works within the 128-bit lanes, so the order has to be fixed afterwards
+        const __m256i q16a = _mm256_packs_epi32(q[0], q[1]);
+        const __m256i q16b = _mm256_packs_epi32(q[2], q[3]);
+        const __m256i q8 = _mm256_packs_epi16(q16a, q16b);
+        const __m256i ordered = _mm256_permutevar8x32_epi32(q8, order);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&target[i]), ordered);
+    }
+    return i;
+}
+
+HANAMI_TARGET_AVX2 uint64_t
+decodeInt8Avx2(float* target,
+               const int8_t* data,
+               const uint64_t numberOfValues,
+               const float scaleValue)
+{
+    const __m256 scale = _mm256_set1_ps(scaleValue);
+
+    uint64_t i = 0;
+    for(; i + 8 <= numberOfValues; i += 8)
+    {
+        int64_t raw = 0;
+        memcpy(&raw, &data[i], 8);
+        const __m256i x = _mm256_cvtepi8_epi32(_mm_cvtsi64_si128(raw));
+        _mm256_storeu_ps(&target[i], _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale));
+    }
+    return i;
+}
+
+HANAMI_TARGET_AVX2 uint64_t
+countNonZeroAvx2(const float* values,
+                 const uint64_t numberOfValues,
+                 uint64_t &processed)
+{
+    const __m256 zero = _mm256_setzero_ps();
+
+    uint64_t counter = 0;
+    uint64_t i = 0;
+    for(; i + 8 <= numberOfValues; i += 8)
+    {
+        const __m256 mask = _mm256_cmp_ps(_mm256_loadu_ps(&values[i]), zero, _CMP_NEQ_UQ);
+        counter += __builtin_popcount(_mm256_movemask_ps(mask));
+    }
+
+    processed = i;
+    return counter;
+}
+
+HANAMI_TARGET_AVX2 uint64_t
+extractNonZeroAvx2(uint8_t* indexes,
+                   uint8_t* sparseValues,
+                   const float* values,
+                   const uint64_t numberOfValues,
+                   uint64_t &processed)
+{
+    const __m256 zero = _mm256_setzero_ps();
+
+    uint64_t counter = 0;
+    uint64_t i = 0;
+    for(; i + 8 <= numberOfValues; i += 8)
+    {
+        const __m256 mask = _mm256_cmp_ps(_mm256_loadu_ps(&values[i]), zero, _CMP_NEQ_UQ);
+        uint32_t bits = static_cast<uint32_t>(_mm256_movemask_ps(mask));
+
+        // blocks of only zeros are skipped with a single compare
+        while(bits != 0)
+        {
+            const uint32_t pos = static_cast<uint32_t>(__builtin_ctz(bits));
+            const uint32_t index = static_cast<uint32_t>(i + pos);
+            memcpy(&indexes[counter * 4], &index, 4);
+            memcpy(&sparseValues[counter * 4], &values[i + pos], 4);
+            counter++;
+            bits &= bits - 1;
+        }
+    }
+
+    processed = i;
+    return counter;
+}
+
+#endif
+
+//==================================================================================================
+// public functions
+//==================================================================================================
+
+/**
+ * @brief get number of bytes, which are necessary to encode a number of values
+ *
+ * @param encoding encoding of the values
+ * @param numberOfValues number of values
+ *
+ * @return number of bytes of the encoded values or 0 for the SPARSE_ENCODING, where the size
+ *         depends on the values and has to be requested by getSparseEncodedSize(), and for
+ *         the DELTA_ENCODING, which is handled by the DeltaEncoder
+ */
+uint64_t
+getEncodedSize(const ValueEncoding encoding,
+               const uint64_t numberOfValues)
+{
+    switch(encoding)
+    {
+        case FP32_ENCODING:
+            return numberOfValues * sizeof(float);
+        case FP16_ENCODING:
+        case BF16_ENCODING:
+            return numberOfValues * sizeof(uint16_t);
+        case INT8_ENCODING:
+            // the int8-values are prefixed by the float-scale, which is necessary to decode them
+            return sizeof(float) + numberOfValues;
+        case SPARSE_ENCODING:
+            // size depends on the values and not only on their number
+            return 0;
+        case DELTA_ENCODING:
+            // size depends on the previous values of the stream
+            return 0;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief encode float-values with reduced precision. The INT8-encoding scales the values
+ *        symmetrically by the maximum absolute value, so all values must be finite.
+ *
+ * @param target pointer to buffer with at least getEncodedSize() bytes for the result or
+ *               getSparseEncodedSize() bytes for the SPARSE_ENCODING
+ * @param values pointer to the values to encode
+ * @param numberOfValues number of values
+ * @param encoding encoding to use
+ *
+ * @return number of written bytes or 0 for the DELTA_ENCODING, which needs the DeltaEncoder
+ */
+uint64_t
+encodeValues(uint8_t* target,
+             const float* values,
+             const uint64_t numberOfValues,
+             const ValueEncoding encoding)
+{
+    uint64_t i = 0;
+
+    switch(encoding)
+    {
+        case FP32_ENCODING:
+        {
+            memcpy(target, values, numberOfValues * sizeof(float));
+            break;
+        }
+        case SPARSE_ENCODING:
+        {
+            return encodeSparseValues(target, values, numberOfValues);
+        }
+        case DELTA_ENCODING:
+        {
+            return 0;
+        }
+        case FP16_ENCODING:
+        {
+#ifdef HANAMI_X86_SIMD
+            if(hasAvx2F16c()) {
+                i = encodeHalfAvx2(target, values, numberOfValues);
+            }
+#endif
+            for(; i < numberOfValues; i++)
+            {
+                const uint16_t half = floatToHalf(values[i]);
+                memcpy(&target[i * 2], &half, 2);
+            }
+            break;
+        }
+        case BF16_ENCODING:
+        {
+#ifdef HANAMI_X86_SIMD
+            if(hasAvx2()) {
+                i = encodeBfloatAvx2(target, values, numberOfValues);
+            }
+#endif
+            for(; i < numberOfValues; i++)
+            {
+                const uint16_t bfloat = floatToBfloat(values[i]);
+                memcpy(&target[i * 2], &bfloat, 2);
+            }
+            break;
+        }
+        case INT8_ENCODING:
+        {
+            // get range of the values
+            float maxAbs = 0.0f;
+#ifdef HANAMI_X86_SIMD
+            if(hasAvx2()) {
+                maxAbs = getMaxAbsAvx2(values, numberOfValues, i);
+            }
+#endif
+            for(; i < numberOfValues; i++) {
+                maxAbs = fmaxf(maxAbs, fabsf(values[i]));
+            }
+
+            const float scale = (maxAbs > 0.0f) ? maxAbs / 127.0f : 1.0f;
+            const float inverseScale = 1.0f / scale;
+            memcpy(target, &scale, sizeof(float));
+
+            int8_t* quantized = reinterpret_cast<int8_t*>(target + sizeof(float));
+            i = 0;
+#ifdef HANAMI_X86_SIMD
+            if(hasAvx2()) {
+                i = encodeInt8Avx2(quantized, values, numberOfValues, inverseScale);
+            }
+#endif
+            for(; i < numberOfValues; i++) {
+                quantized[i] = floatToInt8(values[i], inverseScale);
+            }
+            break;
+        }
+    }
+
+    return getEncodedSize(encoding, numberOfValues);
+}
+
+/**
+ * @brief decode values, which were encoded by encodeValues, back to floats
+ *
+ * @param target pointer to buffer for the decoded float-values
+ * @param data pointer to the encoded data
+ * @param dataSize number of bytes of the encoded data
+ * @param numberOfValues number of encoded values
+ * @param encoding encoding of the data
+ *
+ * @return false, if the size of the data doesn't match or for the DELTA_ENCODING, which
+ *         needs the DeltaDecoder, else true
+ */
+bool
+decodeValues(float* target,
+             const uint8_t* data,
+             const uint64_t dataSize,
+             const uint64_t numberOfValues,
+             const ValueEncoding encoding)
+{
+    if(encoding == SPARSE_ENCODING) {
+        return decodeSparseValues(target, data, dataSize, numberOfValues);
+    }
+    if(encoding == DELTA_ENCODING) {
+        return false;
+    }
+
+    if(dataSize != getEncodedSize(encoding, numberOfValues)) {
+        return false;
+    }
+
+    uint64_t i = 0;
+
+    switch(encoding)
+    {
+        case FP32_ENCODING:
+        {
+            memcpy(target, data, numberOfValues * sizeof(float));
+            break;
+        }
+        case FP16_ENCODING:
+        {
+#ifdef HANAMI_X86_SIMD
+            if(hasAvx2F16c()) {
+                i = decodeHalfAvx2(target, data, numberOfValues);
+            }
+#endif
+            for(; i < numberOfValues; i++)
+            {
+                uint16_t half = 0;
+                memcpy(&half, &data[i * 2], 2);
+                target[i] = halfToFloat(half);
+            }
+            break;
+        }
+        case BF16_ENCODING:
+        {
+#ifdef HANAMI_X86_SIMD
+            if(hasAvx2()) {
+                i = decodeBfloatAvx2(target, data, numberOfValues);
+            }
+#endif
+            for(; i < numberOfValues; i++)
+            {
+                uint16_t bfloat = 0;
+                memcpy(&bfloat, &data[i * 2], 2);
+                target[i] = bfloatToFloat(bfloat);
+            }
+            break;
+        }
+        case SPARSE_ENCODING:
+        case DELTA_ENCODING:
+        {
+            break;
+        }
+        case INT8_ENCODING:
+        {
+            float scale = 0.0f;
+            memcpy(&scale, data, sizeof(float));
+
+            const int8_t* quantized = reinterpret_cast<const int8_t*>(data + sizeof(float));
+#ifdef HANAMI_X86_SIMD
+            if(hasAvx2()) {
+                i = decodeInt8Avx2(target, quantized, numberOfValues, scale);
+            }
+#endif
+            for(; i < numberOfValues; i++) {
+                target[i] = static_cast<float>(quantized[i]) * scale;
+            }
+            break;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief count all values, which are not zero
+ *
+ * @param values pointer to the values
+ * @param numberOfValues number of values
+ *
+ * @return number of non-zero values
+ */
+uint64_t
+countNonZeroValues(const float* values,
+                   const uint64_t numberOfValues)
+{
+    uint64_t counter = 0;
+    uint64_t i = 0;
+#ifdef HANAMI_X86_SIMD
+    if(hasAvx2()) {
+        counter = countNonZeroAvx2(values, numberOfValues, i);
+    }
+#endif
+    for(; i < numberOfValues; i++) {
+        counter += (values[i] != 0.0f);
+    }
+
+    return counter;
+}
+
+/**
+ * @brief check if values should be send as sparse (index, value)-pairs instead of dense
+ *
+ * @param values pointer to the values
+ * @param numberOfValues number of values
+ * @param numberOfNonZeroValues reference for returning the number of non-zero values
+ * @param maxDensity maximum ratio of non-zero values for the sparse-encoding. With 8 bytes per
+ *                   non-zero value the sparse-encoding is only smaller below a density of 0.5.
+ *
+ * @return true, if sparse-encoding should be used, else false
+ */
+bool
+shouldUseSparseEncoding(const float* values,
+                        const uint64_t numberOfValues,
+                        uint64_t &numberOfNonZeroValues,
+                        const float maxDensity)
+{
+    numberOfNonZeroValues = countNonZeroValues(values, numberOfValues);
+
+    const uint64_t sparseSize = getSparseEncodedSize(numberOfNonZeroValues);
+    const uint64_t denseSize = getEncodedSize(FP32_ENCODING, numberOfValues);
+    if(sparseSize >= denseSize) {
+        return false;
+    }
+
+    return static_cast<float>(numberOfNonZeroValues)
+           <= maxDensity * static_cast<float>(numberOfValues);
+}
+
+/**
+ * @brief get number of bytes for the sparse-encoding
+ *
+ * @param numberOfNonZeroValues number of non-zero values
+ *
+ * @return number of bytes of the sparse-encoded values
+ */
+uint64_t
+getSparseEncodedSize(const uint64_t numberOfNonZeroValues)
+{
+    // number of pairs + indexes + values
+    return sizeof(uint32_t) + numberOfNonZeroValues * (sizeof(uint32_t) + sizeof(float));
+}
+
+/**
+ * @brief encode values as sparse block with layout:
+ *        [uint32 number of pairs][uint32 indexes ...][float values ...]
+ *
+ * @param target pointer to buffer with at least getSparseEncodedSize() bytes for the result
+ * @param values pointer to the values to encode
+ * @param numberOfValues number of values
+ *
+ * @return number of written bytes
+ */
+uint64_t
+encodeSparseValues(uint8_t* target,
+                   const float* values,
+                   const uint64_t numberOfValues)
+{
+    const uint64_t numberOfNonZeroValues = countNonZeroValues(values, numberOfValues);
+    uint8_t* indexes = target + sizeof(uint32_t);
+    uint8_t* sparseValues = indexes + numberOfNonZeroValues * sizeof(uint32_t);
+
+    uint64_t counter = 0;
+    uint64_t i = 0;
+#ifdef HANAMI_X86_SIMD
+    if(hasAvx2()) {
+        counter = extractNonZeroAvx2(indexes, sparseValues, values, numberOfValues, i);
+    }
+#endif
+    for(; i < numberOfValues; i++)
+    {
+        if(values[i] != 0.0f)
+        {
+            const uint32_t index = static_cast<uint32_t>(i);
+            memcpy(&indexes[counter * 4], &index, 4);
+            memcpy(&sparseValues[counter * 4], &values[i], 4);
+            counter++;
+        }
+    }
+
+    const uint32_t numberOfPairs = static_cast<uint32_t>(counter);
+    memcpy(target, &numberOfPairs, sizeof(uint32_t));
+
+    return getSparseEncodedSize(counter);
+}
+
+/**
+ * @brief decode a sparse block back to dense float-values
+ *
+ * @param target pointer to buffer for the decoded float-values
+ * @param data pointer to the sparse block
+ * @param dataSize number of bytes of the sparse block
+ * @param numberOfValues number of dense values
+ *
+ * @return false, if the block is broken, else true
+ */
+bool
+decodeSparseValues(float* target,
+                   const uint8_t* data,
+                   const uint64_t dataSize,
+                   const uint64_t numberOfValues)
+{
+    if(dataSize < sizeof(uint32_t)) {
+        return false;
+    }
+
+    uint32_t numberOfPairs = 0;
+    memcpy(&numberOfPairs, data, sizeof(uint32_t));
+    if(dataSize != getSparseEncodedSize(numberOfPairs)) {
+        return false;
+    }
+
+    const uint8_t* indexes = data + sizeof(uint32_t);
+    const uint8_t* sparseValues = indexes + static_cast<uint64_t>(numberOfPairs) * 4;
+
+    memset(target, 0, numberOfValues * sizeof(float));
+    for(uint32_t i = 0; i < numberOfPairs; i++)
+    {
+        uint32_t index = 0;
+        memcpy(&index, &indexes[i * 4], 4);
+        if(index >= numberOfValues) {
+            return false;
+        }
+        memcpy(&target[index], &sparseValues[i * 4], 4);
+    }
+
+    return true;
+}
+
+} // namespace HanamiAI
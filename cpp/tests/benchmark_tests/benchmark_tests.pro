@@ -0,0 +1,45 @@
+include(../../defaults.pri)
+
+QT -= qt core gui
+
+CONFIG -= app_bundle
+CONFIG += c++17 console
+
+LIBS += -L../../src -lHanamiAiSdk
+LIBS += -L../../src/debug -lHanamiAiSdk
+LIBS += -L../../src/release -lHanamiAiSdk
+
+LIBS += -L../../../../libKitsunemimiHanamiCommon/src -lKitsunemimiHanamiCommon
+LIBS += -L../../../../libKitsunemimiHanamiCommon/src/debug -lKitsunemimiHanamiCommon
+LIBS += -L../../../../libKitsunemimiHanamiCommon/src/release -lKitsunemimiHanamiCommon
+INCLUDEPATH += ../../../../libKitsunemimiHanamiCommon/include
+
+LIBS += -L../../../../libKitsunemimiCrypto/src -lKitsunemimiCrypto
+LIBS += -L../../../../libKitsunemimiCrypto/src/debug -lKitsunemimiCrypto
+LIBS += -L../../../../libKitsunemimiCrypto/src/release -lKitsunemimiCrypto
+INCLUDEPATH += ../../../../libKitsunemimiCrypto/include
+
+LIBS += -L../../../../libKitsunemimiJson/src -lKitsunemimiJson
+LIBS += -L../../../../libKitsunemimiJson/src/debug -lKitsunemimiJson
+LIBS += -L../../../../libKitsunemimiJson/src/release -lKitsunemimiJson
+INCLUDEPATH += ../../../../libKitsunemimiJson/include
+
+LIBS += -L../../../../libKitsunemimiCommon/src -lKitsunemimiCommon
+LIBS += -L../../../../libKitsunemimiCommon/src/debug -lKitsunemimiCommon
+LIBS += -L../../../../libKitsunemimiCommon/src/release -lKitsunemimiCommon
+INCLUDEPATH += ../../../../libKitsunemimiCommon/include
+
+LIBS += -lprotobuf -lssl -lcryptopp -lcrypt -llz4 -lzstd -lpthread
+
+INCLUDEPATH += $$PWD
+
+HEADERS += \
+    delta_encoding_benchmark.h \
+    segment_compression_benchmark.h \
+    value_encoding_benchmark.h
+
+SOURCES += \
+    main.cpp \
+    delta_encoding_benchmark.cpp \
+    segment_compression_benchmark.cpp \
+    value_encoding_benchmark.cpp
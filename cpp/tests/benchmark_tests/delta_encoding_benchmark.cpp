@@ -0,0 +1,151 @@
+/**
+ * @file        delta_encoding_benchmark.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "delta_encoding_benchmark.h"
+
+#include <libHanamiAiSdk/prepared_request.h>
+#include <libHanamiAiSdk/delta_encoding.h>
+#include <common/encoded_values.h>
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <math.h>
+#include <string.h>
+
+// size of the sliding window and number of windows of each run
+#define DELTA_WINDOW_SIZE 1024
+#define DELTA_NUMBER_OF_WINDOWS 2000
+#define DELTA_NUMBER_OF_RUNS 10
+
+namespace HanamiAI
+{
+
+DeltaEncoding_Benchmark::DeltaEncoding_Benchmark()
+{
+    createSeries();
+
+    std::cout << "delta-encoding of sliding windows with " << DELTA_WINDOW_SIZE
+              << " values per window:" << std::endl;
+    runStream("fp32", 1, false);
+    runStream("delta, step 1", 1, true);
+    runStream("delta, step 8", 8, true);
+    runStream("delta, step 64", 64, true);
+}
+
+/**
+ * @brief create a noisy time-series, which is long enough for all windows of the biggest step
+ */
+void
+DeltaEncoding_Benchmark::createSeries()
+{
+    uint64_t state = 42;
+    m_series.resize(DELTA_WINDOW_SIZE + DELTA_NUMBER_OF_WINDOWS * 64);
+
+    for(uint64_t i = 0; i < m_series.size(); i++)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        const float noise = static_cast<float>((state >> 40) % 1000) / 10000.0f;
+        m_series[i] = sinf(static_cast<float>(i) * 0.01f) + noise;
+    }
+}
+
+/**
+ * @brief fill all windows of the stream into a prepared request and decode the frames in the
+ *        same order like the server
+ *
+ * @param name name of the run for the output
+ * @param step number of values, by which the window is moved for each message
+ * @param delta true to enable the delta-encoding
+ */
+void
+DeltaEncoding_Benchmark::runStream(const std::string &name,
+                                   const uint64_t step,
+                                   const bool delta)
+{
+    PreparedRequest prepared(REQUEST_INPUT_PREPARED, "input");
+    std::vector<float> decoded(DELTA_WINDOW_SIZE);
+    std::vector<std::vector<uint8_t>> frames(DELTA_NUMBER_OF_WINDOWS);
+    uint64_t numberOfBytes = 0;
+
+    // encode
+    const std::chrono::steady_clock::time_point encodeStart = std::chrono::steady_clock::now();
+    for(uint32_t run = 0; run < DELTA_NUMBER_OF_RUNS; run++)
+    {
+        // restart the stream, so the first frame of each run is a keyframe
+        prepared.setDeltaEncoding(delta);
+        numberOfBytes = 0;
+        for(uint64_t i = 0; i < DELTA_NUMBER_OF_WINDOWS; i++)
+        {
+            uint64_t frameSize = 0;
+            const uint8_t* frame = prepared.fill(&m_series[i * step],
+                                                 DELTA_WINDOW_SIZE,
+                                                 frameSize);
+            frames[i].assign(frame, frame + frameSize);
+            numberOfBytes += frameSize;
+        }
+    }
+    const std::chrono::duration<double> encodeDuration = std::chrono::steady_clock::now()
+                                                         - encodeStart;
+
+    // decode
+    bool success = true;
+    const std::chrono::steady_clock::time_point decodeStart = std::chrono::steady_clock::now();
+    for(uint32_t run = 0; run < DELTA_NUMBER_OF_RUNS && delta; run++)
+    {
+        DeltaDecoder decoder;
+        for(uint64_t i = 0; i < DELTA_NUMBER_OF_WINDOWS; i++)
+        {
+            EncodedValues encoded;
+            success &= parseEncodedValues(encoded, frames[i].data(), frames[i].size());
+            success &= decodeEncodedValues(decoded.data(), encoded, &decoder);
+            success &= memcmp(decoded.data(),
+                              &m_series[i * step],
+                              DELTA_WINDOW_SIZE * sizeof(float)) == 0;
+        }
+    }
+    const std::chrono::duration<double> decodeDuration = std::chrono::steady_clock::now()
+                                                         - decodeStart;
+
+    if(success == false)
+    {
+        std::cout << name << ": failed to decode frames" << std::endl;
+        return;
+    }
+
+    const double numberOfWindows = static_cast<double>(DELTA_NUMBER_OF_WINDOWS)
+                                   * DELTA_NUMBER_OF_RUNS;
+    std::cout << "    " << std::setw(16) << std::left << name
+              << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << static_cast<double>(numberOfBytes) / DELTA_NUMBER_OF_WINDOWS
+              << " bytes/window"
+              << std::setw(14) << numberOfWindows / encodeDuration.count()
+              << " encoded windows/s";
+    if(delta)
+    {
+        std::cout << std::setw(14) << numberOfWindows / decodeDuration.count()
+                  << " decoded windows/s";
+    }
+    std::cout << std::endl;
+}
+
+} // namespace HanamiAI
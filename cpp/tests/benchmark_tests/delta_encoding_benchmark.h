@@ -0,0 +1,53 @@
+/**
+ * @file        delta_encoding_benchmark.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMISDK_DELTA_ENCODING_BENCHMARK_H
+#define KITSUNEMIMI_HANAMISDK_DELTA_ENCODING_BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace HanamiAI
+{
+
+/**
+ * @brief Compares the size of the frames of the delta-encoding against plain fp32 for a
+ *        synthetic stream of sliding windows over a time-series.
+ */
+class DeltaEncoding_Benchmark
+{
+public:
+    DeltaEncoding_Benchmark();
+
+private:
+    std::vector<float> m_series;
+
+    void createSeries();
+    void runStream(const std::string &name,
+                   const uint64_t step,
+                   const bool delta);
+};
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_DELTA_ENCODING_BENCHMARK_H
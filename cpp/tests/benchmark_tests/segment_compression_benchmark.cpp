@@ -0,0 +1,281 @@
+/**
+ * @file        segment_compression_benchmark.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#include "segment_compression_benchmark.h"
+
+#include <common/segment_compression.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <stdio.h>
+#include <string.h>
+
+// default segment-size of the upload and number of runs for the time-measurement
+#define SEGMENT_BENCHMARK_SEGMENT_SIZE (96 * 1024)
+#define SEGMENT_BENCHMARK_NUMBER_OF_RUNS 5
+
+// size of the generated files
+#define SEGMENT_BENCHMARK_CSV_ROWS 100000
+#define SEGMENT_BENCHMARK_CSV_COLUMNS 16
+#define SEGMENT_BENCHMARK_IMAGES 10000
+#define SEGMENT_BENCHMARK_IMAGE_SIZE 28
+
+namespace HanamiAI
+{
+
+/**
+ * @brief simple pseudo-random generator, so all runs use the same data
+ */
+inline uint32_t
+nextRandom(uint64_t &state)
+{
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<uint32_t>(state >> 33);
+}
+
+/**
+ * @brief write a 32-bit value in big-endian, like all header-values of the idx-format
+ */
+inline void
+appendBigEndian(std::vector<uint8_t> &data,
+                const uint32_t value)
+{
+    data.push_back(static_cast<uint8_t>(value >> 24));
+    data.push_back(static_cast<uint8_t>(value >> 16));
+    data.push_back(static_cast<uint8_t>(value >> 8));
+    data.push_back(static_cast<uint8_t>(value));
+}
+
+SegmentCompression_Benchmark::SegmentCompression_Benchmark()
+{
+    std::vector<uint8_t> csv;
+    std::vector<uint8_t> images;
+    std::vector<uint8_t> labels;
+    createCsv(csv);
+    createIdxImages(images);
+    createIdxLabels(labels);
+
+    std::cout << "compression of upload-segments with " << SEGMENT_BENCHMARK_SEGMENT_SIZE
+              << " bytes per segment:" << std::endl;
+    runCompression("csv, lz4", csv, LZ4_COMPRESSION);
+    runCompression("csv, zstd", csv, ZSTD_COMPRESSION);
+    runCompression("idx images, lz4", images, LZ4_COMPRESSION);
+    runCompression("idx images, zstd", images, ZSTD_COMPRESSION);
+    runCompression("idx labels, lz4", labels, LZ4_COMPRESSION);
+    runCompression("idx labels, zstd", labels, ZSTD_COMPRESSION);
+}
+
+/**
+ * @brief create a csv-file with a header-line, noisy float-values and an integer label per row
+ *
+ * @param data buffer for the content of the file
+ */
+void
+SegmentCompression_Benchmark::createCsv(std::vector<uint8_t> &data)
+{
+    uint64_t state = 42;
+    std::string content = "";
+
+    for(uint32_t column = 0; column < SEGMENT_BENCHMARK_CSV_COLUMNS; column++) {
+        content += "value_" + std::to_string(column) + ",";
+    }
+    content += "label\n";
+
+    char buffer[32];
+    for(uint32_t row = 0; row < SEGMENT_BENCHMARK_CSV_ROWS; row++)
+    {
+        for(uint32_t column = 0; column < SEGMENT_BENCHMARK_CSV_COLUMNS; column++)
+        {
+            const float value = static_cast<float>(nextRandom(state) % 20000) / 10000.0f - 1.0f;
+            snprintf(buffer, sizeof(buffer), "%.4f,", static_cast<double>(value));
+            content += buffer;
+        }
+        content += std::to_string(nextRandom(state) % 10) + "\n";
+    }
+
+    data.assign(content.begin(), content.end());
+}
+
+/**
+ * @brief create an image-file in idx-format with 16 bytes header and 28x28 grayscale-images,
+ *        which contain a blob with random size and position near the center, like the digits
+ *        of the mnist-dataset
+ *
+ * @param data buffer for the content of the file
+ */
+void
+SegmentCompression_Benchmark::createIdxImages(std::vector<uint8_t> &data)
+{
+    const int32_t size = SEGMENT_BENCHMARK_IMAGE_SIZE;
+    uint64_t state = 42;
+
+    data.clear();
+    appendBigEndian(data, 0x00000803);
+    appendBigEndian(data, SEGMENT_BENCHMARK_IMAGES);
+    appendBigEndian(data, SEGMENT_BENCHMARK_IMAGE_SIZE);
+    appendBigEndian(data, SEGMENT_BENCHMARK_IMAGE_SIZE);
+
+    for(uint32_t image = 0; image < SEGMENT_BENCHMARK_IMAGES; image++)
+    {
+        const int32_t centerX = size / 2 + static_cast<int32_t>(nextRandom(state) % 7) - 3;
+        const int32_t centerY = size / 2 + static_cast<int32_t>(nextRandom(state) % 7) - 3;
+        const int32_t radius = 5 + static_cast<int32_t>(nextRandom(state) % 5);
+
+        for(int32_t y = 0; y < size; y++)
+        {
+            for(int32_t x = 0; x < size; x++)
+            {
+                const int32_t distance = (x - centerX) * (x - centerX)
+                                         + (y - centerY) * (y - centerY);
+                uint8_t pixel = 0;
+                if(distance < radius * radius)
+                {
+                    // bright inside with noisy and blurred edges
+                    const int32_t value = 255 - distance * 200 / (radius * radius)
+                                          - static_cast<int32_t>(nextRandom(state) % 40);
+                    pixel = static_cast<uint8_t>(std::max(value, 0));
+                }
+                data.push_back(pixel);
+            }
+        }
+    }
+}
+
+/**
+ * @brief create a label-file in idx-format with 8 bytes header and one byte per label
+ *
+ * @param data buffer for the content of the file
+ */
+void
+SegmentCompression_Benchmark::createIdxLabels(std::vector<uint8_t> &data)
+{
+    uint64_t state = 42;
+
+    data.clear();
+    appendBigEndian(data, 0x00000801);
+    appendBigEndian(data, SEGMENT_BENCHMARK_IMAGES);
+
+    for(uint32_t image = 0; image < SEGMENT_BENCHMARK_IMAGES; image++) {
+        data.push_back(static_cast<uint8_t>(nextRandom(state) % 10));
+    }
+}
+
+/**
+ * @brief compress and decompress the data segment by segment like the upload and the server.
+ *        Segments, which don't become smaller, are send uncompressed.
+ *
+ * @param name name of the run for the output
+ * @param data content of the file
+ * @param compression compression-algorithm
+ */
+void
+SegmentCompression_Benchmark::runCompression(const std::string &name,
+                                             const std::vector<uint8_t> &data,
+                                             const UploadCompression compression)
+{
+    const uint64_t numberOfSegments = (data.size() + SEGMENT_BENCHMARK_SEGMENT_SIZE - 1)
+                                      / SEGMENT_BENCHMARK_SEGMENT_SIZE;
+    std::vector<std::vector<uint8_t>> segments(numberOfSegments);
+    std::vector<uint64_t> compressedSizes(numberOfSegments, 0);
+    std::vector<uint8_t> buffer;
+    uint64_t numberOfBytes = 0;
+
+    // compress
+    const std::chrono::steady_clock::time_point compressStart = std::chrono::steady_clock::now();
+    for(uint32_t run = 0; run < SEGMENT_BENCHMARK_NUMBER_OF_RUNS; run++)
+    {
+        numberOfBytes = 0;
+        for(uint64_t i = 0; i < numberOfSegments; i++)
+        {
+            const uint64_t offset = i * SEGMENT_BENCHMARK_SEGMENT_SIZE;
+            const uint64_t rawSize = std::min(static_cast<uint64_t>(SEGMENT_BENCHMARK_SEGMENT_SIZE),
+                                              data.size() - offset);
+            compressedSizes[i] = compressSegment(segments[i],
+                                                 &data[offset],
+                                                 rawSize,
+                                                 compression);
+            numberOfBytes += compressedSizes[i] == 0 ? rawSize : compressedSizes[i];
+        }
+    }
+    const std::chrono::duration<double> compressDuration = std::chrono::steady_clock::now()
+                                                           - compressStart;
+
+    // decompress
+    bool success = true;
+    const std::chrono::steady_clock::time_point decompressStart = std::chrono::steady_clock::now();
+    for(uint32_t run = 0; run < SEGMENT_BENCHMARK_NUMBER_OF_RUNS; run++)
+    {
+        for(uint64_t i = 0; i < numberOfSegments; i++)
+        {
+            const uint64_t offset = i * SEGMENT_BENCHMARK_SEGMENT_SIZE;
+            const uint64_t rawSize = std::min(static_cast<uint64_t>(SEGMENT_BENCHMARK_SEGMENT_SIZE),
+                                              data.size() - offset);
+            Kitsunemimi::ErrorContainer error;
+            if(compressedSizes[i] == 0)
+            {
+                success &= decompressSegment(buffer,
+                                             &data[offset],
+                                             rawSize,
+                                             rawSize,
+                                             NO_COMPRESSION,
+                                             error);
+            }
+            else
+            {
+                success &= decompressSegment(buffer,
+                                             &segments[i][0],
+                                             compressedSizes[i],
+                                             rawSize,
+                                             compression,
+                                             error);
+            }
+            success &= memcmp(&buffer[0], &data[offset], rawSize) == 0;
+        }
+    }
+    const std::chrono::duration<double> decompressDuration = std::chrono::steady_clock::now()
+                                                             - decompressStart;
+
+    if(success == false)
+    {
+        std::cout << name << ": failed to decompress segments" << std::endl;
+        return;
+    }
+
+    const double megaBytes = static_cast<double>(data.size()) * SEGMENT_BENCHMARK_NUMBER_OF_RUNS
+                             / (1024.0 * 1024.0);
+    std::cout << "    " << std::setw(18) << std::left << name
+              << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << static_cast<double>(data.size()) / (1024.0 * 1024.0)
+              << " MiB"
+              << std::setw(8) << static_cast<double>(data.size()) / numberOfBytes
+              << " ratio"
+              << std::setprecision(1)
+              << std::setw(10) << megaBytes / compressDuration.count()
+              << " MiB/s compress"
+              << std::setw(10) << megaBytes / decompressDuration.count()
+              << " MiB/s decompress" << std::endl;
+}
+
+} // namespace HanamiAI
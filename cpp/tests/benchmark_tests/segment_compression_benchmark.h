@@ -0,0 +1,56 @@
+/**
+ * @file        segment_compression_benchmark.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#ifndef KITSUNEMIMI_HANAMISDK_SEGMENT_COMPRESSION_BENCHMARK_H
+#define KITSUNEMIMI_HANAMISDK_SEGMENT_COMPRESSION_BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include <libHanamiAiSdk/data_set.h>
+
+namespace HanamiAI
+{
+
+/**
+ * @brief Measures ratio and speed of the compression of uploads, which compresses each segment
+ *        on its own, for a csv-file and the files of a mnist-like dataset in idx-format.
+ */
+class SegmentCompression_Benchmark
+{
+public:
+    SegmentCompression_Benchmark();
+
+private:
+    void createCsv(std::vector<uint8_t> &data);
+    void createIdxImages(std::vector<uint8_t> &data);
+    void createIdxLabels(std::vector<uint8_t> &data);
+    void runCompression(const std::string &name,
+                        const std::vector<uint8_t> &data,
+                        const UploadCompression compression);
+};
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_SEGMENT_COMPRESSION_BENCHMARK_H
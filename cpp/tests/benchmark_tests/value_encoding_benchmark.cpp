@@ -0,0 +1,185 @@
+/**
+ * @file        value_encoding_benchmark.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "value_encoding_benchmark.h"
+
+#include <libHanamiAiSdk/prepared_request.h>
+#include <common/encoded_values.h>
+#include <common/direct_io_messages.h>
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string.h>
+
+// input-size of a mnist-image and number of samples of each run
+#define BENCHMARK_NUMBER_OF_VALUES 784
+#define BENCHMARK_NUMBER_OF_SAMPLES 1000
+#define BENCHMARK_NUMBER_OF_RUNS 20
+
+namespace HanamiAI
+{
+
+/**
+ * @brief get seconds since a point in time
+ */
+double
+getSecondsSince(const std::chrono::steady_clock::time_point start)
+{
+    const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+    return duration.count();
+}
+
+ValueEncoding_Benchmark::ValueEncoding_Benchmark()
+{
+    createSamples();
+
+    std::cout << "value-encodings with " << BENCHMARK_NUMBER_OF_VALUES
+              << " values per sample:" << std::endl;
+    runEncoding("fp32", FP32_ENCODING, false);
+    runEncoding("fp16", FP16_ENCODING, false);
+    runEncoding("bf16", BF16_ENCODING, false);
+    runEncoding("int8", INT8_ENCODING, false);
+    runEncoding("sparse", FP32_ENCODING, true);
+}
+
+/**
+ * @brief create samples, which look like mnist-images with a blob of pixels in the middle, so
+ *        about 20 percent of the values are not zero
+ */
+void
+ValueEncoding_Benchmark::createSamples()
+{
+    uint64_t state = 42;
+    m_samples.resize(BENCHMARK_NUMBER_OF_SAMPLES);
+
+    for(std::vector<float> &sample : m_samples)
+    {
+        sample.resize(BENCHMARK_NUMBER_OF_VALUES);
+        for(uint64_t i = 0; i < BENCHMARK_NUMBER_OF_VALUES; i++)
+        {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            const uint64_t x = i % 28;
+            const uint64_t y = i / 28;
+            if(x >= 6 && x < 22 && y >= 4 && y < 24 && (state >> 63) != 0) {
+                sample[i] = static_cast<float>((state >> 33) % 256) / 255.0f;
+            } else {
+                sample[i] = 0.0f;
+            }
+        }
+    }
+}
+
+/**
+ * @brief fill all samples into a prepared request and decode the frames like the server
+ *
+ * @param name name of the encoding for the output
+ * @param encoding encoding to measure
+ * @param sparse true to enable the sparse-encoding
+ */
+void
+ValueEncoding_Benchmark::runEncoding(const std::string &name,
+                                     const ValueEncoding encoding,
+                                     const bool sparse)
+{
+    PreparedRequest prepared(REQUEST_INPUT_PREPARED, "input");
+    prepared.setEncoding(encoding);
+    prepared.setSparseEncoding(sparse);
+
+    DirectIoMessages messages;
+    std::vector<float> decoded(BENCHMARK_NUMBER_OF_VALUES);
+    std::vector<std::vector<uint8_t>> frames(m_samples.size());
+    uint64_t numberOfBytes = 0;
+
+    // encode
+    const std::chrono::steady_clock::time_point encodeStart = std::chrono::steady_clock::now();
+    for(uint32_t run = 0; run < BENCHMARK_NUMBER_OF_RUNS; run++)
+    {
+        numberOfBytes = 0;
+        for(uint64_t i = 0; i < m_samples.size(); i++)
+        {
+            uint64_t frameSize = 0;
+            const uint8_t* frame = prepared.fill(m_samples[i].data(),
+                                                 m_samples[i].size(),
+                                                 frameSize);
+            frames[i].assign(frame, frame + frameSize);
+            numberOfBytes += frameSize;
+        }
+    }
+    const double encodeDuration = getSecondsSince(encodeStart);
+
+    // decode
+    bool success = true;
+    const std::chrono::steady_clock::time_point decodeStart = std::chrono::steady_clock::now();
+    for(uint32_t run = 0; run < BENCHMARK_NUMBER_OF_RUNS; run++)
+    {
+        for(const std::vector<uint8_t> &frame : frames)
+        {
+            success &= messages.response.ParseFromArray(frame.data(),
+                                                        static_cast<int>(frame.size()));
+            if(messages.response.values_size() > 0)
+            {
+                memcpy(decoded.data(),
+                       messages.response.values().data(),
+                       BENCHMARK_NUMBER_OF_VALUES * sizeof(float));
+            }
+            else
+            {
+                EncodedValues encoded;
+                success &= parseEncodedValues(encoded, frame.data(), frame.size());
+                success &= decodeEncodedValues(decoded.data(), encoded);
+            }
+        }
+    }
+    const double decodeDuration = getSecondsSince(decodeStart);
+
+    if(success == false)
+    {
+        std::cout << name << ": failed to decode frames" << std::endl;
+        return;
+    }
+
+    printResult(name, numberOfBytes, encodeDuration, decodeDuration);
+}
+
+/**
+ * @brief print bytes per sample and samples per second of a run
+ */
+void
+ValueEncoding_Benchmark::printResult(const std::string &name,
+                                     const uint64_t numberOfBytes,
+                                     const double encodeDuration,
+                                     const double decodeDuration)
+{
+    const double numberOfSamples = static_cast<double>(m_samples.size())
+                                   * BENCHMARK_NUMBER_OF_RUNS;
+
+    std::cout << "    " << std::setw(8) << std::left << name
+              << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << static_cast<double>(numberOfBytes) / m_samples.size()
+              << " bytes/sample"
+              << std::setw(14) << numberOfSamples / encodeDuration << " encoded samples/s"
+              << std::setw(14) << numberOfSamples / decodeDuration << " decoded samples/s"
+              << std::endl;
+}
+
+} // namespace HanamiAI
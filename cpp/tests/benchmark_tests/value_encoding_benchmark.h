@@ -0,0 +1,60 @@
+/**
+ * @file        value_encoding_benchmark.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMISDK_VALUE_ENCODING_BENCHMARK_H
+#define KITSUNEMIMI_HANAMISDK_VALUE_ENCODING_BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include <libHanamiAiSdk/value_encoding.h>
+
+namespace HanamiAI
+{
+class PreparedRequest;
+
+/**
+ * @brief Compares the size of the frames and the number of samples per second, which can be
+ *        encoded and decoded, of the value-encodings of the direct-io against plain fp32.
+ */
+class ValueEncoding_Benchmark
+{
+public:
+    ValueEncoding_Benchmark();
+
+private:
+    std::vector<std::vector<float>> m_samples;
+
+    void createSamples();
+    void runEncoding(const std::string &name,
+                     const ValueEncoding encoding,
+                     const bool sparse);
+    void printResult(const std::string &name,
+                     const uint64_t numberOfBytes,
+                     const double encodeDuration,
+                     const double decodeDuration);
+};
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_VALUE_ENCODING_BENCHMARK_H
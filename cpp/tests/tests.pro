@@ -3,5 +3,5 @@ CONFIG += ordered
 QT -= qt core gui
 CONFIG += c++17
 
-
-tests.depends = src
+SUBDIRS = unit_tests \
+          benchmark_tests
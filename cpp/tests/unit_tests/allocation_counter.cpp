@@ -0,0 +1,71 @@
+/**
+ * @file        allocation_counter.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <allocation_counter.h>
+
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+namespace HanamiAI
+{
+std::atomic<uint64_t> g_numberOfAllocations {0};
+
+/**
+ * @brief get number of heap-allocations of the test-process, which were made over the global
+ *        new-operator until now
+ */
+uint64_t
+getNumberOfAllocations()
+{
+    return g_numberOfAllocations.load(std::memory_order_relaxed);
+}
+
+} // namespace HanamiAI
+
+/**
+ * @brief replacement of the global new-operator, which counts all allocations
+ */
+void*
+operator new(std::size_t size)
+{
+    HanamiAI::g_numberOfAllocations.fetch_add(1, std::memory_order_relaxed);
+
+    void* ptr = malloc(size == 0 ? 1 : size);
+    if(ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    return ptr;
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void
+operator delete(void* ptr, std::size_t) noexcept
+{
+    free(ptr);
+}
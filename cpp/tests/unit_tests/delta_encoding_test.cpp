@@ -0,0 +1,206 @@
+/**
+ * @file        delta_encoding_test.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "delta_encoding_test.h"
+
+#include <libHanamiAiSdk/delta_encoding.h>
+#include <libHanamiAiSdk/prepared_request.h>
+#include <common/encoded_values.h>
+#include <common/direct_io_messages.h>
+
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+namespace HanamiAI
+{
+
+/**
+ * @brief get a window of a synthetic time-series
+ */
+std::vector<float>
+getWindow(const uint64_t start,
+          const uint64_t size)
+{
+    std::vector<float> window(size);
+    for(uint64_t i = 0; i < size; i++) {
+        window[i] = sinf(static_cast<float>(start + i) * 0.1f);
+    }
+    return window;
+}
+
+DeltaEncoding_Test::DeltaEncoding_Test()
+    : Kitsunemimi::CompareTestHelper("DeltaEncoding_Test")
+{
+    deltaEncoding_slidingWindow_test();
+    deltaEncoding_emptyVector_test();
+    deltaEncoding_brokenFrame_test();
+    preparedRequest_deltaFrame_test();
+}
+
+/**
+ * deltaEncoding_slidingWindow_test
+ */
+void
+DeltaEncoding_Test::deltaEncoding_slidingWindow_test()
+{
+    DeltaEncoder encoder(16, 4);
+    DeltaDecoder decoder;
+    std::vector<uint8_t> frame(encoder.getMaxFrameSize(100));
+    std::vector<float> decoded(100);
+
+    uint64_t numberOfKeyframes = 0;
+    bool allEqual = true;
+    bool allDecoded = true;
+    for(uint64_t step = 0; step < 100; step++)
+    {
+        const std::vector<float> window = getWindow(step * 3, 100);
+        const uint64_t frameSize = encoder.encode(frame.data(), window.data(), window.size());
+        if(frameSize == encoder.getMaxFrameSize(100)) {
+            numberOfKeyframes++;
+        } else {
+            allEqual &= frameSize < 50;
+        }
+
+        allDecoded &= decoder.decode(decoded.data(), frame.data(), frameSize, window.size());
+        allEqual &= memcmp(decoded.data(), window.data(), window.size() * sizeof(float)) == 0;
+    }
+
+    TEST_EQUAL(allDecoded, true);
+    TEST_EQUAL(allEqual, true);
+    TEST_EQUAL(numberOfKeyframes, 7);
+
+    // a shift larger than the maximum shift falls back to a keyframe
+    const std::vector<float> window = getWindow(1000, 100);
+    const uint64_t frameSize = encoder.encode(frame.data(), window.data(), window.size());
+    TEST_EQUAL(frameSize, encoder.getMaxFrameSize(100));
+    TEST_EQUAL(decoder.decode(decoded.data(), frame.data(), frameSize, window.size()), true);
+    TEST_EQUAL(memcmp(decoded.data(), window.data(), window.size() * sizeof(float)), 0);
+}
+
+/**
+ * deltaEncoding_emptyVector_test
+ */
+void
+DeltaEncoding_Test::deltaEncoding_emptyVector_test()
+{
+    DeltaEncoder encoder;
+    DeltaDecoder decoder;
+    std::vector<uint8_t> frame(encoder.getMaxFrameSize(10));
+    float decoded[10];
+
+    // empty vectors before and after a filled one
+    uint64_t frameSize = encoder.encode(frame.data(), nullptr, 0);
+    TEST_EQUAL(frameSize, encoder.getMaxFrameSize(0));
+    TEST_EQUAL(decoder.decode(decoded, frame.data(), frameSize, 0), true);
+
+    const std::vector<float> window = getWindow(0, 10);
+    frameSize = encoder.encode(frame.data(), window.data(), window.size());
+    TEST_EQUAL(decoder.decode(decoded, frame.data(), frameSize, window.size()), true);
+
+    frameSize = encoder.encode(frame.data(), nullptr, 0);
+    TEST_EQUAL(frameSize, encoder.getMaxFrameSize(0));
+    TEST_EQUAL(decoder.decode(decoded, frame.data(), frameSize, 0), true);
+    frameSize = encoder.encode(frame.data(), nullptr, 0);
+    TEST_EQUAL(decoder.decode(decoded, frame.data(), frameSize, 0), true);
+}
+
+/**
+ * deltaEncoding_brokenFrame_test
+ */
+void
+DeltaEncoding_Test::deltaEncoding_brokenFrame_test()
+{
+    DeltaEncoder encoder;
+    DeltaDecoder decoder;
+    std::vector<uint8_t> keyframe(encoder.getMaxFrameSize(100));
+    std::vector<uint8_t> delta(encoder.getMaxFrameSize(100));
+    std::vector<float> decoded(100);
+
+    const std::vector<float> first = getWindow(0, 100);
+    const std::vector<float> second = getWindow(1, 100);
+    const uint64_t keyframeSize = encoder.encode(keyframe.data(), first.data(), 100);
+    const uint64_t deltaSize = encoder.encode(delta.data(), second.data(), 100);
+    TEST_EQUAL(deltaSize < keyframeSize, true);
+
+    // delta without previous keyframe
+    TEST_EQUAL(decoder.decode(decoded.data(), delta.data(), deltaSize, 100), false);
+    TEST_EQUAL(decoder.decode(decoded.data(), keyframe.data(), keyframeSize, 100), true);
+
+    // index of the last change out of range
+    std::vector<uint8_t> broken = delta;
+    const uint32_t badIndex = 100;
+    memcpy(&broken[deltaSize - 8], &badIndex, 4);
+    TEST_EQUAL(decoder.decode(decoded.data(), broken.data(), deltaSize, 100), false);
+
+    // truncated frame and wrong number of values
+    TEST_EQUAL(decoder.decode(decoded.data(), delta.data(), deltaSize - 1, 100), false);
+    TEST_EQUAL(decoder.decode(decoded.data(), delta.data(), deltaSize, 99), false);
+
+    // the broken frames didn't change the state, so the valid delta still fits
+    TEST_EQUAL(decoder.decode(decoded.data(), delta.data(), deltaSize, 100), true);
+    TEST_EQUAL(memcmp(decoded.data(), second.data(), 100 * sizeof(float)), 0);
+}
+
+/**
+ * preparedRequest_deltaFrame_test
+ */
+void
+DeltaEncoding_Test::preparedRequest_deltaFrame_test()
+{
+    PreparedRequest prepared(REQUEST_INPUT_PREPARED, "input");
+    prepared.setDeltaEncoding(true);
+    ClusterIO_Message message;
+    DeltaDecoder decoder;
+    EncodedValues encoded;
+    std::vector<float> decoded(784);
+    uint64_t frameSize = 0;
+
+    for(uint64_t step = 0; step < 3; step++)
+    {
+        const std::vector<float> window = getWindow(step, 784);
+        const uint8_t* frame = prepared.fill(window.data(), window.size(), frameSize);
+        if(step > 0) {
+            TEST_EQUAL(frameSize < 100, true);
+        }
+
+        // the frame is still a valid message
+        TEST_EQUAL(message.ParseFromArray(frame, static_cast<int>(frameSize)), true);
+        TEST_EQUAL(message.numberofvalues(), window.size());
+        TEST_EQUAL(message.values_size(), 0);
+
+        TEST_EQUAL(parseEncodedValues(encoded, frame, frameSize), true);
+        TEST_EQUAL(encoded.encoding, DELTA_ENCODING);
+        TEST_EQUAL(decodeEncodedValues(decoded.data(), encoded), false);
+        TEST_EQUAL(decodeEncodedValues(decoded.data(), encoded, &decoder), true);
+        TEST_EQUAL(memcmp(decoded.data(), window.data(), window.size() * sizeof(float)), 0);
+    }
+
+    // after disabling, the values are send as normal fp32-values again
+    prepared.setDeltaEncoding(false);
+    const std::vector<float> window = getWindow(3, 784);
+    const uint8_t* frame = prepared.fill(window.data(), window.size(), frameSize);
+    TEST_EQUAL(message.ParseFromArray(frame, static_cast<int>(frameSize)), true);
+    TEST_EQUAL(message.values_size(), 784);
+}
+
+} // namespace HanamiAI
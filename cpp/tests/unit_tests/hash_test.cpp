@@ -0,0 +1,128 @@
+/**
+ * @file        hash_test.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "hash_test.h"
+
+#include <common/hash.h>
+#include <common/content_hash.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace HanamiAI
+{
+
+/**
+ * @brief create pseudo-random test-data
+ */
+std::vector<uint8_t>
+createTestData(const uint64_t size)
+{
+    std::vector<uint8_t> data(size);
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for(uint64_t i = 0; i < size; i++)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        data[i] = static_cast<uint8_t>(state >> 56);
+    }
+
+    return data;
+}
+
+Hash_Test::Hash_Test()
+    : Kitsunemimi::CompareTestHelper("Hash_Test")
+{
+    hashBytes_swappedStripes_test();
+    hashBytes_seeds_test();
+    hashContent_swappedChunks_test();
+}
+
+/**
+ * hashBytes_swappedStripes_test
+ */
+void
+Hash_Test::hashBytes_swappedStripes_test()
+{
+    const std::vector<uint8_t> data = createTestData(4096);
+    const uint64_t hash = hashBytes(data.data(), data.size());
+
+    // swap 32-byte blocks within the same block of stripes and over multiple blocks
+    const uint64_t positions[4][2] = {{0, 32}, {0, 480}, {64, 544}, {1024, 4064}};
+    for(const auto &position : positions)
+    {
+        std::vector<uint8_t> swapped = data;
+        std::swap_ranges(swapped.begin() + position[0],
+                         swapped.begin() + position[0] + 32,
+                         swapped.begin() + position[1]);
+        TEST_NOT_EQUAL(hashBytes(swapped.data(), swapped.size()), hash);
+    }
+
+    // swap the 8-byte words within a single stripe
+    std::vector<uint8_t> swapped = data;
+    std::swap_ranges(swapped.begin(), swapped.begin() + 8, swapped.begin() + 8);
+    TEST_NOT_EQUAL(hashBytes(swapped.data(), swapped.size()), hash);
+}
+
+/**
+ * hashBytes_seeds_test
+ */
+void
+Hash_Test::hashBytes_seeds_test()
+{
+    const std::vector<uint8_t> data = createTestData(4096);
+
+    // the halves of a 128-bit hash must not have a fixed relation to each other
+    uint64_t firstDiff = 0;
+    bool sameDiff = true;
+    for(uint64_t size = 1; size < 1024; size += 13)
+    {
+        const uint64_t diff = hashBytes(data.data(), size, 0) ^ hashBytes(data.data(), size, 1);
+        TEST_NOT_EQUAL(diff, 0);
+        if(size == 1) {
+            firstDiff = diff;
+        } else {
+            sameDiff &= diff == firstDiff;
+        }
+    }
+    TEST_EQUAL(sameDiff, false);
+}
+
+/**
+ * hashContent_swappedChunks_test
+ */
+void
+Hash_Test::hashContent_swappedChunks_test()
+{
+    // two chunks of 4 MiB, which are hashed independently
+    const uint64_t chunkSize = 4 * 1024 * 1024;
+    const std::vector<uint8_t> data = createTestData(2 * chunkSize);
+
+    std::vector<uint8_t> swapped(data.begin() + chunkSize, data.end());
+    swapped.insert(swapped.end(), data.begin(), data.begin() + chunkSize);
+
+    const std::string hash = hashContent(data.data(), data.size(), 2);
+    TEST_EQUAL(hash.size(), 32);
+    TEST_EQUAL(hashContent(data.data(), data.size(), 1), hash);
+    TEST_NOT_EQUAL(hashContent(swapped.data(), swapped.size(), 2), hash);
+}
+
+} // namespace HanamiAI
@@ -0,0 +1,45 @@
+/**
+ * @file        hash_test.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_HANAMISDK_HASH_TEST_H
+#define KITSUNEMIMI_HANAMISDK_HASH_TEST_H
+
+#include <libKitsunemimiCommon/test_helper/compare_test_helper.h>
+
+namespace HanamiAI
+{
+
+class Hash_Test
+        : public Kitsunemimi::CompareTestHelper
+{
+public:
+    Hash_Test();
+
+private:
+    void hashBytes_swappedStripes_test();
+    void hashBytes_seeds_test();
+    void hashContent_swappedChunks_test();
+};
+
+} // namespace HanamiAI
+
+#endif // KITSUNEMIMI_HANAMISDK_HASH_TEST_H
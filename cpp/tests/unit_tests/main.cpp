@@ -0,0 +1,47 @@
+/**
+ * @file        main.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "prepared_request_test.h"
+#include "hash_test.h"
+#include "value_encoding_test.h"
+#include "delta_encoding_test.h"
+#include "upload_journal_test.h"
+#include "upload_source_test.h"
+#include "segment_compression_test.h"
+#include "segment_size_tuner_test.h"
+#include "upload_streams_test.h"
+
+int
+main()
+{
+    HanamiAI::PreparedRequest_Test();
+    HanamiAI::Hash_Test();
+    HanamiAI::ValueEncoding_Test();
+    HanamiAI::DeltaEncoding_Test();
+    HanamiAI::UploadJournal_Test();
+    HanamiAI::UploadSource_Test();
+    HanamiAI::SegmentCompression_Test();
+    HanamiAI::SegmentSizeTuner_Test();
+    HanamiAI::UploadStreams_Test();
+
+    return 0;
+}
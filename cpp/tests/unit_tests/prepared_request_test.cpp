@@ -0,0 +1,191 @@
+/**
+ * @file        prepared_request_test.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "prepared_request_test.h"
+#include <allocation_counter.h>
+
+#include <libHanamiAiSdk/prepared_request.h>
+#include <common/direct_io_messages.h>
+
+#include <string.h>
+#include <vector>
+
+namespace HanamiAI
+{
+
+/**
+ * @brief parse a frame of a prepared request and check, if it contains the given values
+ */
+bool
+checkFrame(ClusterIO_Message &message,
+           const uint8_t* frame,
+           const uint64_t frameSize,
+           const std::vector<float> &values)
+{
+    if(message.ParseFromArray(frame, static_cast<int>(frameSize)) == false) {
+        return false;
+    }
+
+    if(message.numberofvalues() != values.size()
+            || static_cast<uint64_t>(message.values_size()) != values.size())
+    {
+        return false;
+    }
+
+    return values.size() == 0
+           || memcmp(message.values().data(), values.data(), values.size() * sizeof(float)) == 0;
+}
+
+PreparedRequest_Test::PreparedRequest_Test()
+    : Kitsunemimi::CompareTestHelper("PreparedRequest_Test")
+{
+    fill_test();
+    fill_multiMegabyte_test();
+    fill_noAllocation_test();
+    fill_tooBig_test();
+}
+
+/**
+ * fill_test
+ */
+void
+PreparedRequest_Test::fill_test()
+{
+    PreparedRequest prepared(LEARN_SHOULD_PREPARED, "output");
+    ClusterIO_Message message;
+    uint64_t frameSize = 0;
+
+    // changing number of values, including an empty payload
+    for(const uint64_t numberOfValues : {784, 10, 0, 10})
+    {
+        std::vector<float> values(numberOfValues);
+        for(uint64_t i = 0; i < numberOfValues; i++) {
+            values[i] = static_cast<float>(i) * 0.25f;
+        }
+
+        const uint8_t* frame = prepared.fill(values.data(), values.size(), frameSize);
+        TEST_EQUAL(checkFrame(message, frame, frameSize, values), true);
+        TEST_EQUAL(message.segmentname(), "output");
+        TEST_EQUAL(message.islast(), true);
+        TEST_EQUAL(message.processtype(), ClusterProcessType::LEARN_TYPE);
+        TEST_EQUAL(message.datatype(), ClusterDataType::SHOULD_TYPE);
+    }
+}
+
+/**
+ * fill_multiMegabyte_test
+ */
+void
+PreparedRequest_Test::fill_multiMegabyte_test()
+{
+    PreparedRequest prepared(REQUEST_INPUT_PREPARED, "input");
+    ClusterIO_Message message;
+    uint64_t frameSize = 0;
+
+    // 16 MiB of values, which is far more than the old fixed buffer of 96 KiB
+    std::vector<float> bigValues(4 * 1024 * 1024);
+    for(uint64_t i = 0; i < bigValues.size(); i++) {
+        bigValues[i] = static_cast<float>(i % 1000) - 500.0f;
+    }
+
+    const uint8_t* frame = prepared.fill(bigValues.data(), bigValues.size(), frameSize);
+    TEST_EQUAL(frameSize > bigValues.size() * sizeof(float), true);
+    TEST_EQUAL(checkFrame(message, frame, frameSize, bigValues), true);
+
+    // shrink and grow again with the same prepared request
+    std::vector<float> smallValues(100, 1.5f);
+    frame = prepared.fill(smallValues.data(), smallValues.size(), frameSize);
+    TEST_EQUAL(checkFrame(message, frame, frameSize, smallValues), true);
+
+    bigValues[bigValues.size() - 1] = 42.0f;
+    frame = prepared.fill(bigValues.data(), bigValues.size(), frameSize);
+    TEST_EQUAL(checkFrame(message, frame, frameSize, bigValues), true);
+}
+
+/**
+ * fill_noAllocation_test
+ */
+void
+PreparedRequest_Test::fill_noAllocation_test()
+{
+    PreparedRequest prepared(LEARN_INPUT_PREPARED, "input");
+    DirectIoMessages messages;
+    uint64_t frameSize = 0;
+
+    std::vector<float> values(1024 * 1024);
+    for(uint64_t i = 0; i < values.size(); i++) {
+        values[i] = static_cast<float>(i);
+    }
+
+    // warm up the frame and the capacity of the reused response-message
+    const uint8_t* frame = prepared.fill(values.data(), values.size(), frameSize);
+    TEST_EQUAL(checkFrame(messages.response, frame, frameSize, values), true);
+
+    // steady state of the io-loop, where outgoing frames are written and responses are parsed
+    bool success = true;
+    const uint64_t allocationsBefore = getNumberOfAllocations();
+    for(uint64_t i = 0; i < 100; i++)
+    {
+        values[i] = -1.0f;
+        frame = prepared.fill(values.data(), values.size(), frameSize);
+        success &= messages.response.ParseFromArray(frame, static_cast<int>(frameSize));
+    }
+    const uint64_t numberOfAllocations = getNumberOfAllocations() - allocationsBefore;
+
+    TEST_EQUAL(success, true);
+    TEST_EQUAL(numberOfAllocations, 0);
+}
+
+/**
+ * fill_tooBig_test
+ */
+void
+PreparedRequest_Test::fill_tooBig_test()
+{
+    PreparedRequest prepared(REQUEST_INPUT_PREPARED, "input");
+    ClusterIO_Message message;
+    uint64_t frameSize = 42;
+
+    // the size is checked before any value is read, so a few values are enough as input
+    const std::vector<float> values(8, 1.0f);
+    const uint64_t tooManyValues = 1ULL << 31;
+    const ValueEncoding encodings[3] = {FP32_ENCODING, FP16_ENCODING, DELTA_ENCODING};
+    for(const ValueEncoding encoding : encodings)
+    {
+        prepared.setEncoding(encoding);
+        TEST_EQUAL(prepared.fill(values.data(), tooManyValues, frameSize) == nullptr, true);
+        TEST_EQUAL(frameSize, 0);
+
+        // a failed call doesn't break the following ones
+        const uint8_t* frame = prepared.fill(values.data(), values.size(), frameSize);
+        TEST_EQUAL(frame != nullptr, true);
+        TEST_EQUAL(message.ParseFromArray(frame, static_cast<int>(frameSize)), true);
+        TEST_EQUAL(message.numberofvalues(), values.size());
+    }
+
+    // fp32-values with 2 GiB and a number, where the size of the payload would overflow
+    prepared.setEncoding(FP32_ENCODING);
+    TEST_EQUAL(prepared.fill(values.data(), 1ULL << 29, frameSize) == nullptr, true);
+    TEST_EQUAL(prepared.fill(values.data(), 1ULL << 62, frameSize) == nullptr, true);
+}
+
+} // namespace HanamiAI
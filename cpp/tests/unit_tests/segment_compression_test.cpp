@@ -0,0 +1,168 @@
+/**
+ * @file        segment_compression_test.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "segment_compression_test.h"
+
+#include <common/segment_compression.h>
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace HanamiAI
+{
+
+/**
+ * @brief create csv-data, which are well compressible
+ */
+std::vector<uint8_t>
+createCsvSegment()
+{
+    std::string csv = "";
+    for(uint64_t i = 0; i < 10000; i++) {
+        csv += std::to_string(i % 97) + "," + std::to_string(i % 13) + ",0.5," + "\n";
+    }
+    return std::vector<uint8_t>(csv.begin(), csv.end());
+}
+
+SegmentCompression_Test::SegmentCompression_Test()
+    : Kitsunemimi::CompareTestHelper("SegmentCompression_Test")
+{
+    roundTrip_test();
+    incompressible_test();
+    brokenSegment_test();
+}
+
+/**
+ * roundTrip_test
+ */
+void
+SegmentCompression_Test::roundTrip_test()
+{
+    Kitsunemimi::ErrorContainer error;
+    const std::vector<uint8_t> raw = createCsvSegment();
+    const UploadCompression compressions[2] = {LZ4_COMPRESSION, ZSTD_COMPRESSION};
+
+    for(const UploadCompression compression : compressions)
+    {
+        std::vector<uint8_t> compressed;
+        const uint64_t compressedSize = compressSegment(compressed,
+                                                        raw.data(),
+                                                        raw.size(),
+                                                        compression);
+        TEST_EQUAL(compressedSize > 0, true);
+        TEST_EQUAL(compressedSize < raw.size() / 2, true);
+
+        std::vector<uint8_t> decompressed;
+        TEST_EQUAL(decompressSegment(decompressed,
+                                     compressed.data(),
+                                     compressedSize,
+                                     raw.size(),
+                                     compression,
+                                     error),
+                   true);
+        TEST_EQUAL(decompressed.size(), raw.size());
+        TEST_EQUAL(memcmp(decompressed.data(), raw.data(), raw.size()), 0);
+    }
+
+    // uncompressed segments are only copied
+    std::vector<uint8_t> copied;
+    TEST_EQUAL(decompressSegment(copied, raw.data(), raw.size(), raw.size(), NO_COMPRESSION, error),
+               true);
+    TEST_EQUAL(copied == raw, true);
+}
+
+/**
+ * incompressible_test
+ */
+void
+SegmentCompression_Test::incompressible_test()
+{
+    // random data don't become smaller, so they have to be send uncompressed
+    std::vector<uint8_t> raw(64 * 1024);
+    uint64_t state = 42;
+    for(uint8_t &value : raw)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        value = static_cast<uint8_t>(state >> 56);
+    }
+
+    std::vector<uint8_t> compressed;
+    TEST_EQUAL(compressSegment(compressed, raw.data(), raw.size(), LZ4_COMPRESSION), 0);
+    TEST_EQUAL(compressSegment(compressed, raw.data(), raw.size(), ZSTD_COMPRESSION), 0);
+    TEST_EQUAL(compressSegment(compressed, raw.data(), 0, ZSTD_COMPRESSION), 0);
+}
+
+/**
+ * brokenSegment_test
+ */
+void
+SegmentCompression_Test::brokenSegment_test()
+{
+    Kitsunemimi::ErrorContainer error;
+    const std::vector<uint8_t> raw = createCsvSegment();
+    const UploadCompression compressions[2] = {LZ4_COMPRESSION, ZSTD_COMPRESSION};
+
+    for(const UploadCompression compression : compressions)
+    {
+        std::vector<uint8_t> compressed;
+        const uint64_t compressedSize = compressSegment(compressed,
+                                                        raw.data(),
+                                                        raw.size(),
+                                                        compression);
+
+        // wrong raw size and truncated data
+        std::vector<uint8_t> decompressed;
+        TEST_EQUAL(decompressSegment(decompressed,
+                                     compressed.data(),
+                                     compressedSize,
+                                     raw.size() - 1,
+                                     compression,
+                                     error),
+                   false);
+        TEST_EQUAL(decompressSegment(decompressed,
+                                     compressed.data(),
+                                     compressedSize / 2,
+                                     raw.size(),
+                                     compression,
+                                     error),
+                   false);
+        TEST_EQUAL(decompressSegment(decompressed,
+                                     compressed.data(),
+                                     compressedSize,
+                                     0,
+                                     compression,
+                                     error),
+                   false);
+    }
+
+    std::vector<uint8_t> decompressed;
+    TEST_EQUAL(decompressSegment(decompressed,
+                                 raw.data(),
+                                 raw.size(),
+                                 raw.size() + 1,
+                                 NO_COMPRESSION,
+                                 error),
+               false);
+}
+
+} // namespace HanamiAI
@@ -0,0 +1,144 @@
+/**
+ * @file        segment_size_tuner_test.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#include "segment_size_tuner_test.h"
+
+#include <common/segment_size_tuner.h>
+
+namespace HanamiAI
+{
+
+/**
+ * @brief send a complete measurement-window with the current segment-size of the tuner
+ *
+ * @param tuner tuner to update
+ * @param sentBytes number of bytes, which were send until now, which is increased by the window
+ * @param now current time, which is increased by the duration of the window
+ * @param bytesPerSecond simulated throughput of the window
+ */
+void
+sendWindow(SegmentSizeTuner &tuner,
+           uint64_t &sentBytes,
+           std::chrono::steady_clock::time_point &now,
+           const double bytesPerSecond)
+{
+    const uint64_t windowSize = std::max(static_cast<uint64_t>(SEGMENT_TUNER_MIN_WINDOW),
+                                         tuner.getSegmentSize() * SEGMENT_TUNER_WINDOW_SEGMENTS);
+    sentBytes += windowSize;
+    now += std::chrono::microseconds(static_cast<int64_t>(windowSize * 1e6 / bytesPerSecond));
+    tuner.update(sentBytes, now);
+}
+
+SegmentSizeTuner_Test::SegmentSizeTuner_Test()
+    : Kitsunemimi::CompareTestHelper("SegmentSizeTuner_Test")
+{
+    fixedSize_test();
+    doubling_test();
+    fallback_test();
+}
+
+/**
+ * fixedSize_test
+ */
+void
+SegmentSizeTuner_Test::fixedSize_test()
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    uint64_t sentBytes = 0;
+
+    // without adaption the size never changes
+    SegmentSizeTuner tuner(96 * 1024, 4 * 1024 * 1024, false);
+    tuner.update(sentBytes, now);
+    for(uint32_t i = 0; i < 4; i++) {
+        sendWindow(tuner, sentBytes, now, 100e6 * (i + 1));
+    }
+    TEST_EQUAL(tuner.getSegmentSize(), 96 * 1024);
+
+    // the initial size is already the maximum
+    SegmentSizeTuner maxTuner(96 * 1024, 64 * 1024, true);
+    maxTuner.update(sentBytes, now);
+    sendWindow(maxTuner, sentBytes, now, 100e6);
+    TEST_EQUAL(maxTuner.getSegmentSize(), 96 * 1024);
+}
+
+/**
+ * doubling_test
+ */
+void
+SegmentSizeTuner_Test::doubling_test()
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    uint64_t sentBytes = 0;
+
+    SegmentSizeTuner tuner(64 * 1024, 512 * 1024, true);
+    tuner.update(sentBytes, now);
+    TEST_EQUAL(tuner.getSegmentSize(), 64 * 1024);
+
+    // no decision before the window is complete
+    sentBytes += 1024;
+    now += std::chrono::milliseconds(1);
+    tuner.update(sentBytes, now);
+    TEST_EQUAL(tuner.getSegmentSize(), 64 * 1024);
+
+    // doubled as long as the throughput increases, but never above the maximum
+    sendWindow(tuner, sentBytes, now, 100e6);
+    TEST_EQUAL(tuner.getSegmentSize(), 128 * 1024);
+    sendWindow(tuner, sentBytes, now, 200e6);
+    TEST_EQUAL(tuner.getSegmentSize(), 256 * 1024);
+    sendWindow(tuner, sentBytes, now, 300e6);
+    TEST_EQUAL(tuner.getSegmentSize(), 512 * 1024);
+    sendWindow(tuner, sentBytes, now, 400e6);
+    TEST_EQUAL(tuner.getSegmentSize(), 512 * 1024);
+
+    // the size is fixed, when the maximum is reached
+    sendWindow(tuner, sentBytes, now, 10e6);
+    TEST_EQUAL(tuner.getSegmentSize(), 512 * 1024);
+}
+
+/**
+ * fallback_test
+ */
+void
+SegmentSizeTuner_Test::fallback_test()
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    uint64_t sentBytes = 0;
+
+    SegmentSizeTuner tuner(64 * 1024, 4 * 1024 * 1024, true);
+    tuner.update(sentBytes, now);
+
+    sendWindow(tuner, sentBytes, now, 100e6);
+    TEST_EQUAL(tuner.getSegmentSize(), 128 * 1024);
+    sendWindow(tuner, sentBytes, now, 200e6);
+    TEST_EQUAL(tuner.getSegmentSize(), 256 * 1024);
+
+    // an increase below the minimal gain falls back to the best size
+    sendWindow(tuner, sentBytes, now, 200e6 * (SEGMENT_TUNER_MIN_GAIN - 0.02));
+    TEST_EQUAL(tuner.getSegmentSize(), 128 * 1024);
+
+    // the size stays fixed afterwards
+    sendWindow(tuner, sentBytes, now, 1000e6);
+    TEST_EQUAL(tuner.getSegmentSize(), 128 * 1024);
+}
+
+} // namespace HanamiAI
@@ -0,0 +1,59 @@
+include(../../defaults.pri)
+
+QT -= qt core gui
+
+CONFIG -= app_bundle
+CONFIG += c++17 console
+
+LIBS += -L../../src -lHanamiAiSdk
+LIBS += -L../../src/debug -lHanamiAiSdk
+LIBS += -L../../src/release -lHanamiAiSdk
+
+LIBS += -L../../../../libKitsunemimiHanamiCommon/src -lKitsunemimiHanamiCommon
+LIBS += -L../../../../libKitsunemimiHanamiCommon/src/debug -lKitsunemimiHanamiCommon
+LIBS += -L../../../../libKitsunemimiHanamiCommon/src/release -lKitsunemimiHanamiCommon
+INCLUDEPATH += ../../../../libKitsunemimiHanamiCommon/include
+
+LIBS += -L../../../../libKitsunemimiCrypto/src -lKitsunemimiCrypto
+LIBS += -L../../../../libKitsunemimiCrypto/src/debug -lKitsunemimiCrypto
+LIBS += -L../../../../libKitsunemimiCrypto/src/release -lKitsunemimiCrypto
+INCLUDEPATH += ../../../../libKitsunemimiCrypto/include
+
+LIBS += -L../../../../libKitsunemimiJson/src -lKitsunemimiJson
+LIBS += -L../../../../libKitsunemimiJson/src/debug -lKitsunemimiJson
+LIBS += -L../../../../libKitsunemimiJson/src/release -lKitsunemimiJson
+INCLUDEPATH += ../../../../libKitsunemimiJson/include
+
+LIBS += -L../../../../libKitsunemimiCommon/src -lKitsunemimiCommon
+LIBS += -L../../../../libKitsunemimiCommon/src/debug -lKitsunemimiCommon
+LIBS += -L../../../../libKitsunemimiCommon/src/release -lKitsunemimiCommon
+INCLUDEPATH += ../../../../libKitsunemimiCommon/include
+
+LIBS += -lprotobuf -lssl -lcryptopp -lcrypt -llz4 -lzstd -lpthread
+
+INCLUDEPATH += $$PWD
+
+HEADERS += \
+    allocation_counter.h \
+    delta_encoding_test.h \
+    hash_test.h \
+    prepared_request_test.h \
+    segment_compression_test.h \
+    segment_size_tuner_test.h \
+    upload_journal_test.h \
+    upload_source_test.h \
+    upload_streams_test.h \
+    value_encoding_test.h
+
+SOURCES += \
+    main.cpp \
+    allocation_counter.cpp \
+    delta_encoding_test.cpp \
+    hash_test.cpp \
+    prepared_request_test.cpp \
+    segment_compression_test.cpp \
+    segment_size_tuner_test.cpp \
+    upload_journal_test.cpp \
+    upload_source_test.cpp \
+    upload_streams_test.cpp \
+    value_encoding_test.cpp
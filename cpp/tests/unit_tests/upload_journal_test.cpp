@@ -0,0 +1,171 @@
+/**
+ * @file        upload_journal_test.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "upload_journal_test.h"
+
+#include <common/upload_journal.h>
+#include <common/upload_source.h>
+
+#include <fstream>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#define TEST_JOURNAL_PATH "/tmp/hanami_upload_journal_test.journal"
+#define TEST_FILE_PATH "/tmp/hanami upload journal test.csv"
+
+namespace HanamiAI
+{
+
+/**
+ * @brief write a local test-file
+ */
+void
+writeTestFile(const std::string &content)
+{
+    std::ofstream out(TEST_FILE_PATH, std::ofstream::trunc);
+    out << content;
+}
+
+UploadJournal_Test::UploadJournal_Test()
+    : Kitsunemimi::CompareTestHelper("UploadJournal_Test")
+{
+    saveLoad_test();
+    loadOldVersion_test();
+    readFileState_test();
+
+    remove(TEST_JOURNAL_PATH);
+    remove(TEST_FILE_PATH);
+}
+
+/**
+ * saveLoad_test
+ */
+void
+UploadJournal_Test::saveLoad_test()
+{
+    Kitsunemimi::ErrorContainer error;
+
+    JournalFile file;
+    file.fileUuid = "file-uuid";
+    file.filePath = TEST_FILE_PATH;
+    file.fileSize = 1000;
+    file.modificationTime = 1656720000123456789LL;
+    file.contentHash = "0123456789abcdef0123456789abcdef";
+
+    UploadJournal journal(TEST_JOURNAL_PATH);
+    journal.setDataset("dataset-uuid", "csv", "test data set");
+    journal.addFile(file);
+    journal.addSentRange("file-uuid", 100, 200);
+    TEST_EQUAL(journal.save(error), true);
+
+    UploadJournal loaded(TEST_JOURNAL_PATH);
+    TEST_EQUAL(loaded.load(error), true);
+    TEST_EQUAL(loaded.getDatasetUuid(), "dataset-uuid");
+    TEST_EQUAL(loaded.getDatasetType(), "csv");
+    TEST_EQUAL(loaded.getDatasetName(), "test data set");
+
+    const std::vector<JournalFile> files = loaded.getFiles();
+    TEST_EQUAL(files.size(), 1);
+    TEST_EQUAL(files[0].filePath, TEST_FILE_PATH);
+    TEST_EQUAL(files[0].fileSize, 1000);
+    TEST_EQUAL(files[0].modificationTime, 1656720000123456789LL);
+    TEST_EQUAL(files[0].contentHash, file.contentHash);
+    TEST_EQUAL(loaded.getMissingRanges("file-uuid").size(), 2);
+
+    // data-set without name
+    journal.setDataset("dataset-uuid", "csv", "");
+    TEST_EQUAL(journal.save(error), true);
+    TEST_EQUAL(loaded.load(error), true);
+    TEST_EQUAL(loaded.getDatasetName(), "");
+    TEST_EQUAL(loaded.getFiles().size(), 1);
+}
+
+/**
+ * loadOldVersion_test
+ */
+void
+UploadJournal_Test::loadOldVersion_test()
+{
+    Kitsunemimi::ErrorContainer error;
+
+    // journals of the first version don't have the state of the files and are rejected
+    {
+        std::ofstream out(TEST_JOURNAL_PATH, std::ofstream::trunc);
+        out << "hanami-upload-journal 1\n"
+            << "dataset dataset-uuid csv\n"
+            << "file file-uuid 1000 data.csv\n";
+    }
+
+    UploadJournal journal(TEST_JOURNAL_PATH);
+    TEST_EQUAL(journal.load(error), false);
+}
+
+/**
+ * readFileState_test
+ */
+void
+UploadJournal_Test::readFileState_test()
+{
+    Kitsunemimi::ErrorContainer error;
+    writeTestFile("1,2,3\n4,5,6\n");
+
+    JournalFile original;
+    {
+        UploadSource source;
+        TEST_EQUAL(source.initFile(TEST_FILE_PATH, error), true);
+        TEST_EQUAL(readFileState(original, source, 1, error), true);
+    }
+    TEST_EQUAL(original.filePath, TEST_FILE_PATH);
+    TEST_EQUAL(original.fileSize, 12);
+    TEST_NOT_EQUAL(original.contentHash, "");
+
+    // same content
+    JournalFile unchanged;
+    {
+        UploadSource source;
+        TEST_EQUAL(source.initFile(TEST_FILE_PATH, error), true);
+        TEST_EQUAL(readFileState(unchanged, source, 1, error), true);
+    }
+    TEST_EQUAL(unchanged.modificationTime, original.modificationTime);
+    TEST_EQUAL(unchanged.contentHash, original.contentHash);
+
+    // changed content with the same size and the old modification-time is detected by the hash
+    writeTestFile("1,2,3\n4,5,7\n");
+    struct timespec times[2];
+    times[0].tv_sec = original.modificationTime / 1000000000LL;
+    times[0].tv_nsec = original.modificationTime % 1000000000LL;
+    times[1] = times[0];
+    TEST_EQUAL(utimensat(AT_FDCWD, TEST_FILE_PATH, times, 0), 0);
+
+    JournalFile changed;
+    {
+        UploadSource source;
+        TEST_EQUAL(source.initFile(TEST_FILE_PATH, error), true);
+        TEST_EQUAL(readFileState(changed, source, 1, error), true);
+    }
+    TEST_EQUAL(changed.fileSize, original.fileSize);
+    TEST_EQUAL(changed.modificationTime, original.modificationTime);
+    TEST_NOT_EQUAL(changed.contentHash, original.contentHash);
+}
+
+} // namespace HanamiAI
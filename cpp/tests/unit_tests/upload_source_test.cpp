@@ -0,0 +1,316 @@
+/**
+ * @file        upload_source_test.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#include "upload_source_test.h"
+
+#include <common/upload_source.h>
+
+#include <fstream>
+#include <sstream>
+#include <streambuf>
+#include <algorithm>
+#include <string.h>
+#include <stdio.h>
+
+#define TEST_SOURCE_PATH "/tmp/hanami_upload_source_test.bin"
+
+namespace HanamiAI
+{
+
+/**
+ * @brief stream-buffer without support for seeking, like a pipe, which gives the data in
+ *        small pieces
+ */
+struct NonSeekableBuffer
+        : public std::streambuf
+{
+    std::string data;
+    uint64_t position = 0;
+
+    NonSeekableBuffer(const std::string &content)
+    {
+        data = content;
+    }
+
+    int_type underflow() override
+    {
+        if(position >= data.size()) {
+            return traits_type::eof();
+        }
+
+        const uint64_t size = std::min(static_cast<uint64_t>(7), data.size() - position);
+        setg(&data[position], &data[position], &data[position] + size);
+        position += size;
+
+        return traits_type::to_int_type(*gptr());
+    }
+};
+
+/**
+ * @brief create test-data, which are bigger than one chunk of the upload-source
+ */
+std::string
+createUploadSourceData()
+{
+    std::string data = "";
+    for(uint64_t i = 0; i < 3000000; i++) {
+        data += static_cast<char>('a' + (i * 7) % 26);
+    }
+    return data;
+}
+
+/**
+ * @brief read the complete data of a source in segments like the upload
+ *
+ * @param source source to read
+ * @param segmentSize number of bytes of each read
+ *
+ * @return data of the source or an empty string, if a read failed
+ */
+std::string
+readUploadSource(UploadSource &source,
+                 const uint64_t segmentSize)
+{
+    Kitsunemimi::ErrorContainer error;
+    std::string result(source.getSize(), '\0');
+
+    for(uint64_t pos = 0; pos < source.getSize(); pos += segmentSize)
+    {
+        const uint64_t size = std::min(segmentSize, source.getSize() - pos);
+        if(source.read(reinterpret_cast<uint8_t*>(&result[pos]), pos, size, error) == false) {
+            return "";
+        }
+    }
+
+    return result;
+}
+
+UploadSource_Test::UploadSource_Test()
+    : Kitsunemimi::CompareTestHelper("UploadSource_Test")
+{
+    file_test();
+    memory_test();
+    seekableStream_test();
+    nonSeekableStream_test();
+    producer_test();
+    producerOverflow_test();
+    contentHash_test();
+
+    remove(TEST_SOURCE_PATH);
+}
+
+/**
+ * file_test
+ */
+void
+UploadSource_Test::file_test()
+{
+    Kitsunemimi::ErrorContainer error;
+    const std::string data = createUploadSourceData();
+    {
+        std::ofstream out(TEST_SOURCE_PATH, std::ofstream::trunc | std::ofstream::binary);
+        out << data;
+    }
+
+    UploadSource source;
+    TEST_EQUAL(source.initFile(TEST_SOURCE_PATH, error), true);
+    TEST_EQUAL(source.getFilePath(), TEST_SOURCE_PATH);
+    TEST_EQUAL(source.getSize(), data.size());
+    TEST_EQUAL(readUploadSource(source, 100000) == data, true);
+
+    // reads outside of the file fail
+    uint8_t buffer[8];
+    TEST_EQUAL(source.read(buffer, data.size() - 4, 8, error), false);
+
+    UploadSource missing;
+    TEST_EQUAL(missing.initFile("/tmp/hanami_upload_source_test_missing.bin", error), false);
+}
+
+/**
+ * memory_test
+ */
+void
+UploadSource_Test::memory_test()
+{
+    const std::string data = createUploadSourceData();
+    const uint8_t* dataPtr = reinterpret_cast<const uint8_t*>(data.data());
+
+    // the buffer is used without copy
+    UploadSource source;
+    source.initMemory(dataPtr, data.size());
+    TEST_EQUAL(source.getData() == dataPtr, true);
+    TEST_EQUAL(source.getSize(), data.size());
+    TEST_EQUAL(source.getFilePath(), "");
+    TEST_EQUAL(readUploadSource(source, 12345) == data, true);
+}
+
+/**
+ * seekableStream_test
+ */
+void
+UploadSource_Test::seekableStream_test()
+{
+    Kitsunemimi::ErrorContainer error;
+    const std::string data = createUploadSourceData();
+
+    // the upload begins at the current position of the stream and is read while sending
+    std::istringstream stream(data);
+    stream.seekg(5);
+    UploadSource source;
+    TEST_EQUAL(source.initStream(stream, error), true);
+    TEST_EQUAL(source.getData() == nullptr, true);
+    TEST_EQUAL(source.getSize(), data.size() - 5);
+    TEST_EQUAL(readUploadSource(source, 100000) == data.substr(5), true);
+
+    // reads, which don't follow the last one, seek within the stream
+    uint8_t buffer[4];
+    TEST_EQUAL(source.read(buffer, 100, 4, error), true);
+    TEST_EQUAL(memcmp(buffer, &data[105], 4), 0);
+    TEST_EQUAL(source.read(buffer, 50, 4, error), true);
+    TEST_EQUAL(memcmp(buffer, &data[55], 4), 0);
+
+    // empty stream
+    std::istringstream emptyStream("");
+    UploadSource emptySource;
+    TEST_EQUAL(emptySource.initStream(emptyStream, error), true);
+    TEST_EQUAL(emptySource.getSize(), 0);
+}
+
+/**
+ * nonSeekableStream_test
+ */
+void
+UploadSource_Test::nonSeekableStream_test()
+{
+    Kitsunemimi::ErrorContainer error;
+    const std::string data = createUploadSourceData();
+
+    // the stream is collected in memory, because its size is unknown
+    NonSeekableBuffer buffer(data);
+    std::istream stream(&buffer);
+    UploadSource source;
+    TEST_EQUAL(source.initStream(stream, error), true);
+    TEST_EQUAL(source.getData() != nullptr, true);
+    TEST_EQUAL(source.getSize(), data.size());
+    TEST_EQUAL(readUploadSource(source, 100000) == data, true);
+}
+
+/**
+ * producer_test
+ */
+void
+UploadSource_Test::producer_test()
+{
+    Kitsunemimi::ErrorContainer error;
+    const std::string data = createUploadSourceData();
+
+    // the producer gives less bytes than requested
+    uint64_t position = 0;
+    const UploadChunkProducer producer = [&](uint8_t* buffer,
+                                             const uint64_t bufferSize,
+                                             uint64_t &numberOfBytes)
+    {
+        numberOfBytes = std::min(std::min(bufferSize, static_cast<uint64_t>(12345)),
+                                 data.size() - position);
+        memcpy(buffer, &data[position], numberOfBytes);
+        position += numberOfBytes;
+        return true;
+    };
+
+    UploadSource source;
+    TEST_EQUAL(source.initProducer(producer, error), true);
+    TEST_EQUAL(source.getSize(), data.size());
+    TEST_EQUAL(readUploadSource(source, 100000) == data, true);
+
+    // failing producer
+    const UploadChunkProducer failingProducer = [](uint8_t*,
+                                                   const uint64_t,
+                                                   uint64_t &numberOfBytes)
+    {
+        numberOfBytes = 0;
+        return false;
+    };
+    UploadSource failingSource;
+    TEST_EQUAL(failingSource.initProducer(failingProducer, error), false);
+}
+
+/**
+ * producerOverflow_test
+ */
+void
+UploadSource_Test::producerOverflow_test()
+{
+    Kitsunemimi::ErrorContainer error;
+
+    // a producer, which reports more bytes than the buffer has, is rejected
+    const UploadChunkProducer producer = [](uint8_t*,
+                                            const uint64_t bufferSize,
+                                            uint64_t &numberOfBytes)
+    {
+        numberOfBytes = bufferSize + 1;
+        return true;
+    };
+
+    UploadSource source;
+    TEST_EQUAL(source.initProducer(producer, error), false);
+    TEST_EQUAL(source.getSize(), 0);
+}
+
+/**
+ * contentHash_test
+ */
+void
+UploadSource_Test::contentHash_test()
+{
+    Kitsunemimi::ErrorContainer error;
+    const std::string data = createUploadSourceData();
+
+    // data in memory and data, which are read while hashing, have the same hash
+    std::string memoryHash = "";
+    UploadSource memorySource;
+    memorySource.initMemory(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    TEST_EQUAL(memorySource.getContentHash(memoryHash, 1, error), true);
+    TEST_NOT_EQUAL(memoryHash, "");
+
+    std::string streamHash = "";
+    std::istringstream stream(data);
+    UploadSource streamSource;
+    TEST_EQUAL(streamSource.initStream(stream, error), true);
+    TEST_EQUAL(streamSource.getContentHash(streamHash, 1, error), true);
+    TEST_EQUAL(streamHash, memoryHash);
+
+    // the hash is cached, so the stream is not read again
+    stream.setstate(std::ios::badbit);
+    std::string cachedHash = "";
+    TEST_EQUAL(streamSource.getContentHash(cachedHash, 1, error), true);
+    TEST_EQUAL(cachedHash, memoryHash);
+
+    // other data have another hash
+    std::string otherHash = "";
+    UploadSource otherSource;
+    otherSource.initMemory(reinterpret_cast<const uint8_t*>(data.data()), data.size() - 1);
+    TEST_EQUAL(otherSource.getContentHash(otherHash, 1, error), true);
+    TEST_NOT_EQUAL(otherHash, memoryHash);
+}
+
+} // namespace HanamiAI
@@ -0,0 +1,99 @@
+/**
+ * @file        upload_streams_test.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#include "upload_streams_test.h"
+
+#include <common/upload_streams.h>
+
+#include <vector>
+
+namespace HanamiAI
+{
+
+UploadStreams_Test::UploadStreams_Test()
+    : Kitsunemimi::CompareTestHelper("UploadStreams_Test")
+{
+    getNumberOfUploadStreams_test();
+    distributeUploadStreams_test();
+}
+
+/**
+ * getNumberOfUploadStreams_test
+ */
+void
+UploadStreams_Test::getNumberOfUploadStreams_test()
+{
+    // automatic selection by the size of the data
+    TEST_EQUAL(getNumberOfUploadStreams(0, 0), 1);
+    TEST_EQUAL(getNumberOfUploadStreams(BYTES_PER_UPLOAD_STREAM - 1, 0), 1);
+    TEST_EQUAL(getNumberOfUploadStreams(3 * BYTES_PER_UPLOAD_STREAM, 0), 3);
+    TEST_EQUAL(getNumberOfUploadStreams(1000ULL * BYTES_PER_UPLOAD_STREAM, 0),
+               MAX_UPLOAD_STREAMS);
+
+    // requested by the user
+    TEST_EQUAL(getNumberOfUploadStreams(0, 4), 4);
+    TEST_EQUAL(getNumberOfUploadStreams(1000ULL * BYTES_PER_UPLOAD_STREAM, 2), 2);
+    TEST_EQUAL(getNumberOfUploadStreams(0, 100), MAX_UPLOAD_STREAMS);
+}
+
+/**
+ * distributeUploadStreams_test
+ */
+void
+UploadStreams_Test::distributeUploadStreams_test()
+{
+    std::vector<JournalFile> files(3);
+    files[0].fileSize = 1000;
+    files[1].fileSize = 7000;
+    files[2].fileSize = 2000;
+
+    // one stream for each file
+    std::vector<uint32_t> streams = distributeUploadStreams(files, 3);
+    TEST_EQUAL(streams.size(), 3);
+    TEST_EQUAL(streams[0], 1);
+    TEST_EQUAL(streams[1], 1);
+    TEST_EQUAL(streams[2], 1);
+
+    // additional streams by size and the remainder of the rounding to the biggest file
+    streams = distributeUploadStreams(files, 8);
+    TEST_EQUAL(streams[0] + streams[1] + streams[2], 8);
+    TEST_EQUAL(streams[0], 1);
+    TEST_EQUAL(streams[1], 5);
+    TEST_EQUAL(streams[2], 2);
+
+    // all files at least one stream, even if they are empty
+    files[0].fileSize = 0;
+    files[2].fileSize = 0;
+    streams = distributeUploadStreams(files, 5);
+    TEST_EQUAL(streams[0], 1);
+    TEST_EQUAL(streams[1], 3);
+    TEST_EQUAL(streams[2], 1);
+
+    // all files empty
+    files[1].fileSize = 0;
+    streams = distributeUploadStreams(files, 4);
+    TEST_EQUAL(streams[0] + streams[1] + streams[2], 4);
+    TEST_EQUAL(streams[0] >= 1 && streams[1] >= 1 && streams[2] >= 1, true);
+}
+
+} // namespace HanamiAI
@@ -0,0 +1,277 @@
+/**
+ * @file        value_encoding_test.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2022 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include "value_encoding_test.h"
+
+#include <libHanamiAiSdk/value_encoding.h>
+#include <libHanamiAiSdk/prepared_request.h>
+#include <common/encoded_values.h>
+#include <common/direct_io_messages.h>
+
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+namespace HanamiAI
+{
+
+ValueEncoding_Test::ValueEncoding_Test()
+    : Kitsunemimi::CompareTestHelper("ValueEncoding_Test")
+{
+    encodeValues_roundTrip_test();
+    encodeValues_simdEqualsScalar_test();
+    preparedRequest_encodedFrame_test();
+    sparseEncoding_roundTrip_test();
+    preparedRequest_sparseFrame_test();
+}
+
+/**
+ * encodeValues_roundTrip_test
+ */
+void
+ValueEncoding_Test::encodeValues_roundTrip_test()
+{
+    // number of values is not a multiple of the SIMD-width, so the scalar tail is used too
+    std::vector<float> values(1003);
+    for(uint64_t i = 0; i < values.size(); i++) {
+        values[i] = sinf(static_cast<float>(i) * 0.1f) * 4.0f;
+    }
+
+    const ValueEncoding encodings[4] = {FP32_ENCODING, FP16_ENCODING, BF16_ENCODING, INT8_ENCODING};
+
+    // maximum relative error of fp16 and bf16 and absolute error of int8 with a scale of 4/127
+    const float maxErrors[4] = {0.0f, 1.0f / 2048.0f, 1.0f / 256.0f, 4.0f / 254.0f + 0.0001f};
+
+    for(uint32_t e = 0; e < 4; e++)
+    {
+        const uint64_t encodedSize = getEncodedSize(encodings[e], values.size());
+        std::vector<uint8_t> encoded(encodedSize);
+        TEST_EQUAL(encodeValues(encoded.data(), values.data(), values.size(), encodings[e]),
+                   encodedSize);
+
+        std::vector<float> decoded(values.size());
+        TEST_EQUAL(decodeValues(decoded.data(),
+                                encoded.data(),
+                                encoded.size(),
+                                values.size(),
+                                encodings[e]),
+                   true);
+
+        bool inRange = true;
+        for(uint64_t i = 0; i < values.size(); i++)
+        {
+            float maxError = maxErrors[e];
+            if(encodings[e] != INT8_ENCODING) {
+                maxError *= fabsf(values[i]);
+            }
+            inRange &= fabsf(decoded[i] - values[i]) <= maxError;
+        }
+        TEST_EQUAL(inRange, true);
+
+        // data with wrong size
+        TEST_EQUAL(decodeValues(decoded.data(),
+                                encoded.data(),
+                                encoded.size() - 1,
+                                values.size(),
+                                encodings[e]),
+                   false);
+    }
+}
+
+/**
+ * encodeValues_simdEqualsScalar_test
+ */
+void
+ValueEncoding_Test::encodeValues_simdEqualsScalar_test()
+{
+    // quiet and signaling NaN with payload, overflow, subnormal and rounding-cases
+    const uint32_t specialBits[7] = {0x7fc01234, 0xffa00001, 0x7fa12345, 0x47800000,
+                                     0x33800001, 0x387fc000, 0xbf803000};
+
+    // the first 40 values are converted by the SIMD-functions, if available, and the last 7
+    // values by the scalar fallback
+    std::vector<float> values(47, 1.0f);
+    for(uint32_t i = 0; i < 7; i++)
+    {
+        memcpy(&values[i], &specialBits[i], 4);
+        memcpy(&values[40 + i], &specialBits[i], 4);
+    }
+
+    for(const ValueEncoding encoding : {FP16_ENCODING, BF16_ENCODING})
+    {
+        std::vector<uint8_t> encoded(getEncodedSize(encoding, values.size()));
+        encodeValues(encoded.data(), values.data(), values.size(), encoding);
+        TEST_EQUAL(memcmp(&encoded[0], &encoded[80], 7 * 2), 0);
+
+        std::vector<float> decoded(values.size());
+        decodeValues(decoded.data(), encoded.data(), encoded.size(), values.size(), encoding);
+        TEST_EQUAL(memcmp(&decoded[0], &decoded[40], 7 * sizeof(float)), 0);
+    }
+}
+
+/**
+ * preparedRequest_encodedFrame_test
+ */
+void
+ValueEncoding_Test::preparedRequest_encodedFrame_test()
+{
+    PreparedRequest prepared(REQUEST_INPUT_PREPARED, "input");
+    ClusterIO_Message message;
+    uint64_t frameSize = 0;
+
+    std::vector<float> values(784);
+    for(uint64_t i = 0; i < values.size(); i++) {
+        values[i] = static_cast<float>(i % 256) / 255.0f;
+    }
+
+    const uint8_t* frame = prepared.fill(values.data(), values.size(), frameSize);
+    const uint64_t fp32FrameSize = frameSize;
+
+    for(const ValueEncoding encoding : {FP16_ENCODING, BF16_ENCODING, INT8_ENCODING})
+    {
+        prepared.setEncoding(encoding);
+        frame = prepared.fill(values.data(), values.size(), frameSize);
+        TEST_EQUAL(frameSize < fp32FrameSize / 2 + 64, true);
+
+        // the frame is still a valid message, where the encoded values are unknown fields
+        TEST_EQUAL(message.ParseFromArray(frame, static_cast<int>(frameSize)), true);
+        TEST_EQUAL(message.segmentname(), "input");
+        TEST_EQUAL(message.numberofvalues(), values.size());
+        TEST_EQUAL(message.values_size(), 0);
+
+        // decode the values like a server with support for encoded values
+        EncodedValues encoded;
+        TEST_EQUAL(parseEncodedValues(encoded, frame, frameSize), true);
+        TEST_EQUAL(encoded.hasEncoding, true);
+        TEST_EQUAL(encoded.encoding, encoding);
+        TEST_EQUAL(encoded.numberOfValues, values.size());
+
+        std::vector<uint8_t> expectedData(getEncodedSize(encoding, values.size()));
+        encodeValues(expectedData.data(), values.data(), values.size(), encoding);
+        std::vector<float> expected(values.size());
+        decodeValues(expected.data(),
+                     expectedData.data(),
+                     expectedData.size(),
+                     values.size(),
+                     encoding);
+
+        std::vector<float> decoded(values.size());
+        TEST_EQUAL(decodeEncodedValues(decoded.data(), encoded), true);
+        TEST_EQUAL(memcmp(decoded.data(), expected.data(), values.size() * sizeof(float)), 0);
+    }
+
+    // back to plain float-values
+    prepared.setEncoding(FP32_ENCODING);
+    frame = prepared.fill(values.data(), values.size(), frameSize);
+    TEST_EQUAL(frameSize, fp32FrameSize);
+    TEST_EQUAL(message.ParseFromArray(frame, static_cast<int>(frameSize)), true);
+    TEST_EQUAL(message.values_size(), static_cast<int>(values.size()));
+
+    EncodedValues encoded;
+    TEST_EQUAL(parseEncodedValues(encoded, frame, frameSize), true);
+    TEST_EQUAL(encoded.hasEncoding, false);
+}
+
+/**
+ * sparseEncoding_roundTrip_test
+ */
+void
+ValueEncoding_Test::sparseEncoding_roundTrip_test()
+{
+    // non-zero values in the SIMD-part and in the scalar tail
+    std::vector<float> values(203, 0.0f);
+    values[0] = 1.0f;
+    values[17] = -2.5f;
+    values[64] = 0.125f;
+    values[201] = 7.0f;
+
+    uint64_t numberOfNonZeroValues = 0;
+    TEST_EQUAL(shouldUseSparseEncoding(values.data(), values.size(), numberOfNonZeroValues),
+               true);
+    TEST_EQUAL(numberOfNonZeroValues, 4);
+
+    std::vector<uint8_t> encoded(getSparseEncodedSize(numberOfNonZeroValues));
+    TEST_EQUAL(encodeSparseValues(encoded.data(), values.data(), values.size()), encoded.size());
+
+    std::vector<float> decoded(values.size(), 42.0f);
+    TEST_EQUAL(decodeSparseValues(decoded.data(), encoded.data(), encoded.size(), values.size()),
+               true);
+    TEST_EQUAL(memcmp(decoded.data(), values.data(), values.size() * sizeof(float)), 0);
+
+    // broken blocks
+    TEST_EQUAL(decodeSparseValues(decoded.data(), encoded.data(), encoded.size() - 1, 203),
+               false);
+    TEST_EQUAL(decodeSparseValues(decoded.data(), encoded.data(), encoded.size(), 201), false);
+
+    // dense values are not encoded as sparse
+    std::vector<float> denseValues(203, 1.0f);
+    TEST_EQUAL(shouldUseSparseEncoding(denseValues.data(),
+                                       denseValues.size(),
+                                       numberOfNonZeroValues),
+               false);
+}
+
+/**
+ * preparedRequest_sparseFrame_test
+ */
+void
+ValueEncoding_Test::preparedRequest_sparseFrame_test()
+{
+    PreparedRequest prepared(LEARN_INPUT_PREPARED, "input");
+    ClusterIO_Message message;
+    uint64_t frameSize = 0;
+
+    // one-hot vector
+    std::vector<float> values(1000, 0.0f);
+    values[123] = 1.0f;
+
+    const uint8_t* frame = prepared.fill(values.data(), values.size(), frameSize);
+    const uint64_t denseFrameSize = frameSize;
+
+    prepared.setSparseEncoding(true);
+    frame = prepared.fill(values.data(), values.size(), frameSize);
+    TEST_EQUAL(frameSize * 10 < denseFrameSize, true);
+    TEST_EQUAL(message.ParseFromArray(frame, static_cast<int>(frameSize)), true);
+    TEST_EQUAL(message.numberofvalues(), values.size());
+
+    EncodedValues encoded;
+    TEST_EQUAL(parseEncodedValues(encoded, frame, frameSize), true);
+    TEST_EQUAL(encoded.encoding, SPARSE_ENCODING);
+
+    std::vector<float> decoded(values.size());
+    TEST_EQUAL(decodeEncodedValues(decoded.data(), encoded), true);
+    TEST_EQUAL(memcmp(decoded.data(), values.data(), values.size() * sizeof(float)), 0);
+
+    // dense values are send with the normal encoding of the prepared request
+    std::vector<float> denseValues(1000, 0.5f);
+    frame = prepared.fill(denseValues.data(), denseValues.size(), frameSize);
+    TEST_EQUAL(frameSize, denseFrameSize);
+    TEST_EQUAL(message.ParseFromArray(frame, static_cast<int>(frameSize)), true);
+    TEST_EQUAL(message.values_size(), 1000);
+
+    prepared.setEncoding(FP16_ENCODING);
+    frame = prepared.fill(denseValues.data(), denseValues.size(), frameSize);
+    TEST_EQUAL(parseEncodedValues(encoded, frame, frameSize), true);
+    TEST_EQUAL(encoded.encoding, FP16_ENCODING);
+}
+
+} // namespace HanamiAI